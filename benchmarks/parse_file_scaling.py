@@ -0,0 +1,48 @@
+# Масштабирование parse_file по числу потоков (модуль CPython):
+#   python3 setup.py build_ext --inplace
+#   PYTHONPATH=. python3 benchmarks/parse_file_scaling.py [MB] [max_workers]
+# Печатает пропускную способность и ускорение относительно одного потока
+import os
+import sys
+import tempfile
+import time
+
+import ublox_nmea
+
+
+# Синтетический лог: эпоха 1 Гц из RMC, GGA, GSA, GSV, VTG (генератор модуля)
+def write_log(path, size_mb):
+    generator = ublox_nmea.Generator("circle", satellites=16)
+    return generator.write(path, size_mb * 1024 * 1024)
+
+
+def best_time(path, workers, repeats=3):
+    best = None
+    for _ in range(repeats):
+        start = time.perf_counter()
+        ublox_nmea.parse_file(path, workers=workers)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def main():
+    size_mb = int(sys.argv[1]) if len(sys.argv) > 1 else 256
+    max_workers = int(sys.argv[2]) if len(sys.argv) > 2 else (os.cpu_count() or 1)
+
+    fd, path = tempfile.mkstemp(suffix=".nmea")
+    os.close(fd)
+    try:
+        size = write_log(path, size_mb)
+        base = best_time(path, 1)
+        print("workers   MB/s   speedup")
+        counts = sorted({1 << i for i in range(max_workers.bit_length())} | {max_workers})
+        for workers in counts:
+            elapsed = base if workers == 1 else best_time(path, workers)
+            print("%7d %6.0f %8.2f" % (workers, size / elapsed / 1e6, base / elapsed))
+    finally:
+        os.remove(path)
+
+
+if __name__ == "__main__":
+    main()
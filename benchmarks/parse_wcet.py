@@ -0,0 +1,107 @@
+# Худшее время parse() по классам входа, включая враждебные (модуль CPython):
+#   python3 setup.py build_ext --inplace
+#   PYTHONPATH=. python3 benchmarks/parse_wcet.py [repeats] [--corpus DIR]
+# Печатает худший вход, 99-й перцентиль и медиану времени одного вызова (нс) для каждого класса;
+# с --corpus записывает входы по одному в файл (начальный корпус для фаззера)
+import os
+import random
+import sys
+import time
+
+import ublox_nmea
+
+# NMEA_MAX_SENTENCE в ublox_nmea_core.h
+MAX_SENTENCE = 127
+
+
+def sentence(body):
+    checksum = 0
+    for ch in body:
+        checksum ^= ord(ch)
+    return "$%s*%02X" % (body, checksum)
+
+
+def valid_inputs():
+    gen = ublox_nmea.Generator(constellations=4, satellites=64, sentences="RMC,GGA,GSA,GSV,VTG")
+    lines = gen.epoch().decode().split("\r\n")
+    return [line for line in lines if line]
+
+
+# Классы входа: штатные предложения и враждебные строки, на которых наивный разбор
+# делает повторные проходы strlen/strstr/strchr
+def input_classes(seed=1):
+    rnd = random.Random(seed)
+    longest_body = "GPGGA," + ",".join(["9" * 15] * 14)
+    longest_body = longest_body[:MAX_SENTENCE - 4]
+    classes = {
+        "valid": valid_inputs(),
+        "max_length": [sentence(longest_body)],
+        "over_length": [sentence(longest_body + "0")],
+        "long_fields": [sentence("GPRMC," + ",".join(["1" * 40] * 2))],
+        "no_commas_4k": ["$GPGGA" + "A" * 4096],
+        "star_flood_4k": ["$" + "*" * 4096, "*" * 4096],
+        "dollar_flood_4k": ["$" * 4096],
+        "comma_flood_4k": ["$GPRMC" + "," * 4096],
+        "tail_after_checksum": [sentence("GPGGA,120000.00,5545.0,N,03737.0,E,1,08,0.9,150.0,M,14.0,M,,") +
+                                ",0" * 2048],
+        "prefix_flood_4k": ["$GPRM" * 800],
+        "random_64": ["".join(chr(rnd.randrange(32, 127)) for _ in range(64)) for _ in range(32)],
+        "random_4k": ["".join(chr(rnd.randrange(32, 127)) for _ in range(4096)) for _ in range(8)],
+        "dollar_flood_1m": ["$" * (1 << 20)],
+    }
+    return classes
+
+
+# Худший вход класса - максимум по входам минимального из повторов времени (без вытеснения ОС),
+# плюс 99-й перцентиль и медиана всех замеров
+def measure(inputs, repeats):
+    samples = []
+    worst = 0
+    parse = ublox_nmea.parse
+    clock = time.perf_counter_ns
+    for text in inputs:
+        best = None
+        for _ in range(repeats):
+            start = clock()
+            parse(text)
+            elapsed = clock() - start
+            samples.append(elapsed)
+            best = elapsed if best is None else min(best, elapsed)
+        worst = max(worst, best)
+    samples.sort()
+    return worst, samples[len(samples) * 99 // 100], samples[len(samples) // 2]
+
+
+def write_corpus(directory, classes):
+    os.makedirs(directory, exist_ok=True)
+    for name, inputs in classes.items():
+        for i, text in enumerate(inputs):
+            with open(os.path.join(directory, "%s_%03d" % (name, i)), "w") as f:
+                f.write(text)
+
+
+def main():
+    args = sys.argv[1:]
+    corpus = None
+    if "--corpus" in args:
+        index = args.index("--corpus")
+        corpus = args[index + 1]
+        del args[index:index + 2]
+    repeats = int(args[0]) if args else 200
+
+    classes = input_classes()
+    if corpus:
+        write_corpus(corpus, classes)
+
+    # Прогрев: кэши и состояние парсера
+    for inputs in classes.values():
+        measure(inputs, 10)
+
+    print("%-20s %8s %8s %8s" % ("class", "worst ns", "p99 ns", "p50 ns"))
+    for name, inputs in classes.items():
+        worst, p99, median = measure(inputs, repeats)
+        print("%-20s %8d %8d %8d" % (name, worst, p99, median))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,6 +1,16 @@
 # micropython.cmake
 # Ublox NMEA module CMake configuration
 target_sources(usermod INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_core.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_log.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_mux.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_gen.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_encode.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_pack.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_state.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_ubx.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_clock.c
+    ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea_rf.c
     ${CMAKE_CURRENT_LIST_DIR}/ublox_nmea.c
 )
 
@@ -1,5 +1,15 @@
 # micropython.mk
 # Ublox NMEA module for MicroPython
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_core.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_log.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_mux.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_gen.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_encode.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_pack.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_state.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_ubx.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_clock.c
+SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea_rf.c
 SRC_USERMOD += $(USERMOD_DIR)/ublox_nmea.c
 
 CFLAGS_USERMOD += -I$(USERMOD_DIR)
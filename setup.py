@@ -0,0 +1,24 @@
+# Сборка модуля для CPython (серверная обработка логов):
+#   python3 setup.py build_ext --inplace
+# Ядро парсера (ublox_nmea_core.c) общее с модулем MicroPython
+from setuptools import setup, Extension
+
+setup(
+    name="ublox_nmea",
+    version="0.1.0",
+    ext_modules=[
+        Extension(
+            "ublox_nmea",
+            sources=["ublox_nmea_core.c", "ublox_nmea_log.c", "ublox_nmea_mux.c", "ublox_nmea_gen.c",
+                     "ublox_nmea_encode.c",
+                     "ublox_nmea_pack.c",
+                     "ublox_nmea_state.c",
+                     "ublox_nmea_ubx.c",
+                     "ublox_nmea_clock.c",
+                     "ublox_nmea_rf.c",
+                     "ublox_nmea_cpython.c"],
+            define_macros=[("NMEA_LOG_THREADS", "1")],
+            libraries=["pthread"],
+        ),
+    ],
+)
@@ -1,113 +1,50 @@
 #include "ublox_nmea.h"
+#include "ublox_nmea_log.h"
+#include "ublox_nmea_mux.h"
+#include "ublox_nmea_gen.h"
+#include "ublox_nmea_encode.h"
+#include "ublox_nmea_pack.h"
+#include "ublox_nmea_state.h"
+#include "ublox_nmea_ubx.h"
+#include "ublox_nmea_clock.h"
+#include "ublox_nmea_rf.h"
+#include "py/objint.h"
+#include "py/objarray.h"
+#include "py/binary.h"
+#include "py/builtin.h"
+#include "py/stream.h"
+#include "py/mperrno.h"
+#include "py/mphal.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
-// Константы для расчета расстояния
-#define EARTH_RADIUS_M 6371000.0
-#define DEG_TO_RAD (M_PI / 180.0)
+// Ёмкость истории фиксов (можно переопределить через CFLAGS)
+#ifndef GPS_HISTORY_CAPACITY
+#define GPS_HISTORY_CAPACITY 256
+#endif
 
 // Глобальная структура для хранения текущих GPS данных
 static gps_data_t current_gps_data;
 static uint8_t gps_data_initialized = 0;
 
+// Запись истории: монотонный ключ UTC в миллисекундах и координаты
+typedef struct {
+    int64_t utc_ms;
+    double latitude;
+    double longitude;
+} gps_history_entry_t;
+
+// Кольцевой буфер истории фиксов
+static gps_history_entry_t gps_history[GPS_HISTORY_CAPACITY];
+static uint16_t gps_history_head = 0;   // индекс самой старой записи
+static uint16_t gps_history_count = 0;
+
 // Прототипы функций
-static void gps_data_init(gps_data_t* gps_data);
-static double calculate_distance_haversine(double lat1, double lon1, double lat2, double lon2);
-static double parse_coordinate(const char* coord, char direction);
-static int checksum_valid(const char* sentence);
-static int parse_fields(const char* sentence, char fields[][16], int max_fields);
-static void parse_gga(const char* sentence, gps_data_t* gps_data);
-static void parse_rmc(const char* sentence, gps_data_t* gps_data);
-static void parse_gsa(const char* sentence, gps_data_t* gps_data);
-static void parse_gsv(const char* sentence, gps_data_t* gps_data);
-static void parse_vtg(const char* sentence, gps_data_t* gps_data);
 static mp_obj_t create_gps_dict_from_data(gps_data_t* gps_data);
-static void update_timestamp(gps_data_t* gps_data);
-static double calculate_accuracy(double hdop, uint8_t satellites_used);
-static void update_accuracy(gps_data_t* gps_data);
-
-// Инициализация структуры GPS данных
-static void gps_data_init(gps_data_t* gps_data) {
-    gps_data->latitude = NAN;
-    gps_data->longitude = NAN;
-    gps_data->altitude = NAN;
-    gps_data->speed = NAN;
-    gps_data->course = NAN;
-    gps_data->satellites_used = 0;
-    gps_data->satellites_visible = 0;
-    gps_data->fix_type = 0;
-    gps_data->hdop = NAN;
-    gps_data->vdop = NAN;
-    gps_data->pdop = NAN;
-    gps_data->accuracy = NAN;
-    gps_data->year = 0;
-    gps_data->month = 0;
-    gps_data->day = 0;
-    gps_data->hour = 0;
-    gps_data->minute = 0;
-    gps_data->second = 0;
-    gps_data->valid = 0;
-    gps_data->has_gga = 0;
-    gps_data->has_gsa = 0;
-    gps_data->has_gsv = 0;
-    gps_data->has_vtg = 0;
-    gps_data->has_satellites_used = 0;
-    gps_data->has_satellites_visible = 0;
-    gps_data->has_accuracy = 0;
-    gps_data->timestamp[0] = '\0';  // Инициализируем пустой строкой
-}
-
-// Функция расчета accuracy на основе HDOP и количества спутников
-static double calculate_accuracy(double hdop, uint8_t satellites_used) {
-    double base_accuracy = hdop * 4.9;  // базовый множитель
-
-    // Корректировка по количеству спутников
-    if (satellites_used >= 8) {
-        base_accuracy *= 0.7;  // высокая точность
-    } else if (satellites_used >= 5) {
-        base_accuracy *= 0.9;  // средняя точность
-    } else if (satellites_used <= 3) {
-        base_accuracy *= 1.5;  // низкая точность
-    }
-
-    return base_accuracy;
-}
-
-// Обновление accuracy
-static void update_accuracy(gps_data_t* gps_data) {
-    if (!isnan(gps_data->hdop) && gps_data->has_satellites_used) {
-        gps_data->accuracy = calculate_accuracy(gps_data->hdop, gps_data->satellites_used);
-        gps_data->accuracy = round(gps_data->accuracy * 10.0) / 10.0; // округление
-        gps_data->has_accuracy = 1;
-    } else {
-        gps_data->accuracy = NAN;
-        gps_data->has_accuracy = 0;
-    }
-}
-
-// Функция для обновления timestamp в структуре
-static void update_timestamp(gps_data_t* gps_data) {
-    // Проверяем наличие полной даты и времени
-    if (gps_data->year > 0 && gps_data->month > 0 && gps_data->day > 0) {
-        int result = snprintf(gps_data->timestamp, sizeof(gps_data->timestamp),
-                "%04d-%02d-%02dT%02d:%02d:%02dZ",
-                gps_data->year,
-                gps_data->month,
-                gps_data->day,
-                gps_data->hour,
-                gps_data->minute,
-                gps_data->second);
-
-        // Проверяем успешность форматирования
-        if (result <= 0 || result >= (int)sizeof(gps_data->timestamp)) {
-            gps_data->timestamp[0] = '\0'; // сбрасываем при ошибке
-        }
-    } else {
-        gps_data->timestamp[0] = '\0';
-    }
-}
+static void history_record(const gps_data_t* gps_data);
+static int history_interpolate(double t_ms, int great_circle, double* lat, double* lon);
 
 // Функция для создания словаря из текущих GPS данных
 static mp_obj_t create_gps_dict_from_data(gps_data_t* gps_data) {
@@ -205,304 +142,6 @@ static mp_obj_t create_gps_dict_from_data(gps_data_t* gps_data) {
     return MP_OBJ_FROM_PTR(dict);
 }
 
-static double parse_coordinate(const char* coord, char direction) {
-    if (strlen(coord) < 7) return NAN;
-
-    // Находим позицию десятичной точки
-    const char* dot_pos = strchr(coord, '.');
-    if (!dot_pos) return NAN;
-
-    int dot_index = dot_pos - coord;
-
-    // Определяем количество цифр в градусах по позиции точки
-    // Форматы NMEA:
-    // DDM.MMMMM   - точка на позиции 2 (нестандартный)
-    // DDMM.MMMMM  - точка на позиции 4 (стандартный для широты)
-    // DDDMM.MMMMM - точка на позиции 5 (стандартный для долготы)
-    // DDDDMM.MMMMM - точка на позиции 6 (расширенный)
-
-    int degree_digits;
-    if (dot_index == 2) {
-        degree_digits = 1;  // DDM.MMMMM
-    } else if (dot_index == 3) {
-        degree_digits = 2;  // DDM.MMMMM (редкий)
-    } else if (dot_index == 4) {
-        degree_digits = 2;  // DDMM.MMMMM (широта)
-    } else if (dot_index == 5) {
-        degree_digits = 3;  // DDDMM.MMMMM (долгота)
-    } else if (dot_index == 6) {
-        degree_digits = 4;  // DDDDMM.MMMMM (высокая точность)
-    } else {
-        return NAN;  // Неизвестный формат
-    }
-
-    // Извлекаем градусы
-    char degrees_str[5] = {0};  // увеличен буфер для 4 цифр
-    strncpy(degrees_str, coord, degree_digits);
-    degrees_str[degree_digits] = '\0';
-
-    // Извлекаем минуты (всё после градусов)
-    char minutes_str[16] = {0};
-    strncpy(minutes_str, coord + degree_digits, sizeof(minutes_str) - 1);
-
-    double degrees = atof(degrees_str);
-    double minutes = atof(minutes_str);
-
-    double result = degrees + minutes / 60.0;
-
-    if (direction == 'S' || direction == 'W') {
-        result = -result;
-    }
-
-    return result;
-}
-
-static int checksum_valid(const char* sentence) {
-    if (sentence[0] != '$') return 0;
-
-    const char* checksum_start = strchr(sentence, '*');
-    if (!checksum_start) return 0;
-
-    uint8_t calculated_checksum = 0;
-    for (const char* p = sentence + 1; p < checksum_start; p++) {
-        calculated_checksum ^= *p;
-    }
-
-    uint8_t received_checksum = (uint8_t)strtol(checksum_start + 1, NULL, 16);
-    return calculated_checksum == received_checksum;
-}
-
-// Улучшенный парсинг полей
-static int parse_fields(const char* sentence, char fields[][16], int max_fields) {
-    int field_count = 0;
-    const char* start = sentence;
-
-    while (*sentence && field_count < max_fields) {
-        if (*sentence == ',') {
-            size_t len = sentence - start;
-            if (len < sizeof(fields[0]) - 1) {
-                memcpy(fields[field_count], start, len);
-                fields[field_count][len] = '\0';
-            } else {
-                fields[field_count][0] = '\0';
-            }
-            field_count++;
-            start = sentence + 1;
-        }
-        sentence++;
-    }
-
-    // Обработка последнего поля
-    if (*start && field_count < max_fields) {
-        const char* end = strchr(start, '*');
-        if (!end) end = sentence;
-        size_t len = end - start;
-        if (len < sizeof(fields[0]) - 1) {
-            memcpy(fields[field_count], start, len);
-            fields[field_count][len] = '\0';
-        } else {
-            fields[field_count][0] = '\0';
-        }
-        field_count++;
-    }
-
-    return field_count;
-}
-
-// Парсинг GGA сообщения
-static void parse_gga(const char* sentence, gps_data_t* gps_data) {
-    char fields[20][16] = {0};
-    int field_count = parse_fields(sentence, fields, 20);
-
-    if (field_count < 14) return;
-
-    // Время
-    if (strlen(fields[1]) >= 6) {
-        gps_data->hour = (fields[1][0] - '0') * 10 + (fields[1][1] - '0');
-        gps_data->minute = (fields[1][2] - '0') * 10 + (fields[1][3] - '0');
-        gps_data->second = (fields[1][4] - '0') * 10 + (fields[1][5] - '0');
-    }
-
-    // Координаты (GGA имеет приоритет для высоты и точности)
-    if (strlen(fields[2]) > 0 && strlen(fields[3]) > 0) {
-        gps_data->latitude = parse_coordinate(fields[2], fields[3][0]);
-    }
-
-    if (strlen(fields[4]) > 0 && strlen(fields[5]) > 0) {
-        gps_data->longitude = parse_coordinate(fields[4], fields[5][0]);
-    }
-
-    // Качество фикса
-    if (strlen(fields[6]) > 0) {
-        gps_data->fix_type = atoi(fields[6]);
-    }
-
-    // Количество спутников
-    if (strlen(fields[7]) > 0) {
-        gps_data->satellites_used = atoi(fields[7]);
-        gps_data->has_satellites_used = 1;
-    }
-
-    // HDOP
-    if (strlen(fields[8]) > 0) {
-        gps_data->hdop = atof(fields[8]);
-    }
-
-    // Высота (округляем до 1 знака после запятой)
-    if (strlen(fields[9]) > 0) {
-        gps_data->altitude = round(atof(fields[9]) * 10.0) / 10.0;
-    }
-
-    gps_data->has_gga = 1;
-
-    // Обновляем accuracy и timestamp
-    update_accuracy(gps_data);
-    update_timestamp(gps_data);
-}
-
-// Парсинг RMC сообщения
-static void parse_rmc(const char* sentence, gps_data_t* gps_data) {
-    char fields[20][16] = {0};
-    int field_count = parse_fields(sentence, fields, 20);
-
-    if (field_count < 12) return;
-
-    // ВАЖНО: RMC НЕ сбрасывает флаги других предложений
-    // Каждое предложение дополняет общую картину
-
-    // Время (RMC имеет приоритет для даты и общего статуса)
-    if (strlen(fields[1]) >= 6) {
-        gps_data->hour = (fields[1][0] - '0') * 10 + (fields[1][1] - '0');
-        gps_data->minute = (fields[1][2] - '0') * 10 + (fields[1][3] - '0');
-        gps_data->second = (fields[1][4] - '0') * 10 + (fields[1][5] - '0');
-    }
-
-    // Статус - основной индикатор валидности позиции
-    gps_data->valid = (fields[2][0] == 'A') ? 1 : 0;
-
-    // Координаты (используем если нет от GGA или GGA невалидны)
-    if (strlen(fields[3]) > 0 && strlen(fields[4]) > 0 &&
-        (isnan(gps_data->latitude) || !gps_data->has_gga)) {
-        gps_data->latitude = parse_coordinate(fields[3], fields[4][0]);
-    }
-
-    if (strlen(fields[5]) > 0 && strlen(fields[6]) > 0 &&
-        (isnan(gps_data->longitude) || !gps_data->has_gga)) {
-        gps_data->longitude = parse_coordinate(fields[5], fields[6][0]);
-    }
-
-    // Скорость (узлы -> м/с, округляем до 1 знака после запятой)
-    if (strlen(fields[7]) > 0) {
-        double speed_knots = atof(fields[7]);
-        gps_data->speed = round(speed_knots * 0.514444 * 10.0) / 10.0;
-    }
-
-    // Курс из RMC (округляем до 1 знака после запятой)
-    if (strlen(fields[8]) > 0) {
-        gps_data->course = round(atof(fields[8]) * 10.0) / 10.0;
-    }
-
-    // Дата (RMC - основной источник даты)
-    if (strlen(fields[9]) >= 6) {
-        gps_data->day = (fields[9][0] - '0') * 10 + (fields[9][1] - '0');
-        gps_data->month = (fields[9][2] - '0') * 10 + (fields[9][3] - '0');
-        gps_data->year = 2000 + (fields[9][4] - '0') * 10 + (fields[9][5] - '0');
-    }
-
-    // Обновляем timestamp
-    update_timestamp(gps_data);
-}
-
-// Парсинг GSA сообщения
-static void parse_gsa(const char* sentence, gps_data_t* gps_data) {
-    char fields[20][16] = {0};
-    int field_count = parse_fields(sentence, fields, 20);
-
-    if (field_count < 17) return;
-
-    // PDOP, HDOP, VDOP (округляем до 1 знака после запятой)
-    // GSA имеет приоритет для DOP параметров
-    if (strlen(fields[15]) > 0) {
-        gps_data->pdop = round(atof(fields[15]) * 10.0) / 10.0;
-    }
-
-    if (strlen(fields[16]) > 0) {
-        gps_data->hdop = round(atof(fields[16]) * 10.0) / 10.0;
-    }
-
-    if (strlen(fields[17]) > 0) {
-        gps_data->vdop = round(atof(fields[17]) * 10.0) / 10.0;
-    }
-
-    gps_data->has_gsa = 1;
-
-    // Обновляем accuracy
-    update_accuracy(gps_data);
-}
-
-// Парсинг GSV сообщения - подсчет видимых спутников
-static void parse_gsv(const char* sentence, gps_data_t* gps_data) {
-    char fields[20][16] = {0};
-    int field_count = parse_fields(sentence, fields, 20);
-
-    if (field_count < 4) return;
-
-    // ЛОГИКА: В GSV предложениях:
-    // Поле 1 - общее количество GSV сообщений для полного набора данных
-    // Поле 2 - номер текущего GSV сообщения
-    // Поле 3 - общее количество видимых спутников
-    // Поля 4-7, 8-11, 12-15, 16-19 - данные по 4 спутникам за сообщение
-
-    // Используем поле 3 - общее количество видимых спутников
-    if (strlen(fields[3]) > 0) {
-        gps_data->satellites_visible = atoi(fields[3]);
-        gps_data->has_satellites_visible = 1;
-        gps_data->has_gsv = 1;
-    }
-}
-
-// Парсинг VTG сообщения - курс и скорость относительно земли
-static void parse_vtg(const char* sentence, gps_data_t* gps_data) {
-    char fields[20][16] = {0};
-    int field_count = parse_fields(sentence, fields, 20);
-
-    if (field_count < 8) return;
-
-    // VTG используется как дополнение к RMC
-    // Курс относительно истинного севера (поле 1)
-    if (strlen(fields[1]) > 0 && isnan(gps_data->course)) {
-        gps_data->course = round(atof(fields[1]) * 10.0) / 10.0;
-    }
-
-    // Скорость в км/ч (поле 7) - конвертируем в м/с
-    // Используем только если в RMC не было скорости
-    if (strlen(fields[7]) > 0 && (isnan(gps_data->speed) || gps_data->speed < 0.1)) {
-        double speed_kmh = atof(fields[7]);
-        gps_data->speed = round((speed_kmh / 3.6) * 10.0) / 10.0;
-    }
-
-    gps_data->has_vtg = 1;
-}
-
-// Функция расчета расстояния между двумя точками (формула гаверсинуса)
-static double calculate_distance_haversine(double lat1, double lon1, double lat2, double lon2) {
-    double lat1_rad = lat1 * DEG_TO_RAD;
-    double lon1_rad = lon1 * DEG_TO_RAD;
-    double lat2_rad = lat2 * DEG_TO_RAD;
-    double lon2_rad = lon2 * DEG_TO_RAD;
-
-    double dlat = lat2_rad - lat1_rad;
-    double dlon = lon2_rad - lon1_rad;
-
-    double a = sin(dlat/2) * sin(dlat/2) +
-               cos(lat1_rad) * cos(lat2_rad) *
-               sin(dlon/2) * sin(dlon/2);
-
-    double c = 2 * atan2(sqrt(a), sqrt(1-a));
-
-    return EARTH_RADIUS_M * c;
-}
-
 // Универсальная функция для расчета расстояния
 static mp_obj_t calculate_distance(size_t n_args, const mp_obj_t *args) {
     // Проверяем количество аргументов
@@ -651,56 +290,4163 @@ static mp_obj_t calculate_distance(size_t n_args, const mp_obj_t *args) {
     return mp_obj_new_float(distance);
 }
 
-// Основная функция парсинга NMEA строк
-static mp_obj_t parse_nmea_string(mp_obj_t string_obj) {
-    const char* nmea_string = mp_obj_str_get_str(string_obj);
+// Размер элемента буфера по коду типа array ('l' / 'L' - 8 байт на 64-битных портах)
+static size_t buffer_item_size(const mp_buffer_info_t* buf) {
+    return mp_binary_get_size('@', buf->typecode, NULL);
+}
 
-    if (!nmea_string || strlen(nmea_string) < 6) {
-        return mp_const_none;
+// Целые 32 бита: array('i') / array('I'), а также 'l' / 'L' там, где long 32-битный
+static int buffer_is_int32(const mp_buffer_info_t* buf) {
+    switch (buf->typecode) {
+        case 'i': case 'I': case 'l': case 'L': return buffer_item_size(buf) == 4;
+        default: return 0;
     }
+}
 
-    if (!checksum_valid(nmea_string)) {
-        return mp_const_none;
+// Количество элементов в буфере
+static inline size_t buffer_item_count(const mp_buffer_info_t* buf) {
+    return buf->len / buffer_item_size(buf);
+}
+
+// Получение 64-битного беззнакового целого (small int или long int)
+static uint64_t get_uint64(mp_obj_t obj) {
+    if (mp_obj_is_small_int(obj)) {
+        return (uint64_t)MP_OBJ_SMALL_INT_VALUE(obj);
+    }
+    uint8_t bytes[8];
+    mp_obj_int_to_bytes_impl(obj, false, sizeof(bytes), bytes);
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Получение буфера координат array('d') / array('f')
+static void get_float_buffer(mp_obj_t obj, mp_buffer_info_t* buf, int flags) {
+    mp_get_buffer_raise(obj, buf, flags);
+    if (buf->typecode != 'd' && buf->typecode != 'f') {
+        mp_raise_TypeError(MP_ERROR_TEXT("buffer must be array('d') or array('f')"));
     }
+}
 
-    // Инициализация при первом вызове
-    if (!gps_data_initialized) {
-        gps_data_init(&current_gps_data);
-        gps_data_initialized = 1;
+// Чтение значения из буфера array('d') / array('f') / array('q')
+static inline double buffer_load_double(const mp_buffer_info_t* buf, size_t i) {
+    switch (buf->typecode) {
+        case 'f': return ((const float*)buf->buf)[i];
+        case 'q': return (double)((const int64_t*)buf->buf)[i];
+        default: return ((const double*)buf->buf)[i];
+    }
+}
+
+// Запись значения в буфер array('d') / array('f')
+static inline void buffer_store_double(mp_buffer_info_t* buf, size_t i, double value) {
+    if (buf->typecode == 'f') {
+        ((float*)buf->buf)[i] = (float)value;
+    } else {
+        ((double*)buf->buf)[i] = value;
     }
+}
+
+// Кэш тригонометрии текущей позиции (пересчитывается только при смене координат)
+typedef struct {
+    double latitude;
+    double longitude;
+    double lat_rad;
+    double lon_rad;
+    double sin_lat;
+    double cos_lat;
+} point_trig_t;
+
+static point_trig_t current_trig = { NAN, NAN, 0, 0, 0, 0 };
+
+// Заполнение тригонометрии точки
+static void point_trig_set(point_trig_t* trig, double lat, double lon) {
+    trig->latitude = lat;
+    trig->longitude = lon;
+    trig->lat_rad = lat * DEG_TO_RAD;
+    trig->lon_rad = lon * DEG_TO_RAD;
+    trig->sin_lat = sin(trig->lat_rad);
+    trig->cos_lat = cos(trig->lat_rad);
+}
 
-    // Определяем тип сообщения и парсим
-    // ЛОГИКА: Каждое предложение дополняет общую картину данных
-    if (strstr(nmea_string, "$GPRMC") == nmea_string ||
-        strstr(nmea_string, "$GNRMC") == nmea_string) {
-        parse_rmc(nmea_string, &current_gps_data);
+// Тригонометрия текущей позиции (NULL, если позиции нет)
+static const point_trig_t* current_point_trig(void) {
+    if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+        return NULL;
     }
-    else if (strstr(nmea_string, "$GPGGA") == nmea_string ||
-             strstr(nmea_string, "$GNGGA") == nmea_string) {
-        parse_gga(nmea_string, &current_gps_data);
+    if (current_trig.latitude != current_gps_data.latitude ||
+        current_trig.longitude != current_gps_data.longitude) {
+        point_trig_set(&current_trig, current_gps_data.latitude, current_gps_data.longitude);
     }
-    else if (strstr(nmea_string, "$GPGSA") == nmea_string ||
-             strstr(nmea_string, "$GNGSA") == nmea_string) {
-        parse_gsa(nmea_string, &current_gps_data);
+    return &current_trig;
+}
+
+// Точка [lat, lon] из любой последовательности без проверок типа
+static void get_point_trig(mp_obj_t obj, point_trig_t* trig) {
+    size_t len;
+    mp_obj_t* items;
+    mp_obj_get_array(obj, &len, &items);
+    if (len < 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("point must have at least 2 elements [lat, lon]"));
     }
-    else if (strstr(nmea_string, "$GPGSV") == nmea_string ||
-             strstr(nmea_string, "$GLGSV") == nmea_string ||
-             strstr(nmea_string, "$GNGSV") == nmea_string ||
-             strstr(nmea_string, "$GBGSV") == nmea_string) {
-        parse_gsv(nmea_string, &current_gps_data);
+    point_trig_set(trig, mp_obj_get_float(items[0]), mp_obj_get_float(items[1]));
+}
+
+// Расстояние (м) и начальный азимут (градусы 0..360) с общей тригонометрией
+static void distance_bearing_trig(const point_trig_t* a, const point_trig_t* b, double* distance, double* bearing) {
+    double dlon = b->lon_rad - a->lon_rad;
+    double sin_dlon = sin(dlon), cos_dlon = cos(dlon);
+    double sin_half_dlat = sin((b->lat_rad - a->lat_rad) / 2);
+    double sin_half_dlon = sin(dlon / 2);
+
+    double h = sin_half_dlat * sin_half_dlat + a->cos_lat * b->cos_lat * sin_half_dlon * sin_half_dlon;
+    *distance = EARTH_RADIUS_M * 2 * atan2(sqrt(h), sqrt(1 - h));
+
+    double y = sin_dlon * b->cos_lat;
+    double x = a->cos_lat * b->sin_lat - a->sin_lat * b->cos_lat * cos_dlon;
+    double theta = atan2(y, x) / DEG_TO_RAD;
+    *bearing = (theta < 0.0) ? theta + 360.0 : theta;
+}
+
+// Точка назначения по начальной точке, расстоянию (м) и азимуту (градусы)
+static void destination_trig(const point_trig_t* a, double distance, double bearing, double* lat, double* lon) {
+    double delta = distance / EARTH_RADIUS_M;
+    double theta = bearing * DEG_TO_RAD;
+    double sin_delta = sin(delta), cos_delta = cos(delta);
+
+    double sin_lat2 = a->sin_lat * cos_delta + a->cos_lat * sin_delta * cos(theta);
+    double lat2 = asin(sin_lat2);
+    double lon2 = a->lon_rad + atan2(sin(theta) * sin_delta * a->cos_lat, cos_delta - a->sin_lat * sin_lat2);
+
+    *lat = lat2 / DEG_TO_RAD;
+    *lon = lon2 / DEG_TO_RAD;
+    if (*lon > 180.0) *lon -= 360.0;
+    if (*lon < -180.0) *lon += 360.0;
+}
+
+// Середина дуги большого круга
+static void midpoint_trig(const point_trig_t* a, const point_trig_t* b, double* lat, double* lon) {
+    double dlon = b->lon_rad - a->lon_rad;
+    double bx = b->cos_lat * cos(dlon);
+    double by = b->cos_lat * sin(dlon);
+
+    *lat = atan2(a->sin_lat + b->sin_lat, sqrt((a->cos_lat + bx) * (a->cos_lat + bx) + by * by)) / DEG_TO_RAD;
+    *lon = (a->lon_rad + atan2(by, a->cos_lat + bx)) / DEG_TO_RAD;
+    if (*lon > 180.0) *lon -= 360.0;
+    if (*lon < -180.0) *lon += 360.0;
+}
+
+// Пара чисел (lat, lon) в кортеже
+static mp_obj_t new_float_pair(double a, double b) {
+    mp_obj_t items[2];
+    items[0] = mp_obj_new_float(a);
+    items[1] = mp_obj_new_float(b);
+    return mp_obj_new_tuple(2, items);
+}
+
+// distance_bearing([a,] b) -> (distance_m, bearing_deg); с одним аргументом от текущей позиции
+static mp_obj_t distance_bearing(size_t n_args, const mp_obj_t *args) {
+    point_trig_t a_trig, b_trig;
+    const point_trig_t* a = &a_trig;
+
+    if (n_args == 1) {
+        a = current_point_trig();
+        if (!a) return mp_const_none;
+    } else {
+        get_point_trig(args[0], &a_trig);
     }
-    else if (strstr(nmea_string, "$GPVTG") == nmea_string ||
-             strstr(nmea_string, "$GNVTG") == nmea_string) {
-        parse_vtg(nmea_string, &current_gps_data);
+    get_point_trig(args[n_args - 1], &b_trig);
+
+    double distance, bearing;
+    distance_bearing_trig(a, &b_trig, &distance, &bearing);
+    return new_float_pair(round(distance * 10.0) / 10.0, round(bearing * 10.0) / 10.0);
+}
+
+// destination([a,] distance_m, bearing_deg) -> (lat, lon); без точки - от текущей позиции
+static mp_obj_t destination(size_t n_args, const mp_obj_t *args) {
+    point_trig_t a_trig;
+    const point_trig_t* a = &a_trig;
+
+    if (n_args == 2) {
+        a = current_point_trig();
+        if (!a) return mp_const_none;
+    } else {
+        get_point_trig(args[0], &a_trig);
     }
 
-    return create_gps_dict_from_data(&current_gps_data);
+    double lat, lon;
+    destination_trig(a, mp_obj_get_float(args[n_args - 2]), mp_obj_get_float(args[n_args - 1]), &lat, &lon);
+    return new_float_pair(lat, lon);
 }
 
-// Функция сброса данных
-static mp_obj_t reset_gps_data(void) {
-    gps_data_init(&current_gps_data);
-    gps_data_initialized = 1;
+// midpoint([a,] b) -> (lat, lon); с одним аргументом от текущей позиции
+static mp_obj_t midpoint(size_t n_args, const mp_obj_t *args) {
+    point_trig_t a_trig, b_trig;
+    const point_trig_t* a = &a_trig;
+
+    if (n_args == 1) {
+        a = current_point_trig();
+        if (!a) return mp_const_none;
+    } else {
+        get_point_trig(args[0], &a_trig);
+    }
+    get_point_trig(args[n_args - 1], &b_trig);
+
+    double lat, lon;
+    midpoint_trig(a, &b_trig, &lat, &lon);
+    return new_float_pair(lat, lon);
+}
+
+// Начальная точка пакетной операции: [lat, lon] или текущая позиция
+static const point_trig_t* get_origin_trig(size_t n_args, const mp_obj_t *args, size_t index, point_trig_t* storage) {
+    if (n_args > index && args[index] != mp_const_none) {
+        get_point_trig(args[index], storage);
+        return storage;
+    }
+    const point_trig_t* origin = current_point_trig();
+    if (!origin) {
+        mp_raise_ValueError(MP_ERROR_TEXT("no current position"));
+    }
+    return origin;
+}
+
+// distance_bearing_batch(lats, lons, distances_out, bearings_out[, origin])
+static mp_obj_t distance_bearing_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t lats_buf, lons_buf, dist_buf, bear_buf;
+    get_float_buffer(args[0], &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lons_buf, MP_BUFFER_READ);
+    get_float_buffer(args[2], &dist_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[3], &bear_buf, MP_BUFFER_WRITE);
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+    if (buffer_item_count(&dist_buf) < count || buffer_item_count(&bear_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+    }
+
+    point_trig_t origin_storage;
+    const point_trig_t* origin = get_origin_trig(n_args, args, 4, &origin_storage);
+
+    for (size_t i = 0; i < count; i++) {
+        point_trig_t b;
+        double distance, bearing;
+        point_trig_set(&b, buffer_load_double(&lats_buf, i), buffer_load_double(&lons_buf, i));
+        distance_bearing_trig(origin, &b, &distance, &bearing);
+        buffer_store_double(&dist_buf, i, distance);
+        buffer_store_double(&bear_buf, i, bearing);
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// destination_batch(distances, bearings, lats_out, lons_out[, origin])
+static mp_obj_t destination_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t dist_buf, bear_buf, lats_buf, lons_buf;
+    get_float_buffer(args[0], &dist_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &bear_buf, MP_BUFFER_READ);
+    get_float_buffer(args[2], &lats_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[3], &lons_buf, MP_BUFFER_WRITE);
+
+    size_t count = buffer_item_count(&dist_buf);
+    if (buffer_item_count(&bear_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("distances and bearings must have the same length"));
+    }
+    if (buffer_item_count(&lats_buf) < count || buffer_item_count(&lons_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+    }
+
+    point_trig_t origin_storage;
+    const point_trig_t* origin = get_origin_trig(n_args, args, 4, &origin_storage);
+
+    for (size_t i = 0; i < count; i++) {
+        double lat, lon;
+        destination_trig(origin, buffer_load_double(&dist_buf, i), buffer_load_double(&bear_buf, i), &lat, &lon);
+        buffer_store_double(&lats_buf, i, lat);
+        buffer_store_double(&lons_buf, i, lon);
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// Размер блока матрицы расстояний (точек по каждой оси)
+#ifndef DISTANCE_BLOCK
+#define DISTANCE_BLOCK 64
+#endif
+
+// Предвычисленная тригонометрия точки для попарных расстояний:
+// sin((b - a) / 2) раскладывается через половинные углы без sin() на каждую пару
+typedef struct {
+    double sin_half_lat;
+    double cos_half_lat;
+    double sin_half_lon;
+    double cos_half_lon;
+    double cos_lat;
+} pair_trig_t;
+
+static inline void pair_trig_set(pair_trig_t* trig, double lat, double lon) {
+    double half_lat = lat * DEG_TO_RAD / 2;
+    double half_lon = lon * DEG_TO_RAD / 2;
+    trig->sin_half_lat = sin(half_lat);
+    trig->cos_half_lat = cos(half_lat);
+    trig->sin_half_lon = sin(half_lon);
+    trig->cos_half_lon = cos(half_lon);
+    trig->cos_lat = cos(lat * DEG_TO_RAD);
+}
+
+// Параметр гаверсинуса h для пары точек (расстояние = 2R * asin(sqrt(h)))
+static inline double pair_haversine(const pair_trig_t* a, const pair_trig_t* b) {
+    double s_dlat = b->sin_half_lat * a->cos_half_lat - b->cos_half_lat * a->sin_half_lat;
+    double s_dlon = b->sin_half_lon * a->cos_half_lon - b->cos_half_lon * a->sin_half_lon;
+    return s_dlat * s_dlat + a->cos_lat * b->cos_lat * s_dlon * s_dlon;
+}
+
+static inline double pair_distance_from_h(double h) {
+    if (h > 1.0) h = 1.0;
+    return 2.0 * EARTH_RADIUS_M * asin(sqrt(h));
+}
+
+// Буферы двух наборов точек для попарных операций
+static void get_pair_sets(const mp_obj_t *args, mp_buffer_info_t* bufs, size_t* n, size_t* m) {
+    for (int i = 0; i < 4; i++) {
+        get_float_buffer(args[i], &bufs[i], MP_BUFFER_READ);
+    }
+    *n = buffer_item_count(&bufs[0]);
+    *m = buffer_item_count(&bufs[2]);
+    if (buffer_item_count(&bufs[1]) != *n || buffer_item_count(&bufs[3]) != *m) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+}
+
+// distance_matrix(a_lats, a_lons, b_lats, b_lons, out) - out[i * len(b) + j] в метрах
+// Считается блоками DISTANCE_BLOCK x DISTANCE_BLOCK, тригонометрия блока на стеке
+static mp_obj_t distance_matrix(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufs[4], out_buf;
+    size_t n, m;
+    get_pair_sets(args, bufs, &n, &m);
+    get_float_buffer(args[4], &out_buf, MP_BUFFER_WRITE);
+
+    if (buffer_item_count(&out_buf) < n * m) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output array is too small"));
+    }
+
+    pair_trig_t a_block[DISTANCE_BLOCK];
+    pair_trig_t b_block[DISTANCE_BLOCK];
+
+    for (size_t i0 = 0; i0 < n; i0 += DISTANCE_BLOCK) {
+        size_t ni = (n - i0 < DISTANCE_BLOCK) ? n - i0 : DISTANCE_BLOCK;
+        for (size_t i = 0; i < ni; i++) {
+            pair_trig_set(&a_block[i], buffer_load_double(&bufs[0], i0 + i), buffer_load_double(&bufs[1], i0 + i));
+        }
+
+        for (size_t j0 = 0; j0 < m; j0 += DISTANCE_BLOCK) {
+            size_t nj = (m - j0 < DISTANCE_BLOCK) ? m - j0 : DISTANCE_BLOCK;
+            for (size_t j = 0; j < nj; j++) {
+                pair_trig_set(&b_block[j], buffer_load_double(&bufs[2], j0 + j), buffer_load_double(&bufs[3], j0 + j));
+            }
+
+            for (size_t i = 0; i < ni; i++) {
+                size_t row = (i0 + i) * m + j0;
+                if (out_buf.typecode == 'f') {
+                    float* out = (float*)out_buf.buf + row;
+                    for (size_t j = 0; j < nj; j++) {
+                        out[j] = (float)pair_distance_from_h(pair_haversine(&a_block[i], &b_block[j]));
+                    }
+                } else {
+                    double* out = (double*)out_buf.buf + row;
+                    for (size_t j = 0; j < nj; j++) {
+                        out[j] = pair_distance_from_h(pair_haversine(&a_block[i], &b_block[j]));
+                    }
+                }
+            }
+        }
+    }
+
+    return mp_obj_new_int(n * m);
+}
+
+// Ячейка сетки предварительного отбора
+static inline void grid_cell(double lat, double lon, double cell_lat, double cell_lon,
+                             int32_t* cy, int32_t* cx) {
+    *cy = (int32_t)floor((lat + 90.0) / cell_lat);
+    *cx = (int32_t)floor((lon + 180.0) / cell_lon);
+}
+
+// Хэш ячейки в корзину таблицы (размер - степень двойки)
+static inline uint32_t grid_bucket(int32_t cy, int32_t cx, uint32_t mask) {
+    uint32_t h = (uint32_t)cy * 73856093u ^ (uint32_t)cx * 19349663u;
+    return h & mask;
+}
+
+// pairs_within(a_lats, a_lons, b_lats, b_lons, radius_m, pairs_out[, distances_out])
+// pairs_out: array('I') пар индексов (i, j) подряд; distances_out - array('d') / array('f')
+// Возвращает полное число найденных пар (записывается не больше, чем помещается в буферы)
+static mp_obj_t pairs_within(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufs[4], pairs_buf, dist_buf;
+    size_t n, m;
+    get_pair_sets(args, bufs, &n, &m);
+    double radius = mp_obj_get_float(args[4]);
+    mp_get_buffer_raise(args[5], &pairs_buf, MP_BUFFER_WRITE);
+
+    if (!buffer_is_int32(&pairs_buf)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("pairs must be array('I')"));
+    }
+    int has_dist = (n_args > 6 && args[6] != mp_const_none);
+    if (has_dist) {
+        get_float_buffer(args[6], &dist_buf, MP_BUFFER_WRITE);
+    }
+    if (radius <= 0.0 || n == 0 || m == 0) {
+        return mp_obj_new_int(0);
+    }
+
+    size_t capacity = buffer_item_count(&pairs_buf) / 2;
+    if (has_dist && buffer_item_count(&dist_buf) < capacity) {
+        capacity = buffer_item_count(&dist_buf);
+    }
+
+    // Размер ячейки: по широте - радиус, по долготе - радиус на самой высокой широте наборов
+    double max_abs_lat = 0.0;
+    for (size_t k = 0; k < 2; k++) {
+        size_t count = k ? m : n;
+        for (size_t i = 0; i < count; i++) {
+            double lat = fabs(buffer_load_double(&bufs[k * 2], i));
+            if (lat > max_abs_lat) max_abs_lat = lat;
+        }
+    }
+
+    double cell_lat = radius / EARTH_RADIUS_M / DEG_TO_RAD;
+    double cos_max = cos((max_abs_lat + cell_lat) * DEG_TO_RAD);
+    double cell_lon = (cos_max > 1e-6) ? cell_lat / cos_max : 360.0;
+    // Число столбцов округляется вниз, чтобы все столбцы (включая стык у 180-го меридиана) были не уже радиуса
+    int32_t columns = (cell_lon >= 360.0) ? 1 : (int32_t)floor(360.0 / cell_lon);
+    if (columns < 1) columns = 1;
+    cell_lon = 360.0 / columns;
+    if (cell_lat > 180.0) cell_lat = 180.0;
+
+    // Таблица корзин (подсчет + префиксные суммы), размер - степень двойки >= m
+    uint32_t table_size = 1;
+    while (table_size < m) table_size <<= 1;
+    uint32_t mask = table_size - 1;
+
+    uint32_t* bucket_start = m_new(uint32_t, table_size + 1);
+    uint32_t* b_bucket = m_new(uint32_t, m);
+    uint32_t* order = m_new(uint32_t, m);
+    pair_trig_t* b_trig = m_new(pair_trig_t, m);
+    memset(bucket_start, 0, (table_size + 1) * sizeof(uint32_t));
+
+    for (size_t j = 0; j < m; j++) {
+        double lat = buffer_load_double(&bufs[2], j);
+        double lon = buffer_load_double(&bufs[3], j);
+        int32_t cy, cx;
+        grid_cell(lat, lon, cell_lat, cell_lon, &cy, &cx);
+        cx = ((cx % columns) + columns) % columns;
+        b_bucket[j] = grid_bucket(cy, cx, mask);
+        bucket_start[b_bucket[j] + 1]++;
+        pair_trig_set(&b_trig[j], lat, lon);
+    }
+    for (uint32_t k = 0; k < table_size; k++) {
+        bucket_start[k + 1] += bucket_start[k];
+    }
+    for (size_t j = 0; j < m; j++) {
+        order[bucket_start[b_bucket[j]]++] = (uint32_t)j;
+    }
+    // После раскладки bucket_start[k] указывает на конец корзины k - сдвигаем обратно
+    for (uint32_t k = table_size; k > 0; k--) {
+        bucket_start[k] = bucket_start[k - 1];
+    }
+    bucket_start[0] = 0;
+
+    double h_limit = sin(radius / EARTH_RADIUS_M / 2);
+    h_limit *= h_limit;
+
+    uint32_t* pairs = (uint32_t*)pairs_buf.buf;
+    size_t found = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        double lat = buffer_load_double(&bufs[0], i);
+        double lon = buffer_load_double(&bufs[1], i);
+        pair_trig_t a;
+        pair_trig_set(&a, lat, lon);
+
+        int32_t cy, cx;
+        grid_cell(lat, lon, cell_lat, cell_lon, &cy, &cx);
+
+        // 3x3 соседние ячейки; одинаковые корзины обходим один раз
+        uint32_t visited[9];
+        int visited_count = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int32_t ncx = (((cx + dx) % columns) + columns) % columns;
+                uint32_t bucket = grid_bucket(cy + dy, ncx, mask);
+
+                int seen = 0;
+                for (int k = 0; k < visited_count; k++) {
+                    if (visited[k] == bucket) { seen = 1; break; }
+                }
+                if (seen) continue;
+                visited[visited_count++] = bucket;
+
+                for (uint32_t k = bucket_start[bucket]; k < bucket_start[bucket + 1]; k++) {
+                    uint32_t j = order[k];
+                    double h = pair_haversine(&a, &b_trig[j]);
+                    if (h > h_limit) continue;
+
+                    if (found < capacity) {
+                        pairs[found * 2] = (uint32_t)i;
+                        pairs[found * 2 + 1] = j;
+                        if (has_dist) {
+                            buffer_store_double(&dist_buf, found, pair_distance_from_h(h));
+                        }
+                    }
+                    found++;
+                }
+            }
+        }
+    }
+
+    m_del(pair_trig_t, b_trig, m);
+    m_del(uint32_t, order, m);
+    m_del(uint32_t, b_bucket, m);
+    m_del(uint32_t, bucket_start, table_size + 1);
+
+    return mp_obj_new_int(found);
+}
+
+// Добавление фикса в историю
+static void history_record(const gps_data_t* gps_data) {
+    if (isnan(gps_data->latitude) || isnan(gps_data->longitude)) return;
+    if (!gps_data->valid && gps_data->fix_type == 0) return;
+
+    int64_t utc_ms = gps_data_utc_ms(gps_data);
+    if (utc_ms < 0) return;
+
+    if (gps_history_count > 0) {
+        uint16_t last = (gps_history_head + gps_history_count - 1) % GPS_HISTORY_CAPACITY;
+        gps_history_entry_t* entry = &gps_history[last];
+
+        // То же время - уточняем запись (GGA после RMC в одной эпохе)
+        if (utc_ms == entry->utc_ms) {
+            entry->latitude = gps_data->latitude;
+            entry->longitude = gps_data->longitude;
+            return;
+        }
+
+        // Ключ должен быть монотонным (например, GGA после полуночи до прихода RMC с новой датой)
+        if (utc_ms < entry->utc_ms) return;
+    }
+
+    uint16_t slot;
+    if (gps_history_count < GPS_HISTORY_CAPACITY) {
+        slot = (gps_history_head + gps_history_count) % GPS_HISTORY_CAPACITY;
+        gps_history_count++;
+    } else {
+        // Буфер заполнен - перезаписываем самую старую запись
+        slot = gps_history_head;
+        gps_history_head = (gps_history_head + 1) % GPS_HISTORY_CAPACITY;
+    }
+
+    gps_history[slot].utc_ms = utc_ms;
+    gps_history[slot].latitude = gps_data->latitude;
+    gps_history[slot].longitude = gps_data->longitude;
+}
+
+// Доступ к записи истории по логическому индексу (0 - самая старая)
+static inline const gps_history_entry_t* history_at(uint16_t index) {
+    return &gps_history[(gps_history_head + index) % GPS_HISTORY_CAPACITY];
+}
+
+// Интерполяция позиции на момент t_ms (линейная или по большому кругу)
+// Возвращает 0, если момент вне диапазона истории
+static int history_interpolate(double t_ms, int great_circle, double* lat, double* lon) {
+    if (gps_history_count == 0 || isnan(t_ms)) return 0;
+
+    const gps_history_entry_t* first = history_at(0);
+    const gps_history_entry_t* last = history_at(gps_history_count - 1);
+    if (t_ms < (double)first->utc_ms || t_ms > (double)last->utc_ms) return 0;
+
+    // Бинарный поиск первой записи с utc_ms >= t_ms
+    uint16_t lo = 0;
+    uint16_t hi = gps_history_count - 1;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if ((double)history_at(mid)->utc_ms < t_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    const gps_history_entry_t* b = history_at(lo);
+    if (lo == 0 || (double)b->utc_ms == t_ms) {
+        *lat = b->latitude;
+        *lon = b->longitude;
+        return 1;
+    }
+
+    const gps_history_entry_t* a = history_at(lo - 1);
+    double f = (t_ms - (double)a->utc_ms) / (double)(b->utc_ms - a->utc_ms);
+
+    if (great_circle) {
+        double lat1 = a->latitude * DEG_TO_RAD;
+        double lon1 = a->longitude * DEG_TO_RAD;
+        double lat2 = b->latitude * DEG_TO_RAD;
+        double lon2 = b->longitude * DEG_TO_RAD;
+
+        double x1 = cos(lat1) * cos(lon1), y1 = cos(lat1) * sin(lon1), z1 = sin(lat1);
+        double x2 = cos(lat2) * cos(lon2), y2 = cos(lat2) * sin(lon2), z2 = sin(lat2);
+
+        double dot = x1 * x2 + y1 * y2 + z1 * z2;
+        if (dot > 1.0) dot = 1.0;
+        double d = acos(dot);
+
+        // Для очень близких точек сферическая интерполяция вырождается
+        if (d > 1e-9) {
+            double sin_d = sin(d);
+            double ka = sin((1.0 - f) * d) / sin_d;
+            double kb = sin(f * d) / sin_d;
+            double x = ka * x1 + kb * x2;
+            double y = ka * y1 + kb * y2;
+            double z = ka * z1 + kb * z2;
+            *lat = atan2(z, sqrt(x * x + y * y)) / DEG_TO_RAD;
+            *lon = atan2(y, x) / DEG_TO_RAD;
+            return 1;
+        }
+    }
+
+    // Линейная интерполяция с учетом перехода через 180-й меридиан
+    double dlon = b->longitude - a->longitude;
+    if (dlon > 180.0) dlon -= 360.0;
+    if (dlon < -180.0) dlon += 360.0;
+
+    *lat = a->latitude + (b->latitude - a->latitude) * f;
+    *lon = a->longitude + dlon * f;
+    if (*lon > 180.0) *lon -= 360.0;
+    if (*lon < -180.0) *lon += 360.0;
+    return 1;
+}
+
+// Позиция на заданный момент: position_at(utc_ms[, great_circle])
+// Целое utc_ms читается без mp_float_t: одинарной точности (~1.7e12 мс) хватает лишь на шаг ~131 с
+static mp_obj_t position_at(size_t n_args, const mp_obj_t *args) {
+    double t_ms = mp_obj_is_float(args[0]) ? mp_obj_get_float(args[0]) : (double)(int64_t)get_uint64(args[0]);
+    int great_circle = (n_args > 1) ? mp_obj_is_true(args[1]) : 0;
+
+    double lat, lon;
+    if (!history_interpolate(t_ms, great_circle, &lat, &lon)) {
+        return mp_const_none;
+    }
+
+    mp_obj_t items[2];
+    items[0] = mp_obj_new_float(lat);
+    items[1] = mp_obj_new_float(lon);
+    return mp_obj_new_tuple(2, items);
+}
+
+// Пакетная версия: positions_at(times, lats_out, lons_out[, great_circle])
+// Возвращает количество моментов, попавших в диапазон истории
+static mp_obj_t positions_at(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t times_buf, lats_buf, lons_buf;
+    mp_get_buffer_raise(args[0], &times_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lats_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[2], &lons_buf, MP_BUFFER_WRITE);
+    int great_circle = (n_args > 3) ? mp_obj_is_true(args[3]) : 0;
+
+    if (times_buf.typecode != 'q' && times_buf.typecode != 'd') {
+        mp_raise_TypeError(MP_ERROR_TEXT("times must be array('q') or array('d')"));
+    }
+
+    size_t count = buffer_item_count(&times_buf);
+    if (buffer_item_count(&lats_buf) < count || buffer_item_count(&lons_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output arrays are shorter than times"));
+    }
+
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        double lat = NAN, lon = NAN;
+        if (history_interpolate(buffer_load_double(&times_buf, i), great_circle, &lat, &lon)) {
+            found++;
+        }
+        buffer_store_double(&lats_buf, i, lat);
+        buffer_store_double(&lons_buf, i, lon);
+    }
+
+    return mp_obj_new_int(found);
+}
+
+// Количество записей в истории
+static mp_obj_t history_len(void) {
+    return mp_obj_new_int(gps_history_count);
+}
+
+// Очистка истории
+static mp_obj_t history_clear(void) {
+    gps_history_head = 0;
+    gps_history_count = 0;
+    return mp_const_none;
+}
+
+// Окно локального поиска сегмента маршрута (в сегментах в каждую сторону)
+#ifndef ROUTE_LOCAL_WINDOW
+#define ROUTE_LOCAL_WINDOW 4
+#endif
+
+// Расширенное окно поиска при скачке позиции
+#ifndef ROUTE_JUMP_WINDOW
+#define ROUTE_JUMP_WINDOW 64
+#endif
+
+// Порог бокового отклонения, после которого считаем что был скачок (м)
+#ifndef ROUTE_JUMP_DISTANCE_M
+#define ROUTE_JUMP_DISTANCE_M 50.0f
+#endif
+
+// Маршрут: ломаная в локальной равнопромежуточной проекции (метры)
+typedef struct _route_obj_t {
+    mp_obj_base_t base;
+    size_t vertex_count;
+    double lat0;            // центр проекции
+    double lon0;
+    double kx;              // метров на градус долготы
+    double ky;              // метров на градус широты
+    float* x;               // вершины в проекции
+    float* y;
+    float* cumulative;      // длина маршрута до вершины i
+    float total_length;
+    size_t segment;         // текущий сегмент
+    uint8_t has_segment;
+    float cross_track;      // > 0 справа от направления маршрута
+    float along_track;
+} route_obj_t;
+
+// Результат проекции точки на сегмент
+typedef struct {
+    float distance;         // расстояние до сегмента (без знака)
+    float cross;            // со знаком
+    float along;            // пройдено от начала маршрута
+} route_projection_t;
+
+// Проекция точки (px, py) на сегмент i
+static void route_project_segment(const route_obj_t* route, size_t i, float px, float py,
+                                  route_projection_t* result) {
+    float ax = route->x[i], ay = route->y[i];
+    float sx = route->x[i + 1] - ax, sy = route->y[i + 1] - ay;
+    float seg_len = route->cumulative[i + 1] - route->cumulative[i];
+    float dx = px - ax, dy = py - ay;
+
+    float t = 0.0f;
+    if (seg_len > 0.0f) {
+        t = (dx * sx + dy * sy) / (seg_len * seg_len);
+        if (t < 0.0f) t = 0.0f;
+        if (t > 1.0f) t = 1.0f;
+    }
+
+    float ex = dx - t * sx, ey = dy - t * sy;
+    result->distance = sqrtf(ex * ex + ey * ey);
+
+    // Знак по векторному произведению: справа от сегмента - положительный
+    float cross = sx * dy - sy * dx;
+    result->cross = (cross > 0.0f) ? -result->distance : result->distance;
+    result->along = route->cumulative[i] + t * seg_len;
+}
+
+// Поиск ближайшего сегмента в окне [first, last]
+static size_t route_search(const route_obj_t* route, size_t first, size_t last, float px, float py,
+                           route_projection_t* best) {
+    size_t best_segment = first;
+    best->distance = INFINITY;
+
+    for (size_t i = first; i <= last; i++) {
+        route_projection_t p;
+        route_project_segment(route, i, px, py, &p);
+        if (p.distance < best->distance) {
+            *best = p;
+            best_segment = i;
+        }
+    }
+
+    return best_segment;
+}
+
+// Поиск в окне +-window вокруг текущего сегмента
+static size_t route_search_window(const route_obj_t* route, size_t window, float px, float py,
+                                  route_projection_t* best) {
+    size_t last_segment = route->vertex_count - 2;
+    size_t first = (route->segment > window) ? route->segment - window : 0;
+    size_t last = route->segment + window;
+    if (last > last_segment) last = last_segment;
+    return route_search(route, first, last, px, py, best);
+}
+
+// Обновление позиции на маршруте
+static void route_track(route_obj_t* route, double lat, double lon) {
+    double dlon = lon - route->lon0;
+    if (dlon > 180.0) dlon -= 360.0;
+    if (dlon < -180.0) dlon += 360.0;
+    float px = (float)(dlon * route->kx);
+    float py = (float)((lat - route->lat0) * route->ky);
+
+    route_projection_t best;
+    if (!route->has_segment) {
+        // Первый фикс - полный просмотр маршрута
+        route->segment = route_search(route, 0, route->vertex_count - 2, px, py, &best);
+        route->has_segment = 1;
+    } else {
+        route->segment = route_search_window(route, ROUTE_LOCAL_WINDOW, px, py, &best);
+
+        // Скачок позиции - ограниченный расширенный поиск
+        if (best.distance > ROUTE_JUMP_DISTANCE_M) {
+            route->segment = route_search_window(route, ROUTE_JUMP_WINDOW, px, py, &best);
+        }
+    }
+
+    route->cross_track = best.cross;
+    route->along_track = best.along;
+}
+
+// Route(lats, lons) - построение маршрута из буферов array('d') / array('f')
+static mp_obj_t route_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 2, 2, false);
+
+    mp_buffer_info_t lats_buf, lons_buf;
+    get_float_buffer(args[0], &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lons_buf, MP_BUFFER_READ);
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+    if (count < 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("route must have at least 2 points"));
+    }
+
+    route_obj_t* route = mp_obj_malloc(route_obj_t, type);
+    route->vertex_count = count;
+    route->x = m_new(float, count);
+    route->y = m_new(float, count);
+    route->cumulative = m_new(float, count);
+
+    // Центр проекции - середина охватывающего прямоугольника
+    double lat_min = 90.0, lat_max = -90.0;
+    for (size_t i = 0; i < count; i++) {
+        double lat = buffer_load_double(&lats_buf, i);
+        if (lat < lat_min) lat_min = lat;
+        if (lat > lat_max) lat_max = lat;
+    }
+    route->lat0 = (lat_min + lat_max) / 2.0;
+    route->lon0 = buffer_load_double(&lons_buf, 0);
+    route->ky = EARTH_RADIUS_M * DEG_TO_RAD;
+    route->kx = route->ky * cos(route->lat0 * DEG_TO_RAD);
+
+    float length = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        double dlon = buffer_load_double(&lons_buf, i) - route->lon0;
+        if (dlon > 180.0) dlon -= 360.0;
+        if (dlon < -180.0) dlon += 360.0;
+        route->x[i] = (float)(dlon * route->kx);
+        route->y[i] = (float)((buffer_load_double(&lats_buf, i) - route->lat0) * route->ky);
+
+        if (i > 0) {
+            float dx = route->x[i] - route->x[i - 1];
+            float dy = route->y[i] - route->y[i - 1];
+            length += sqrtf(dx * dx + dy * dy);
+        }
+        route->cumulative[i] = length;
+    }
+
+    route->total_length = length;
+    route->segment = 0;
+    route->has_segment = 0;
+    route->cross_track = NAN;
+    route->along_track = NAN;
+
+    return MP_OBJ_FROM_PTR(route);
+}
+
+// route.update([lat, lon]) - без аргументов берется текущая позиция
+// Возвращает (cross_track, along_track, remaining) в метрах или None
+static mp_obj_t route_update(size_t n_args, const mp_obj_t *args) {
+    route_obj_t* route = MP_OBJ_TO_PTR(args[0]);
+    double lat, lon;
+
+    if (n_args == 3) {
+        lat = mp_obj_get_float(args[1]);
+        lon = mp_obj_get_float(args[2]);
+    } else if (n_args == 2) {
+        mp_raise_TypeError(MP_ERROR_TEXT("update() takes lat and lon or no arguments"));
+    } else {
+        if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+            return mp_const_none;
+        }
+        lat = current_gps_data.latitude;
+        lon = current_gps_data.longitude;
+    }
+
+    route_track(route, lat, lon);
+
+    mp_obj_t items[3];
+    items[0] = mp_obj_new_float(route->cross_track);
+    items[1] = mp_obj_new_float(route->along_track);
+    items[2] = mp_obj_new_float(route->total_length - route->along_track);
+    return mp_obj_new_tuple(3, items);
+}
+
+// Боковое отклонение последнего обновления
+static mp_obj_t route_cross_track(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_float(route->cross_track);
+}
+
+// Пройденное расстояние вдоль маршрута
+static mp_obj_t route_along_track(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_float(route->along_track);
+}
+
+// Оставшееся расстояние до конца маршрута
+static mp_obj_t route_remaining(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_float(route->total_length - route->along_track);
+}
+
+// Текущий сегмент
+static mp_obj_t route_segment(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(route->segment);
+}
+
+// Полная длина маршрута
+static mp_obj_t route_length(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_float(route->total_length);
+}
+
+// Сброс отслеживания - следующий фикс выполнит полный поиск
+static mp_obj_t route_reset(mp_obj_t self_in) {
+    route_obj_t* route = MP_OBJ_TO_PTR(self_in);
+    route->segment = 0;
+    route->has_segment = 0;
+    route->cross_track = NAN;
+    route->along_track = NAN;
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(route_update_obj, 1, 3, route_update);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_cross_track_obj, route_cross_track);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_along_track_obj, route_along_track);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_remaining_obj, route_remaining);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_segment_obj, route_segment);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_length_obj, route_length);
+static MP_DEFINE_CONST_FUN_OBJ_1(route_reset_obj, route_reset);
+
+static const mp_rom_map_elem_t route_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&route_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cross_track), MP_ROM_PTR(&route_cross_track_obj) },
+    { MP_ROM_QSTR(MP_QSTR_along_track), MP_ROM_PTR(&route_along_track_obj) },
+    { MP_ROM_QSTR(MP_QSTR_remaining), MP_ROM_PTR(&route_remaining_obj) },
+    { MP_ROM_QSTR(MP_QSTR_segment), MP_ROM_PTR(&route_segment_obj) },
+    { MP_ROM_QSTR(MP_QSTR_length), MP_ROM_PTR(&route_length_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&route_reset_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(route_locals_dict, route_locals_dict_table);
+
+// Тип Route
+MP_DEFINE_CONST_OBJ_TYPE(
+    route_type,
+    MP_QSTR_Route,
+    MP_TYPE_FLAG_NONE,
+    make_new, route_make_new,
+    locals_dict, &route_locals_dict
+    );
+
+// Алфавит geohash (base32 без a, i, l, o)
+static const char geohash_alphabet[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+#define GEOHASH_MAX_PRECISION 12
+#define GEOHASH_DEFAULT_PRECISION 9
+
+// Кэш geohash текущей позиции: пересчитывается только при выходе из ячейки
+static char geohash_cache[GEOHASH_MAX_PRECISION + 1];
+static uint8_t geohash_cache_precision = 0;
+static double geohash_cache_lat_min, geohash_cache_lat_max;
+static double geohash_cache_lon_min, geohash_cache_lon_max;
+
+// Разнесение 30 бит на четные позиции 60-битного числа
+static uint64_t geohash_spread(uint32_t v) {
+    uint64_t x = v & 0x3FFFFFFF;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+}
+
+// Обратная операция: сбор четных бит в 30-битное число
+static uint32_t geohash_squash(uint64_t x) {
+    x &= 0x5555555555555555ULL;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t)x;
+}
+
+// Квантование координаты в 30 бит
+static uint32_t geohash_quantize(double value, double min, double range) {
+    double q = (value - min) / range * 1073741824.0;
+    if (q < 0.0) return 0;
+    if (q >= 1073741823.0) return 1073741823;
+    return (uint32_t)q;
+}
+
+// Кодирование в целое число из 5 * precision бит (первый бит - долгота)
+static uint64_t geohash_encode_int(double lat, double lon, uint8_t precision) {
+    uint64_t lat_bits = geohash_spread(geohash_quantize(lat, -90.0, 180.0));
+    uint64_t lon_bits = geohash_spread(geohash_quantize(lon, -180.0, 360.0));
+    uint64_t hash = (lon_bits << 1) | lat_bits;
+    return hash >> (60 - 5 * precision);
+}
+
+// Перевод целого geohash в строку
+static void geohash_int_to_str(uint64_t hash, uint8_t precision, char* out) {
+    for (int i = precision - 1; i >= 0; i--) {
+        out[i] = geohash_alphabet[hash & 0x1F];
+        hash >>= 5;
+    }
+    out[precision] = '\0';
+}
+
+// Перевод строки geohash в целое число (0 при ошибке)
+static int geohash_str_to_int(const char* str, size_t len, uint64_t* hash) {
+    if (len == 0 || len > GEOHASH_MAX_PRECISION) return 0;
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        const char* pos = strchr(geohash_alphabet, str[i]);
+        if (!pos || str[i] == '\0') return 0;
+        value = (value << 5) | (uint64_t)(pos - geohash_alphabet);
+    }
+
+    *hash = value;
+    return 1;
+}
+
+// Границы ячейки geohash из bits бит
+static void geohash_bounds(uint64_t hash, uint8_t bits, double* lat_min, double* lat_max,
+                           double* lon_min, double* lon_max) {
+    uint64_t full = hash << (60 - bits);
+    uint32_t lat_q = geohash_squash(full);
+    uint32_t lon_q = geohash_squash(full >> 1);
+
+    // Долгота получает ceil(bits / 2) бит, широта - floor(bits / 2)
+    uint8_t lon_bits = (bits + 1) / 2;
+    uint8_t lat_bits = bits / 2;
+    double lat_step = 180.0 / (double)(1ULL << lat_bits);
+    double lon_step = 360.0 / (double)(1ULL << lon_bits);
+
+    *lat_min = -90.0 + (double)(lat_q >> (30 - lat_bits)) * lat_step;
+    *lon_min = -180.0 + (double)(lon_q >> (30 - lon_bits)) * lon_step;
+    *lat_max = *lat_min + lat_step;
+    *lon_max = *lon_min + lon_step;
+}
+
+// Получение precision из аргумента с проверкой диапазона
+static uint8_t geohash_get_precision(mp_obj_t obj) {
+    mp_int_t precision = mp_obj_get_int(obj);
+    if (precision < 1 || precision > GEOHASH_MAX_PRECISION) {
+        mp_raise_ValueError(MP_ERROR_TEXT("precision must be between 1 and 12"));
+    }
+    return (uint8_t)precision;
+}
+
+// geohash текущей позиции (из кэша, если позиция не покинула ячейку)
+static const char* geohash_current(uint8_t precision) {
+    if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+        return NULL;
+    }
+
+    double lat = current_gps_data.latitude;
+    double lon = current_gps_data.longitude;
+
+    if (precision == geohash_cache_precision &&
+        lat >= geohash_cache_lat_min && lat < geohash_cache_lat_max &&
+        lon >= geohash_cache_lon_min && lon < geohash_cache_lon_max) {
+        return geohash_cache;
+    }
+
+    uint64_t hash = geohash_encode_int(lat, lon, precision);
+    geohash_int_to_str(hash, precision, geohash_cache);
+    geohash_bounds(hash, 5 * precision, &geohash_cache_lat_min, &geohash_cache_lat_max,
+                   &geohash_cache_lon_min, &geohash_cache_lon_max);
+    geohash_cache_precision = precision;
+    return geohash_cache;
+}
+
+// geohash_encode([lat, lon][, precision]) - без координат используется текущая позиция
+static mp_obj_t geohash_encode(size_t n_args, const mp_obj_t *args) {
+    uint8_t precision = GEOHASH_DEFAULT_PRECISION;
+
+    if (n_args <= 1) {
+        if (n_args == 1) precision = geohash_get_precision(args[0]);
+        const char* hash = geohash_current(precision);
+        if (!hash) return mp_const_none;
+        return mp_obj_new_str(hash, precision);
+    }
+
+    if (n_args == 3) precision = geohash_get_precision(args[2]);
+
+    char str[GEOHASH_MAX_PRECISION + 1];
+    uint64_t hash = geohash_encode_int(mp_obj_get_float(args[0]), mp_obj_get_float(args[1]), precision);
+    geohash_int_to_str(hash, precision, str);
+    return mp_obj_new_str(str, precision);
+}
+
+// geohash_int([lat, lon][, precision]) - geohash как целое из 5 * precision бит
+static mp_obj_t geohash_int(size_t n_args, const mp_obj_t *args) {
+    uint8_t precision = GEOHASH_DEFAULT_PRECISION;
+    double lat, lon;
+
+    if (n_args <= 1) {
+        if (n_args == 1) precision = geohash_get_precision(args[0]);
+        if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+            return mp_const_none;
+        }
+        lat = current_gps_data.latitude;
+        lon = current_gps_data.longitude;
+    } else {
+        if (n_args == 3) precision = geohash_get_precision(args[2]);
+        lat = mp_obj_get_float(args[0]);
+        lon = mp_obj_get_float(args[1]);
+    }
+
+    return mp_obj_new_int_from_ull(geohash_encode_int(lat, lon, precision));
+}
+
+// Разбор аргумента geohash: строка или (целое, precision)
+static uint8_t geohash_get_hash(size_t n_args, const mp_obj_t *args, uint64_t* hash) {
+    if (mp_obj_is_str(args[0])) {
+        size_t len;
+        const char* str = mp_obj_str_get_data(args[0], &len);
+        if (!geohash_str_to_int(str, len, hash)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid geohash"));
+        }
+        return (uint8_t)len;
+    }
+
+    if (n_args < 2) {
+        mp_raise_TypeError(MP_ERROR_TEXT("integer geohash requires precision"));
+    }
+    uint8_t precision = geohash_get_precision(args[1]);
+    *hash = get_uint64(args[0]) & ((1ULL << (5 * precision)) - 1);
+    return precision;
+}
+
+// geohash_decode(hash) / geohash_decode(int_hash, precision)
+// Возвращает (lat, lon, lat_err, lon_err) - центр ячейки и половина размера
+static mp_obj_t geohash_decode(size_t n_args, const mp_obj_t *args) {
+    uint64_t hash;
+    uint8_t precision = geohash_get_hash(n_args, args, &hash);
+
+    double lat_min, lat_max, lon_min, lon_max;
+    geohash_bounds(hash, 5 * precision, &lat_min, &lat_max, &lon_min, &lon_max);
+
+    mp_obj_t items[4];
+    items[0] = mp_obj_new_float((lat_min + lat_max) / 2.0);
+    items[1] = mp_obj_new_float((lon_min + lon_max) / 2.0);
+    items[2] = mp_obj_new_float((lat_max - lat_min) / 2.0);
+    items[3] = mp_obj_new_float((lon_max - lon_min) / 2.0);
+    return mp_obj_new_tuple(4, items);
+}
+
+// geohash_neighbours(hash) / geohash_neighbours(int_hash, precision)
+// Возвращает 8 соседей: N, NE, E, SE, S, SW, W, NW (None за полюсом)
+static mp_obj_t geohash_neighbours(size_t n_args, const mp_obj_t *args) {
+    static const int8_t offsets[8][2] = {
+        {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1},
+    };
+
+    uint64_t hash;
+    uint8_t precision = geohash_get_hash(n_args, args, &hash);
+    int as_str = mp_obj_is_str(args[0]);
+
+    double lat_min, lat_max, lon_min, lon_max;
+    geohash_bounds(hash, 5 * precision, &lat_min, &lat_max, &lon_min, &lon_max);
+    double lat_step = lat_max - lat_min;
+    double lon_step = lon_max - lon_min;
+    double lat_c = (lat_min + lat_max) / 2.0;
+    double lon_c = (lon_min + lon_max) / 2.0;
+
+    mp_obj_t items[8];
+    for (int i = 0; i < 8; i++) {
+        double lat = lat_c + offsets[i][0] * lat_step;
+        double lon = lon_c + offsets[i][1] * lon_step;
+        if (lat > 90.0 || lat < -90.0) {
+            items[i] = mp_const_none;
+            continue;
+        }
+        if (lon > 180.0) lon -= 360.0;
+        if (lon < -180.0) lon += 360.0;
+
+        uint64_t neighbour = geohash_encode_int(lat, lon, precision);
+        if (as_str) {
+            char str[GEOHASH_MAX_PRECISION + 1];
+            geohash_int_to_str(neighbour, precision, str);
+            items[i] = mp_obj_new_str(str, precision);
+        } else {
+            items[i] = mp_obj_new_int_from_ull(neighbour);
+        }
+    }
+
+    return mp_obj_new_list(8, items);
+}
+
+// geohash_batch(lats, lons, out[, precision])
+// out: array('q') / array('Q') - целые geohash, bytearray - precision символов на точку
+static mp_obj_t geohash_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t lats_buf, lons_buf, out_buf;
+    get_float_buffer(args[0], &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lons_buf, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[2], &out_buf, MP_BUFFER_WRITE);
+    uint8_t precision = (n_args > 3) ? geohash_get_precision(args[3]) : GEOHASH_DEFAULT_PRECISION;
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+
+    if (out_buf.typecode == 'q' || out_buf.typecode == 'Q') {
+        if (buffer_item_count(&out_buf) < count) {
+            mp_raise_ValueError(MP_ERROR_TEXT("output buffer is too small"));
+        }
+        uint64_t* out = (uint64_t*)out_buf.buf;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = geohash_encode_int(buffer_load_double(&lats_buf, i),
+                                        buffer_load_double(&lons_buf, i), precision);
+        }
+    } else if (out_buf.typecode == BYTEARRAY_TYPECODE || out_buf.typecode == 'B') {
+        // bytearray отдает BYTEARRAY_TYPECODE, array('B') - 'B'
+        if (out_buf.len < count * precision) {
+            mp_raise_ValueError(MP_ERROR_TEXT("output buffer is too small"));
+        }
+        char* out = (char*)out_buf.buf;
+        char str[GEOHASH_MAX_PRECISION + 1];
+        for (size_t i = 0; i < count; i++) {
+            uint64_t hash = geohash_encode_int(buffer_load_double(&lats_buf, i),
+                                               buffer_load_double(&lons_buf, i), precision);
+            geohash_int_to_str(hash, precision, str);
+            memcpy(out + i * precision, str, precision);
+        }
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("output must be array('q'), array('Q') or bytearray"));
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// Номер тайла slippy-map (веб-меркатор) для точки на уровне zoom
+static void tile_from_coordinate(double lat, double lon, uint8_t zoom, uint32_t* x, uint32_t* y) {
+    // Веб-меркатор определен до +-85.0511 градусов
+    if (lat > 85.05112878) lat = 85.05112878;
+    if (lat < -85.05112878) lat = -85.05112878;
+
+    double n = (double)(1UL << zoom);
+    double lat_rad = lat * DEG_TO_RAD;
+    double tx = (lon + 180.0) / 360.0 * n;
+    double ty = (1.0 - log(tan(lat_rad) + 1.0 / cos(lat_rad)) / M_PI) / 2.0 * n;
+
+    if (tx < 0.0) tx = 0.0;
+    if (ty < 0.0) ty = 0.0;
+    if (tx > n - 1.0) tx = n - 1.0;
+    if (ty > n - 1.0) ty = n - 1.0;
+
+    *x = (uint32_t)tx;
+    *y = (uint32_t)ty;
+}
+
+// Получение zoom из аргумента с проверкой диапазона
+static uint8_t tile_get_zoom(mp_obj_t obj) {
+    mp_int_t zoom = mp_obj_get_int(obj);
+    if (zoom < 0 || zoom > 30) {
+        mp_raise_ValueError(MP_ERROR_TEXT("zoom must be between 0 and 30"));
+    }
+    return (uint8_t)zoom;
+}
+
+// tile_xy(zoom[, lat, lon]) - без координат используется текущая позиция
+static mp_obj_t tile_xy(size_t n_args, const mp_obj_t *args) {
+    uint8_t zoom = tile_get_zoom(args[0]);
+    double lat, lon;
+
+    if (n_args == 2) {
+        mp_raise_TypeError(MP_ERROR_TEXT("tile_xy() takes zoom or zoom, lat, lon"));
+    }
+
+    if (n_args == 1) {
+        if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+            return mp_const_none;
+        }
+        lat = current_gps_data.latitude;
+        lon = current_gps_data.longitude;
+    } else {
+        lat = mp_obj_get_float(args[1]);
+        lon = mp_obj_get_float(args[2]);
+    }
+
+    uint32_t x, y;
+    tile_from_coordinate(lat, lon, zoom, &x, &y);
+
+    mp_obj_t items[2];
+    items[0] = mp_obj_new_int_from_uint(x);
+    items[1] = mp_obj_new_int_from_uint(y);
+    return mp_obj_new_tuple(2, items);
+}
+
+// tile_xy_batch(zoom, lats, lons, xs, ys) - xs/ys: array('I') / array('i')
+static mp_obj_t tile_xy_batch(size_t n_args, const mp_obj_t *args) {
+    uint8_t zoom = tile_get_zoom(args[0]);
+    mp_buffer_info_t lats_buf, lons_buf, xs_buf, ys_buf;
+    get_float_buffer(args[1], &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(args[2], &lons_buf, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[3], &xs_buf, MP_BUFFER_WRITE);
+    mp_get_buffer_raise(args[4], &ys_buf, MP_BUFFER_WRITE);
+
+    if (!buffer_is_int32(&xs_buf) || !buffer_is_int32(&ys_buf)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("xs and ys must be 32-bit integer arrays"));
+    }
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) < count ||
+        buffer_item_count(&xs_buf) < count || buffer_item_count(&ys_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffers must have the same length"));
+    }
+
+    uint32_t* xs = (uint32_t*)xs_buf.buf;
+    uint32_t* ys = (uint32_t*)ys_buf.buf;
+    for (size_t i = 0; i < count; i++) {
+        tile_from_coordinate(buffer_load_double(&lats_buf, i), buffer_load_double(&lons_buf, i),
+                             zoom, &xs[i], &ys[i]);
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// Минимальный прирост bytearray при дозаписи (байт)
+#define BYTEARRAY_GROW_MIN 64
+
+// Дозапись байт в конец bytearray с амортизированным ростом буфера
+static void bytearray_append(mp_obj_t array_obj, const uint8_t* data, size_t len) {
+    mp_obj_array_t* array = MP_OBJ_TO_PTR(array_obj);
+
+    if (array->free < len) {
+        size_t grow = len + array->len / 2;
+        if (grow < BYTEARRAY_GROW_MIN) grow = BYTEARRAY_GROW_MIN;
+        array->items = m_renew(uint8_t, array->items, array->len + array->free, array->len + grow);
+        array->free = grow;
+    }
+
+    memcpy((uint8_t*)array->items + array->len, data, len);
+    array->len += len;
+    array->free -= len;
+}
+
+// Потоковый кодировщик encoded polyline (формат Google)
+typedef struct _polyline_encoder_obj_t {
+    mp_obj_base_t base;
+    mp_obj_t out;           // целевой bytearray
+    double factor;          // 10^precision
+    int64_t last_lat;       // предыдущая точка для дельт
+    int64_t last_lon;
+    size_t points;
+} polyline_encoder_obj_t;
+
+// Кодирование одного значения со знаком; возвращает количество байт
+static size_t polyline_encode_value(int64_t value, uint8_t* out) {
+    uint64_t v = (uint64_t)value << 1;
+    if (value < 0) v = ~v;
+
+    size_t len = 0;
+    while (v >= 0x20) {
+        out[len++] = (uint8_t)((0x20 | (v & 0x1F)) + 63);
+        v >>= 5;
+    }
+    out[len++] = (uint8_t)(v + 63);
+    return len;
+}
+
+// Добавление точки в поток
+// Точки без координат (NAN в колонках parse_file() без фикса) и вне диапазона пропускаются:
+// llround() для них не определен и испортил бы все следующие дельты; возвращает 0
+static size_t polyline_encoder_add_point(polyline_encoder_obj_t* encoder, double lat, double lon) {
+    if (!(fabs(lat) <= 90.0 && fabs(lon) <= 180.0)) {
+        return 0;
+    }
+    int64_t lat_q = (int64_t)llround(lat * encoder->factor);
+    int64_t lon_q = (int64_t)llround(lon * encoder->factor);
+
+    // Максимум 2 * 13 байт на точку для 64-битных дельт
+    uint8_t chunk[26];
+    size_t len = polyline_encode_value(lat_q - encoder->last_lat, chunk);
+    len += polyline_encode_value(lon_q - encoder->last_lon, chunk + len);
+
+    bytearray_append(encoder->out, chunk, len);
+    encoder->last_lat = lat_q;
+    encoder->last_lon = lon_q;
+    encoder->points++;
+    return len;
+}
+
+// Получение precision для polyline с проверкой диапазона
+static double polyline_get_factor(mp_obj_t obj) {
+    mp_int_t precision = mp_obj_get_int(obj);
+    if (precision < 1 || precision > 7) {
+        mp_raise_ValueError(MP_ERROR_TEXT("precision must be between 1 and 7"));
+    }
+    return pow(10.0, (double)precision);
+}
+
+// PolylineEncoder(out[, precision=5]) - out должен быть bytearray
+static mp_obj_t polyline_encoder_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+
+    if (!mp_obj_is_type(args[0], &mp_type_bytearray)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("out must be bytearray"));
+    }
+
+    polyline_encoder_obj_t* encoder = mp_obj_malloc(polyline_encoder_obj_t, type);
+    encoder->out = args[0];
+    encoder->factor = (n_args > 1) ? polyline_get_factor(args[1]) : 1e5;
+    encoder->last_lat = 0;
+    encoder->last_lon = 0;
+    encoder->points = 0;
+    return MP_OBJ_FROM_PTR(encoder);
+}
+
+// encoder.add(lat, lon) - возвращает количество дописанных байт (0 - точка пропущена)
+static mp_obj_t polyline_encoder_add(mp_obj_t self_in, mp_obj_t lat_obj, mp_obj_t lon_obj) {
+    polyline_encoder_obj_t* encoder = MP_OBJ_TO_PTR(self_in);
+    size_t len = polyline_encoder_add_point(encoder, mp_obj_get_float(lat_obj), mp_obj_get_float(lon_obj));
+    return mp_obj_new_int(len);
+}
+
+// encoder.add_current() - добавляет текущую позицию (None если позиции нет)
+static mp_obj_t polyline_encoder_add_current(mp_obj_t self_in) {
+    polyline_encoder_obj_t* encoder = MP_OBJ_TO_PTR(self_in);
+
+    if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+        return mp_const_none;
+    }
+
+    size_t len = polyline_encoder_add_point(encoder, current_gps_data.latitude, current_gps_data.longitude);
+    return mp_obj_new_int(len);
+}
+
+// encoder.add_batch(lats, lons) - возвращает количество добавленных точек
+static mp_obj_t polyline_encoder_add_batch(mp_obj_t self_in, mp_obj_t lats_obj, mp_obj_t lons_obj) {
+    polyline_encoder_obj_t* encoder = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t lats_buf, lons_buf;
+    get_float_buffer(lats_obj, &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(lons_obj, &lons_buf, MP_BUFFER_READ);
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+
+    size_t added = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (polyline_encoder_add_point(encoder, buffer_load_double(&lats_buf, i), buffer_load_double(&lons_buf, i))) {
+            added++;
+        }
+    }
+
+    return mp_obj_new_int(added);
+}
+
+// Количество точек с момента создания или сброса
+static mp_obj_t polyline_encoder_points(mp_obj_t self_in) {
+    polyline_encoder_obj_t* encoder = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(encoder->points);
+}
+
+// encoder.reset([out]) - начало новой линии (дельты с нуля)
+static mp_obj_t polyline_encoder_reset(size_t n_args, const mp_obj_t *args) {
+    polyline_encoder_obj_t* encoder = MP_OBJ_TO_PTR(args[0]);
+
+    if (n_args > 1) {
+        if (!mp_obj_is_type(args[1], &mp_type_bytearray)) {
+            mp_raise_TypeError(MP_ERROR_TEXT("out must be bytearray"));
+        }
+        encoder->out = args[1];
+    }
+
+    encoder->last_lat = 0;
+    encoder->last_lon = 0;
+    encoder->points = 0;
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_3(polyline_encoder_add_obj, polyline_encoder_add);
+static MP_DEFINE_CONST_FUN_OBJ_1(polyline_encoder_add_current_obj, polyline_encoder_add_current);
+static MP_DEFINE_CONST_FUN_OBJ_3(polyline_encoder_add_batch_obj, polyline_encoder_add_batch);
+static MP_DEFINE_CONST_FUN_OBJ_1(polyline_encoder_points_obj, polyline_encoder_points);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(polyline_encoder_reset_obj, 1, 2, polyline_encoder_reset);
+
+static const mp_rom_map_elem_t polyline_encoder_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_add), MP_ROM_PTR(&polyline_encoder_add_obj) },
+    { MP_ROM_QSTR(MP_QSTR_add_current), MP_ROM_PTR(&polyline_encoder_add_current_obj) },
+    { MP_ROM_QSTR(MP_QSTR_add_batch), MP_ROM_PTR(&polyline_encoder_add_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_points), MP_ROM_PTR(&polyline_encoder_points_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&polyline_encoder_reset_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(polyline_encoder_locals_dict, polyline_encoder_locals_dict_table);
+
+// Тип PolylineEncoder
+MP_DEFINE_CONST_OBJ_TYPE(
+    polyline_encoder_type,
+    MP_QSTR_PolylineEncoder,
+    MP_TYPE_FLAG_NONE,
+    make_new, polyline_encoder_make_new,
+    locals_dict, &polyline_encoder_locals_dict
+    );
+
+// Декодирование одного значения; возвращает 0 при обрыве данных
+static int polyline_decode_value(const uint8_t* data, size_t len, size_t* pos, int64_t* value) {
+    uint64_t result = 0;
+    uint8_t shift = 0;
+
+    while (*pos < len && shift < 64) {
+        uint8_t b = data[(*pos)++] - 63;
+        result |= (uint64_t)(b & 0x1F) << shift;
+        shift += 5;
+        if (b < 0x20) {
+            *value = (result & 1) ? ~(int64_t)(result >> 1) : (int64_t)(result >> 1);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// polyline_count(data) - количество точек без декодирования
+static mp_obj_t polyline_count(mp_obj_t data_obj) {
+    mp_buffer_info_t data_buf;
+    mp_get_buffer_raise(data_obj, &data_buf, MP_BUFFER_READ);
+
+    const uint8_t* data = data_buf.buf;
+    size_t values = 0;
+    for (size_t i = 0; i < data_buf.len; i++) {
+        if ((uint8_t)(data[i] - 63) < 0x20) values++;
+    }
+
+    return mp_obj_new_int(values / 2);
+}
+
+// polyline_decode(data, lats_out, lons_out[, precision=5]) - возвращает количество точек
+static mp_obj_t polyline_decode(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t data_buf, lats_buf, lons_buf;
+    mp_get_buffer_raise(args[0], &data_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lats_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[2], &lons_buf, MP_BUFFER_WRITE);
+    double factor = (n_args > 3) ? polyline_get_factor(args[3]) : 1e5;
+
+    size_t capacity = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) < capacity) {
+        capacity = buffer_item_count(&lons_buf);
+    }
+
+    const uint8_t* data = data_buf.buf;
+    size_t pos = 0;
+    size_t count = 0;
+    int64_t lat = 0, lon = 0;
+
+    while (pos < data_buf.len) {
+        int64_t dlat, dlon;
+        if (!polyline_decode_value(data, data_buf.len, &pos, &dlat) ||
+            !polyline_decode_value(data, data_buf.len, &pos, &dlon)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("truncated polyline"));
+        }
+        if (count >= capacity) {
+            mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+        }
+
+        lat += dlat;
+        lon += dlon;
+        buffer_store_double(&lats_buf, count, (double)lat / factor);
+        buffer_store_double(&lons_buf, count, (double)lon / factor);
+        count++;
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// Параметры эллипсоида WGS84
+#define WGS84_A 6378137.0
+#define WGS84_F (1.0 / 298.257223563)
+#define WGS84_B (WGS84_A * (1.0 - WGS84_F))
+#define WGS84_E2 (WGS84_F * (2.0 - WGS84_F))
+#define WGS84_EP2 (WGS84_E2 / (1.0 - WGS84_E2))
+
+// Параметры проекции UTM
+#define UTM_K0 0.9996
+#define UTM_FALSE_EASTING 500000.0
+#define UTM_FALSE_NORTHING_SOUTH 10000000.0
+
+// Начало локальной системы ENU (ECEF и тригонометрия кэшируются при установке)
+typedef struct {
+    double latitude;
+    double longitude;
+    double altitude;
+    double x, y, z;
+    double sin_lat, cos_lat;
+    double sin_lon, cos_lon;
+    double n;               // радиус кривизны первого вертикала
+    uint8_t set;
+} enu_origin_t;
+
+static enu_origin_t enu_origin;
+
+// Эллипсоидальная высота текущего фикса (высота над геоидом + разделение геоида)
+static double current_ellipsoid_height(void) {
+    if (isnan(current_gps_data.altitude)) return 0.0;
+    if (isnan(current_gps_data.geoid_separation)) return current_gps_data.altitude;
+    return current_gps_data.altitude + current_gps_data.geoid_separation;
+}
+
+// Геодезические координаты -> ECEF (float64)
+static void geodetic_to_ecef(double lat, double lon, double h, double* x, double* y, double* z) {
+    double sin_lat = sin(lat * DEG_TO_RAD), cos_lat = cos(lat * DEG_TO_RAD);
+    double sin_lon = sin(lon * DEG_TO_RAD), cos_lon = cos(lon * DEG_TO_RAD);
+    double n = WGS84_A / sqrt(1.0 - WGS84_E2 * sin_lat * sin_lat);
+
+    *x = (n + h) * cos_lat * cos_lon;
+    *y = (n + h) * cos_lat * sin_lon;
+    *z = (n * (1.0 - WGS84_E2) + h) * sin_lat;
+}
+
+// Геодезические координаты -> ECEF (float32, погрешность до ~0.5 м из-за величины координат)
+static void geodetic_to_ecef_f(float lat, float lon, float h, float* x, float* y, float* z) {
+    float sin_lat = sinf(lat * (float)DEG_TO_RAD), cos_lat = cosf(lat * (float)DEG_TO_RAD);
+    float sin_lon = sinf(lon * (float)DEG_TO_RAD), cos_lon = cosf(lon * (float)DEG_TO_RAD);
+    float n = (float)WGS84_A / sqrtf(1.0f - (float)WGS84_E2 * sin_lat * sin_lat);
+
+    *x = (n + h) * cos_lat * cos_lon;
+    *y = (n + h) * cos_lat * sin_lon;
+    *z = (n * (1.0f - (float)WGS84_E2) + h) * sin_lat;
+}
+
+// ECEF -> геодезические координаты (замкнутая формула Хейккинена, без итераций)
+static void ecef_to_geodetic(double x, double y, double z, double* lat, double* lon, double* h) {
+    const double a2 = WGS84_A * WGS84_A;
+    const double b2 = WGS84_B * WGS84_B;
+    double p2 = x * x + y * y;
+    double p = sqrt(p2);
+    double z2 = z * z;
+
+    *lon = atan2(y, x) / DEG_TO_RAD;
+
+    // Вырожденный случай: точка на оси вращения
+    if (p < 1e-9) {
+        *lat = (z >= 0.0) ? 90.0 : -90.0;
+        *h = fabs(z) - WGS84_B;
+        return;
+    }
+
+    double f = 54.0 * b2 * z2;
+    double g = p2 + (1.0 - WGS84_E2) * z2 - WGS84_E2 * (a2 - b2);
+    double c = WGS84_E2 * WGS84_E2 * f * p2 / (g * g * g);
+    double s = cbrt(1.0 + c + sqrt(c * c + 2.0 * c));
+    double k = s + 1.0 + 1.0 / s;
+    double pp = f / (3.0 * k * k * g * g);
+    double q = sqrt(1.0 + 2.0 * WGS84_E2 * WGS84_E2 * pp);
+    double r0 = -(pp * WGS84_E2 * p) / (1.0 + q) +
+                sqrt(a2 / 2.0 * (1.0 + 1.0 / q) - pp * (1.0 - WGS84_E2) * z2 / (q * (1.0 + q)) - pp * p2 / 2.0);
+    double t = p - WGS84_E2 * r0;
+    double u = sqrt(t * t + z2);
+    double v = sqrt(t * t + (1.0 - WGS84_E2) * z2);
+    double z0 = b2 * z / (WGS84_A * v);
+
+    *h = u * (1.0 - b2 / (WGS84_A * v));
+    *lat = atan((z + WGS84_EP2 * z0) / p) / DEG_TO_RAD;
+}
+
+// Установка начала ENU
+static void enu_origin_set(double lat, double lon, double h) {
+    enu_origin.latitude = lat;
+    enu_origin.longitude = lon;
+    enu_origin.altitude = h;
+    enu_origin.sin_lat = sin(lat * DEG_TO_RAD);
+    enu_origin.cos_lat = cos(lat * DEG_TO_RAD);
+    enu_origin.sin_lon = sin(lon * DEG_TO_RAD);
+    enu_origin.cos_lon = cos(lon * DEG_TO_RAD);
+    enu_origin.n = WGS84_A / sqrt(1.0 - WGS84_E2 * enu_origin.sin_lat * enu_origin.sin_lat);
+    geodetic_to_ecef(lat, lon, h, &enu_origin.x, &enu_origin.y, &enu_origin.z);
+    enu_origin.set = 1;
+}
+
+// Поворот разности ECEF в оси ENU
+static void enu_rotate(double dx, double dy, double dz, double* e, double* n, double* u) {
+    *e = -enu_origin.sin_lon * dx + enu_origin.cos_lon * dy;
+    *n = -enu_origin.sin_lat * enu_origin.cos_lon * dx - enu_origin.sin_lat * enu_origin.sin_lon * dy +
+         enu_origin.cos_lat * dz;
+    *u = enu_origin.cos_lat * enu_origin.cos_lon * dx + enu_origin.cos_lat * enu_origin.sin_lon * dy +
+         enu_origin.sin_lat * dz;
+}
+
+// Геодезические координаты -> ENU относительно начала (float64)
+static void geodetic_to_enu(double lat, double lon, double h, double* e, double* n, double* u) {
+    double x, y, z;
+    geodetic_to_ecef(lat, lon, h, &x, &y, &z);
+    enu_rotate(x - enu_origin.x, y - enu_origin.y, z - enu_origin.z, e, n, u);
+}
+
+// Геодезические координаты -> ENU (float32)
+// Вместо разности больших абсолютных ECEF считаются приращения малых величин
+// относительно начала, поэтому погрешность ~1e-7 от дальности, а не ~0.5 м
+static void geodetic_to_enu_f(double lat, double lon, double h, float* e, float* n, float* u) {
+    float dlat = (float)((lat - enu_origin.latitude) * DEG_TO_RAD);
+    double dlon_deg = lon - enu_origin.longitude;
+    if (dlon_deg > 180.0) dlon_deg -= 360.0;
+    if (dlon_deg < -180.0) dlon_deg += 360.0;
+    float dlon = (float)(dlon_deg * DEG_TO_RAD);
+    float dh = (float)(h - enu_origin.altitude);
+
+    float sin_lat0 = (float)enu_origin.sin_lat, cos_lat0 = (float)enu_origin.cos_lat;
+    float sin_lon0 = (float)enu_origin.sin_lon, cos_lon0 = (float)enu_origin.cos_lon;
+
+    // Приращения синусов и косинусов: cos(a + d) - cos(a) = -cos(a) * 2sin^2(d/2) - sin(a) * sin(d)
+    float half_lat = sinf(dlat * 0.5f), half_lon = sinf(dlon * 0.5f);
+    float sin_dlat = sinf(dlat), sin_dlon = sinf(dlon);
+    float d_cos_lat = -cos_lat0 * 2.0f * half_lat * half_lat - sin_lat0 * sin_dlat;
+    float d_sin_lat = -sin_lat0 * 2.0f * half_lat * half_lat + cos_lat0 * sin_dlat;
+    float d_cos_lon = -cos_lon0 * 2.0f * half_lon * half_lon - sin_lon0 * sin_dlon;
+    float d_sin_lon = -sin_lon0 * 2.0f * half_lon * half_lon + cos_lon0 * sin_dlon;
+    float sin_lat = sin_lat0 + d_sin_lat;
+    float cos_lon = cos_lon0 + d_cos_lon;
+
+    // Приращение радиуса кривизны: N - N0 = a * (w0 - w) / (sqrt(w) * sqrt(w0) * (sqrt(w) + sqrt(w0)))
+    float w0 = 1.0f - (float)WGS84_E2 * sin_lat0 * sin_lat0;
+    float w = 1.0f - (float)WGS84_E2 * sin_lat * sin_lat;
+    float dw = (float)WGS84_E2 * d_sin_lat * (2.0f * sin_lat0 + d_sin_lat);
+    float sw = sqrtf(w), sw0 = sqrtf(w0);
+    float dn = (float)WGS84_A * dw / (sw * sw0 * (sw + sw0));
+
+    float r = (float)(enu_origin.n + enu_origin.altitude) + dn + dh;
+    float r0z = (float)(enu_origin.n * (1.0 - WGS84_E2) + enu_origin.altitude);
+    float dr = dn + dh;
+    float drz = dn * (1.0f - (float)WGS84_E2) + dh;
+
+    // Разности ECEF через малые приращения
+    float d_cc = d_cos_lat * cos_lon + cos_lat0 * d_cos_lon;
+    float d_cs = d_cos_lat * (sin_lon0 + d_sin_lon) + cos_lat0 * d_sin_lon;
+    float dx = r * d_cc + dr * cos_lat0 * cos_lon0;
+    float dy = r * d_cs + dr * cos_lat0 * sin_lon0;
+    float dz = (r0z + drz) * d_sin_lat + drz * sin_lat0;
+
+    *e = -sin_lon0 * dx + cos_lon0 * dy;
+    *n = -sin_lat0 * cos_lon0 * dx - sin_lat0 * sin_lon0 * dy + cos_lat0 * dz;
+    *u = cos_lat0 * cos_lon0 * dx + cos_lat0 * sin_lon0 * dy + sin_lat0 * dz;
+}
+
+// Номер зоны UTM с учетом исключений для Норвегии и Шпицбергена
+static uint8_t utm_zone_for(double lat, double lon) {
+    if (lon >= 180.0) lon -= 360.0;
+    int zone = (int)floor((lon + 180.0) / 6.0) + 1;
+
+    if (lat >= 56.0 && lat < 64.0 && lon >= 3.0 && lon < 12.0) {
+        zone = 32;
+    }
+    if (lat >= 72.0 && lat < 84.0) {
+        if (lon >= 0.0 && lon < 9.0) zone = 31;
+        else if (lon >= 9.0 && lon < 21.0) zone = 33;
+        else if (lon >= 21.0 && lon < 33.0) zone = 35;
+        else if (lon >= 33.0 && lon < 42.0) zone = 37;
+    }
+
+    return (uint8_t)zone;
+}
+
+// Коэффициенты рядов Крюгера (3-й порядок по n, погрешность < 1 мм в пределах зоны)
+typedef struct {
+    double a;               // радиус спрямляющей сферы
+    double alpha[3];
+    double beta[3];
+    double delta[3];
+} utm_series_t;
+
+static utm_series_t utm_series;
+static uint8_t utm_series_ready = 0;
+
+static const utm_series_t* utm_get_series(void) {
+    if (!utm_series_ready) {
+        double n = WGS84_F / (2.0 - WGS84_F);
+        double n2 = n * n, n3 = n2 * n;
+        utm_series.a = WGS84_A / (1.0 + n) * (1.0 + n2 / 4.0 + n2 * n2 / 64.0);
+        utm_series.alpha[0] = n / 2.0 - 2.0 * n2 / 3.0 + 5.0 * n3 / 16.0;
+        utm_series.alpha[1] = 13.0 * n2 / 48.0 - 3.0 * n3 / 5.0;
+        utm_series.alpha[2] = 61.0 * n3 / 240.0;
+        utm_series.beta[0] = n / 2.0 - 2.0 * n2 / 3.0 + 37.0 * n3 / 96.0;
+        utm_series.beta[1] = n2 / 48.0 + n3 / 15.0;
+        utm_series.beta[2] = 17.0 * n3 / 480.0;
+        utm_series.delta[0] = 2.0 * n - 2.0 * n2 / 3.0 - 2.0 * n3;
+        utm_series.delta[1] = 7.0 * n2 / 3.0 - 8.0 * n3 / 5.0;
+        utm_series.delta[2] = 56.0 * n3 / 15.0;
+        utm_series_ready = 1;
+    }
+    return &utm_series;
+}
+
+// Геодезические координаты -> UTM в заданной зоне
+static void geodetic_to_utm(double lat, double lon, uint8_t zone, double* easting, double* northing) {
+    const utm_series_t* s = utm_get_series();
+    double n = WGS84_F / (2.0 - WGS84_F);
+    double k = 2.0 * sqrt(n) / (1.0 + n);
+
+    double lon0 = (zone - 1) * 6.0 - 180.0 + 3.0;
+    double dlon = lon - lon0;
+    if (dlon > 180.0) dlon -= 360.0;
+    if (dlon < -180.0) dlon += 360.0;
+    dlon *= DEG_TO_RAD;
+
+    double sin_lat = sin(lat * DEG_TO_RAD);
+    double t = sinh(atanh(sin_lat) - k * atanh(k * sin_lat));
+    double xi = atan2(t, cos(dlon));
+    double eta = atanh(sin(dlon) / sqrt(1.0 + t * t));
+
+    double e = eta, nn = xi;
+    for (int j = 1; j <= 3; j++) {
+        e += s->alpha[j - 1] * cos(2.0 * j * xi) * sinh(2.0 * j * eta);
+        nn += s->alpha[j - 1] * sin(2.0 * j * xi) * cosh(2.0 * j * eta);
+    }
+
+    *easting = UTM_FALSE_EASTING + UTM_K0 * s->a * e;
+    *northing = UTM_K0 * s->a * nn + ((lat < 0.0) ? UTM_FALSE_NORTHING_SOUTH : 0.0);
+}
+
+// UTM -> геодезические координаты
+static void utm_to_geodetic(double easting, double northing, uint8_t zone, int north, double* lat, double* lon) {
+    const utm_series_t* s = utm_get_series();
+
+    double xi = (northing - (north ? 0.0 : UTM_FALSE_NORTHING_SOUTH)) / (UTM_K0 * s->a);
+    double eta = (easting - UTM_FALSE_EASTING) / (UTM_K0 * s->a);
+
+    double xi1 = xi, eta1 = eta;
+    for (int j = 1; j <= 3; j++) {
+        xi1 -= s->beta[j - 1] * sin(2.0 * j * xi) * cosh(2.0 * j * eta);
+        eta1 -= s->beta[j - 1] * cos(2.0 * j * xi) * sinh(2.0 * j * eta);
+    }
+
+    double chi = asin(sin(xi1) / cosh(eta1));
+    double phi = chi;
+    for (int j = 1; j <= 3; j++) {
+        phi += s->delta[j - 1] * sin(2.0 * j * chi);
+    }
+
+    double lon0 = (zone - 1) * 6.0 - 180.0 + 3.0;
+    *lat = phi / DEG_TO_RAD;
+    *lon = lon0 + atan2(sinh(eta1), cos(xi1)) / DEG_TO_RAD;
+}
+
+// Разбор точки (lat, lon[, alt]) из аргументов; без аргументов - текущий фикс
+// Возвращает 0, если текущей позиции нет
+static int get_point_args(size_t n_args, const mp_obj_t *args, double* lat, double* lon, double* h) {
+    if (n_args == 0) {
+        if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+            return 0;
+        }
+        *lat = current_gps_data.latitude;
+        *lon = current_gps_data.longitude;
+        *h = current_ellipsoid_height();
+        return 1;
+    }
+
+    if (n_args == 1) {
+        mp_raise_TypeError(MP_ERROR_TEXT("expected lat, lon[, alt]"));
+    }
+
+    *lat = mp_obj_get_float(args[0]);
+    *lon = mp_obj_get_float(args[1]);
+    *h = (n_args > 2) ? mp_obj_get_float(args[2]) : 0.0;
+    return 1;
+}
+
+// Кортеж из трех чисел
+static mp_obj_t new_float_triple(double a, double b, double c) {
+    mp_obj_t items[3];
+    items[0] = mp_obj_new_float(a);
+    items[1] = mp_obj_new_float(b);
+    items[2] = mp_obj_new_float(c);
+    return mp_obj_new_tuple(3, items);
+}
+
+// to_ecef([lat, lon[, alt]]) -> (x, y, z)
+static mp_obj_t to_ecef(size_t n_args, const mp_obj_t *args) {
+    double lat, lon, h, x, y, z;
+    if (!get_point_args(n_args, args, &lat, &lon, &h)) {
+        return mp_const_none;
+    }
+    geodetic_to_ecef(lat, lon, h, &x, &y, &z);
+    return new_float_triple(x, y, z);
+}
+
+// from_ecef(x, y, z) -> (lat, lon, alt)
+static mp_obj_t from_ecef(mp_obj_t x_obj, mp_obj_t y_obj, mp_obj_t z_obj) {
+    double lat, lon, h;
+    ecef_to_geodetic(mp_obj_get_float(x_obj), mp_obj_get_float(y_obj), mp_obj_get_float(z_obj), &lat, &lon, &h);
+    return new_float_triple(lat, lon, h);
+}
+
+// set_enu_origin([lat, lon[, alt]]) - без аргументов используется текущий фикс
+static mp_obj_t set_enu_origin(size_t n_args, const mp_obj_t *args) {
+    double lat, lon, h;
+    if (!get_point_args(n_args, args, &lat, &lon, &h)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("no current position"));
+    }
+    enu_origin_set(lat, lon, h);
+    return mp_const_none;
+}
+
+// Проверка, что начало ENU установлено
+static void enu_check_origin(void) {
+    if (!enu_origin.set) {
+        mp_raise_ValueError(MP_ERROR_TEXT("ENU origin is not set"));
+    }
+}
+
+// to_enu([lat, lon[, alt]]) -> (east, north, up)
+static mp_obj_t to_enu(size_t n_args, const mp_obj_t *args) {
+    enu_check_origin();
+    double lat, lon, h, e, n, u;
+    if (!get_point_args(n_args, args, &lat, &lon, &h)) {
+        return mp_const_none;
+    }
+    geodetic_to_enu(lat, lon, h, &e, &n, &u);
+    return new_float_triple(e, n, u);
+}
+
+// Получение номера зоны UTM из аргумента
+static uint8_t utm_get_zone(mp_obj_t obj) {
+    mp_int_t zone = mp_obj_get_int(obj);
+    if (zone < 1 || zone > 60) {
+        mp_raise_ValueError(MP_ERROR_TEXT("zone must be between 1 and 60"));
+    }
+    return (uint8_t)zone;
+}
+
+// to_utm([lat, lon[, zone]]) -> (easting, northing, zone, north)
+static mp_obj_t to_utm(size_t n_args, const mp_obj_t *args) {
+    double lat, lon, h;
+    if (!get_point_args(n_args > 2 ? 2 : n_args, args, &lat, &lon, &h)) {
+        return mp_const_none;
+    }
+    if (lat < -80.0 || lat > 84.0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("latitude outside UTM range"));
+    }
+
+    uint8_t zone = (n_args > 2) ? utm_get_zone(args[2]) : utm_zone_for(lat, lon);
+    double easting, northing;
+    geodetic_to_utm(lat, lon, zone, &easting, &northing);
+
+    mp_obj_t items[4];
+    items[0] = mp_obj_new_float(easting);
+    items[1] = mp_obj_new_float(northing);
+    items[2] = mp_obj_new_int(zone);
+    items[3] = mp_obj_new_bool(lat >= 0.0);
+    return mp_obj_new_tuple(4, items);
+}
+
+// from_utm(easting, northing, zone, north) -> (lat, lon)
+static mp_obj_t from_utm(size_t n_args, const mp_obj_t *args) {
+    double lat, lon;
+    utm_to_geodetic(mp_obj_get_float(args[0]), mp_obj_get_float(args[1]),
+                    utm_get_zone(args[2]), mp_obj_is_true(args[3]), &lat, &lon);
+
+    mp_obj_t items[2];
+    items[0] = mp_obj_new_float(lat);
+    items[1] = mp_obj_new_float(lon);
+    return mp_obj_new_tuple(2, items);
+}
+
+// Буферы пакетного преобразования: три входа (alts может быть None) и три выхода одного типа
+static size_t get_triple_buffers(const mp_obj_t *args, mp_buffer_info_t* in, mp_buffer_info_t* out) {
+    get_float_buffer(args[0], &in[0], MP_BUFFER_READ);
+    get_float_buffer(args[1], &in[1], MP_BUFFER_READ);
+    if (args[2] == mp_const_none) {
+        in[2].buf = NULL;
+        in[2].len = 0;
+        in[2].typecode = 'd';
+    } else {
+        get_float_buffer(args[2], &in[2], MP_BUFFER_READ);
+    }
+    for (int i = 0; i < 3; i++) {
+        get_float_buffer(args[3 + i], &out[i], MP_BUFFER_WRITE);
+    }
+
+    if (out[0].typecode != out[1].typecode || out[0].typecode != out[2].typecode) {
+        mp_raise_TypeError(MP_ERROR_TEXT("output arrays must have the same type"));
+    }
+
+    size_t count = buffer_item_count(&in[0]);
+    if (buffer_item_count(&in[1]) != count || (in[2].buf && buffer_item_count(&in[2]) != count)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("input arrays must have the same length"));
+    }
+    for (int i = 0; i < 3; i++) {
+        if (buffer_item_count(&out[i]) < count) {
+            mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+        }
+    }
+    return count;
+}
+
+// to_ecef_batch(lats, lons, alts, xs, ys, zs) - выходы array('f') включают режим float32
+static mp_obj_t to_ecef_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t in[3], out[3];
+    size_t count = get_triple_buffers(args, in, out);
+
+    for (size_t i = 0; i < count; i++) {
+        double lat = buffer_load_double(&in[0], i);
+        double lon = buffer_load_double(&in[1], i);
+        double h = in[2].buf ? buffer_load_double(&in[2], i) : 0.0;
+
+        if (out[0].typecode == 'f') {
+            geodetic_to_ecef_f((float)lat, (float)lon, (float)h,
+                               &((float*)out[0].buf)[i], &((float*)out[1].buf)[i], &((float*)out[2].buf)[i]);
+        } else {
+            geodetic_to_ecef(lat, lon, h,
+                             &((double*)out[0].buf)[i], &((double*)out[1].buf)[i], &((double*)out[2].buf)[i]);
+        }
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// to_enu_batch(lats, lons, alts, es, ns, us) - выходы array('f') включают режим float32
+static mp_obj_t to_enu_batch(size_t n_args, const mp_obj_t *args) {
+    enu_check_origin();
+    mp_buffer_info_t in[3], out[3];
+    size_t count = get_triple_buffers(args, in, out);
+
+    for (size_t i = 0; i < count; i++) {
+        double lat = buffer_load_double(&in[0], i);
+        double lon = buffer_load_double(&in[1], i);
+        double h = in[2].buf ? buffer_load_double(&in[2], i) : 0.0;
+
+        if (out[0].typecode == 'f') {
+            geodetic_to_enu_f(lat, lon, h,
+                              &((float*)out[0].buf)[i], &((float*)out[1].buf)[i], &((float*)out[2].buf)[i]);
+        } else {
+            geodetic_to_enu(lat, lon, h,
+                            &((double*)out[0].buf)[i], &((double*)out[1].buf)[i], &((double*)out[2].buf)[i]);
+        }
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// to_utm_batch(lats, lons, eastings, northings[, zone]) -> зона
+// Все точки проецируются в одну зону (по умолчанию - зона первой точки)
+static mp_obj_t to_utm_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t lats_buf, lons_buf, east_buf, north_buf;
+    get_float_buffer(args[0], &lats_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &lons_buf, MP_BUFFER_READ);
+    get_float_buffer(args[2], &east_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[3], &north_buf, MP_BUFFER_WRITE);
+
+    size_t count = buffer_item_count(&lats_buf);
+    if (buffer_item_count(&lons_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("lats and lons must have the same length"));
+    }
+    if (buffer_item_count(&east_buf) < count || buffer_item_count(&north_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+    }
+    if (count == 0) {
+        return mp_const_none;
+    }
+
+    uint8_t zone = (n_args > 4) ? utm_get_zone(args[4])
+                                : utm_zone_for(buffer_load_double(&lats_buf, 0), buffer_load_double(&lons_buf, 0));
+
+    for (size_t i = 0; i < count; i++) {
+        double easting, northing;
+        geodetic_to_utm(buffer_load_double(&lats_buf, i), buffer_load_double(&lons_buf, i), zone, &easting, &northing);
+        buffer_store_double(&east_buf, i, easting);
+        buffer_store_double(&north_buf, i, northing);
+    }
+
+    return mp_obj_new_int(zone);
+}
+
+// from_utm_batch(eastings, northings, zone, north, lats, lons)
+static mp_obj_t from_utm_batch(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t east_buf, north_buf, lats_buf, lons_buf;
+    get_float_buffer(args[0], &east_buf, MP_BUFFER_READ);
+    get_float_buffer(args[1], &north_buf, MP_BUFFER_READ);
+    uint8_t zone = utm_get_zone(args[2]);
+    int north = mp_obj_is_true(args[3]);
+    get_float_buffer(args[4], &lats_buf, MP_BUFFER_WRITE);
+    get_float_buffer(args[5], &lons_buf, MP_BUFFER_WRITE);
+
+    size_t count = buffer_item_count(&east_buf);
+    if (buffer_item_count(&north_buf) != count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("eastings and northings must have the same length"));
+    }
+    if (buffer_item_count(&lats_buf) < count || buffer_item_count(&lons_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("output arrays are too small"));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        double lat, lon;
+        utm_to_geodetic(buffer_load_double(&east_buf, i), buffer_load_double(&north_buf, i), zone, north, &lat, &lon);
+        buffer_store_double(&lats_buf, i, lat);
+        buffer_store_double(&lons_buf, i, lon);
+    }
+
+    return mp_obj_new_int(count);
+}
+
+// Размер блока чтения файла при пакетном разборе
+#ifndef NMEA_LOG_CHUNK
+#define NMEA_LOG_CHUNK 512
+#endif
+
+// Новая колонка array(typecode) на capacity элементов
+static mp_obj_array_t* new_column(char typecode, size_t item_size, size_t capacity) {
+    if (capacity == 0) capacity = 1;
+    mp_obj_array_t* array = mp_obj_malloc(mp_obj_array_t, &mp_type_array);
+    array->typecode = typecode;
+    array->free = 0;
+    array->len = capacity;
+    array->items = m_new(uint8_t, capacity * item_size);
+    return array;
+}
+
+// Обрезка колонки до фактического числа элементов
+static void trim_column(mp_obj_array_t* array, size_t item_size, size_t count) {
+    size_t keep = (count > 0) ? count : 1;
+    array->items = m_renew(uint8_t, array->items, array->len * item_size, keep * item_size);
+    array->len = count;
+    array->free = keep - count;
+}
+
+// Поток чтения файла: открытие в режиме "rb"
+static mp_obj_t log_file_open(mp_obj_t path) {
+    return mp_call_function_2(MP_OBJ_FROM_PTR(&mp_builtin_open_obj), path, MP_OBJ_NEW_QSTR(MP_QSTR_rb));
+}
+
+// Чтение очередного блока файла (0 - конец файла)
+static size_t log_file_read(mp_obj_t file, char* buf, size_t len) {
+    int errcode;
+    mp_uint_t out = mp_stream_rw(file, buf, len, &errcode, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
+    if (out == MP_STREAM_ERROR) {
+        mp_stream_close(file);
+        mp_raise_OSError(errcode);
+    }
+    return out;
+}
+
+// Переход к позиции файла (метод seek потока); возвращает новую позицию
+static uint64_t log_file_seek(mp_obj_t file, uint64_t offset, int whence) {
+    mp_obj_t dest[4];
+    mp_load_method(file, MP_QSTR_seek, dest);
+    dest[2] = mp_obj_new_int_from_ull(offset);
+    dest[3] = MP_OBJ_NEW_SMALL_INT(whence);
+    return get_uint64(mp_call_method_n_kw(2, 0, dest));
+}
+
+// Запись буфера в файл целиком
+static void log_file_write(mp_obj_t file, const void* buf, size_t len) {
+    int errcode;
+    mp_uint_t out = mp_stream_rw(file, (void*)buf, len, &errcode, MP_STREAM_RW_WRITE);
+    if (out == MP_STREAM_ERROR || out != len) {
+        mp_stream_close(file);
+        mp_raise_OSError(out == MP_STREAM_ERROR ? errcode : MP_EIO);
+    }
+}
+
+// Подача участка [start, stop) файла блоками: в счетчик эпох или в разбор
+static void log_file_feed_range(mp_obj_t path, uint64_t start, uint64_t stop,
+                                nmea_log_prescan_t* prescan, nmea_log_parser_t* parser, nmea_columns_t* columns) {
+    char chunk[NMEA_LOG_CHUNK];
+    mp_obj_t file = log_file_open(path);
+    if (start > 0) log_file_seek(file, start, 0);
+
+    uint64_t remaining = stop - start;
+    while (remaining > 0) {
+        size_t want = (remaining < sizeof(chunk)) ? (size_t)remaining : sizeof(chunk);
+        size_t len = log_file_read(file, chunk, want);
+        if (len == 0) break;
+        if (prescan) {
+            nmea_log_prescan_feed(prescan, chunk, len);
+        } else {
+            nmea_log_parser_feed(parser, chunk, len, columns);
+        }
+        remaining -= len;
+    }
+    mp_stream_close(file);
+}
+
+// Разбор участка [start, stop) лога в колонки; строки вне [from_ms, to_ms] отбрасываются
+// Возвращает dict: time (array('q')), latitude, longitude, altitude, speed, hdop (array('d')),
+// satellites (array('B')); одна строка на эпоху
+static mp_obj_t parse_log(mp_obj_t source, uint64_t start, uint64_t stop, int64_t from_ms, int64_t to_ms) {
+    int is_path = mp_obj_is_str(source);
+    mp_buffer_info_t source_buf;
+    const char* data = NULL;
+    size_t data_len = 0;
+    if (!is_path) {
+        mp_get_buffer_raise(source, &source_buf, MP_BUFFER_READ);
+        if (stop > source_buf.len) stop = source_buf.len;
+        if (start > stop) start = stop;
+        data = (const char*)source_buf.buf + start;
+        data_len = (size_t)(stop - start);
+    }
+
+    // Проход 1: верхняя граница числа эпох
+    nmea_log_prescan_t prescan;
+    nmea_log_prescan_init(&prescan);
+    if (is_path) {
+        log_file_feed_range(source, start, stop, &prescan, NULL, NULL);
+    } else {
+        nmea_log_prescan_feed(&prescan, data, data_len);
+    }
+
+    // Колонки фиксированного типа
+    size_t capacity = prescan.count;
+    mp_obj_array_t* time_col = new_column('q', 8, capacity);
+    mp_obj_array_t* lat_col = new_column('d', 8, capacity);
+    mp_obj_array_t* lon_col = new_column('d', 8, capacity);
+    mp_obj_array_t* alt_col = new_column('d', 8, capacity);
+    mp_obj_array_t* speed_col = new_column('d', 8, capacity);
+    mp_obj_array_t* hdop_col = new_column('d', 8, capacity);
+    mp_obj_array_t* sats_col = new_column('B', 1, capacity);
+
+    nmea_columns_t columns = {
+        .time_ms = time_col->items,
+        .latitude = lat_col->items,
+        .longitude = lon_col->items,
+        .altitude = alt_col->items,
+        .speed = speed_col->items,
+        .hdop = hdop_col->items,
+        .satellites = sats_col->items,
+        .offset = NULL,
+        .capacity = capacity,
+        .count = 0,
+        .dropped = 0,
+    };
+
+    // Проход 2: разбор существующими обработчиками предложений
+    nmea_log_parser_t* parser = m_new(nmea_log_parser_t, 1);
+    nmea_log_parser_init(parser);
+    if (is_path) {
+        log_file_feed_range(source, start, stop, NULL, parser, &columns);
+    } else {
+        nmea_log_parser_feed(parser, data, data_len, &columns);
+    }
+    nmea_log_parser_finish(parser, &columns);
+    m_del(nmea_log_parser_t, parser, 1);
+
+    nmea_columns_filter_time(&columns, from_ms, to_ms);
+
+    trim_column(time_col, 8, columns.count);
+    trim_column(lat_col, 8, columns.count);
+    trim_column(lon_col, 8, columns.count);
+    trim_column(alt_col, 8, columns.count);
+    trim_column(speed_col, 8, columns.count);
+    trim_column(hdop_col, 8, columns.count);
+    trim_column(sats_col, 1, columns.count);
+
+    mp_obj_dict_t* dict = mp_obj_new_dict(7);
+    mp_obj_dict_store(dict, mp_obj_new_str("time", 4), MP_OBJ_FROM_PTR(time_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("latitude", 8), MP_OBJ_FROM_PTR(lat_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("longitude", 9), MP_OBJ_FROM_PTR(lon_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("altitude", 8), MP_OBJ_FROM_PTR(alt_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("speed", 5), MP_OBJ_FROM_PTR(speed_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("hdop", 4), MP_OBJ_FROM_PTR(hdop_col));
+    mp_obj_dict_store(dict, mp_obj_new_str("satellites", 10), MP_OBJ_FROM_PTR(sats_col));
+    return MP_OBJ_FROM_PTR(dict);
+}
+
+// parse_file(path_or_buffer) - разбор всего лога в колонки
+static mp_obj_t parse_file(mp_obj_t source) {
+    return parse_log(source, 0, UINT64_MAX, -1, INT64_MAX);
+}
+
+// Путь индекса: явный index_path или "<путь лога>.idx"
+static mp_obj_t index_path_for(mp_obj_t path, size_t n_args, const mp_obj_t* args, size_t index_arg) {
+    if (n_args > index_arg && args[index_arg] != mp_const_none) {
+        return args[index_arg];
+    }
+    size_t len;
+    const char* str = mp_obj_str_get_data(path, &len);
+    char* buf = m_new(char, len + 4);
+    memcpy(buf, str, len);
+    memcpy(buf + len, ".idx", 4);
+    mp_obj_t result = mp_obj_new_str(buf, len + 4);
+    m_del(char, buf, len + 4);
+    return result;
+}
+
+// build_index(path, every=60, index_path=None) - смещение и время UTC каждой every-й эпохи
+// в файл "<path>.idx"; возвращает число записей
+static mp_obj_t build_index(size_t n_args, const mp_obj_t* args) {
+    mp_obj_t path = args[0];
+    mp_int_t every = (n_args > 1) ? mp_obj_get_int(args[1]) : 60;
+    if (every <= 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("every must be > 0"));
+    }
+    mp_obj_t index_path = index_path_for(path, n_args, args, 2);
+
+    nmea_log_indexer_t* indexer = m_new(nmea_log_indexer_t, 1);
+    nmea_log_indexer_init(indexer, (uint32_t)every);
+
+    // Лог открывается первым: при ошибке пути старый индекс не обрезается
+    mp_obj_t file = log_file_open(path);
+
+    // Записи пишутся сразу; заголовок с их числом - в конце
+    uint8_t header[NMEA_LOG_INDEX_HEADER_SIZE];
+    uint8_t packed[NMEA_LOG_INDEX_ENTRY_SIZE];
+    memset(header, 0, sizeof(header));
+    mp_obj_t volatile out = MP_OBJ_NULL;  // volatile: читается после nlr_jump
+    uint64_t count = 0;
+
+    // Исключение посреди записи закрывает оба файла и пробрасывается дальше
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        out = mp_call_function_2(MP_OBJ_FROM_PTR(&mp_builtin_open_obj), index_path, MP_OBJ_NEW_QSTR(MP_QSTR_wb));
+        log_file_write(out, header, sizeof(header));
+
+        char chunk[NMEA_LOG_CHUNK < NMEA_LOG_INDEX_SLICE ? NMEA_LOG_CHUNK : NMEA_LOG_INDEX_SLICE];
+        for (;;) {
+            size_t len = log_file_read(file, chunk, sizeof(chunk));
+            size_t n = (len > 0) ? nmea_log_indexer_feed(indexer, chunk, len) : nmea_log_indexer_finish(indexer);
+            for (size_t i = 0; i < n; i++) {
+                nmea_log_index_pack_entry(packed, &indexer->entries[i]);
+                log_file_write(out, packed, sizeof(packed));
+            }
+            count += n;
+            if (len == 0) break;
+        }
+
+        nmea_log_index_pack_header(header, (uint32_t)every, indexer->parser.position, count);
+        log_file_seek(out, 0, 0);
+        log_file_write(out, header, sizeof(header));
+        nlr_pop();
+    } else {
+        mp_stream_close(file);
+        if (out != MP_OBJ_NULL) mp_stream_close(out);
+        m_del(nmea_log_indexer_t, indexer, 1);
+        nlr_jump(nlr.ret_val);
+    }
+    mp_stream_close(file);
+    mp_stream_close(out);
+    m_del(nmea_log_indexer_t, indexer, 1);
+
+    return mp_obj_new_int_from_ull(count);
+}
+
+// read_range(path, from_ms, to_ms, index_path=None) - колонки эпох с from_ms <= time <= to_ms;
+// по индексу читается и разбирается только нужный участок файла
+static mp_obj_t read_range(size_t n_args, const mp_obj_t* args) {
+    mp_obj_t path = args[0];
+    int64_t from_ms = (int64_t)get_uint64(args[1]);
+    int64_t to_ms = (int64_t)get_uint64(args[2]);
+    mp_obj_t index_path = index_path_for(path, n_args, args, 3);
+
+    // Индекс читается целиком (16 байт на запись)
+    uint8_t header[NMEA_LOG_INDEX_HEADER_SIZE];
+    uint32_t every;
+    uint64_t source_size;
+    uint64_t count;
+    mp_obj_t index_file = log_file_open(index_path);
+    if (log_file_read(index_file, (char*)header, sizeof(header)) != sizeof(header) ||
+        !nmea_log_index_unpack_header(header, &every, &source_size, &count)) {
+        mp_stream_close(index_file);
+        mp_raise_ValueError(MP_ERROR_TEXT("not an NMEA index file"));
+    }
+
+    // Число записей из заголовка - не больше, чем помещается в файле (иначе на 32-битных
+    // портах размер переполняется и выделяется меньше, чем читает nmea_log_index_range)
+    uint64_t index_size = log_file_seek(index_file, 0, 2);
+    log_file_seek(index_file, NMEA_LOG_INDEX_HEADER_SIZE, 0);
+    if (index_size < NMEA_LOG_INDEX_HEADER_SIZE ||
+        count > (index_size - NMEA_LOG_INDEX_HEADER_SIZE) / NMEA_LOG_INDEX_ENTRY_SIZE ||
+        count > SIZE_MAX / NMEA_LOG_INDEX_ENTRY_SIZE) {
+        mp_stream_close(index_file);
+        mp_raise_ValueError(MP_ERROR_TEXT("truncated NMEA index file"));
+    }
+
+    size_t entries_size = (size_t)count * NMEA_LOG_INDEX_ENTRY_SIZE;
+    uint8_t* entries = m_new(uint8_t, entries_size ? entries_size : 1);
+    size_t got = 0;
+    while (got < entries_size) {
+        size_t len = log_file_read(index_file, (char*)entries + got, entries_size - got);
+        if (len == 0) break;
+        got += len;
+    }
+    mp_stream_close(index_file);
+    if (got != entries_size) {
+        m_del(uint8_t, entries, entries_size ? entries_size : 1);
+        mp_raise_ValueError(MP_ERROR_TEXT("truncated NMEA index file"));
+    }
+
+    // Индекс от другой версии лога не годится
+    mp_obj_t file = log_file_open(path);
+    uint64_t size = log_file_seek(file, 0, 2);
+    mp_stream_close(file);
+    if (size != source_size) {
+        m_del(uint8_t, entries, entries_size ? entries_size : 1);
+        mp_raise_ValueError(MP_ERROR_TEXT("index does not match log file, rebuild it with build_index"));
+    }
+
+    uint64_t start;
+    uint64_t stop;
+    nmea_log_index_range(entries, (size_t)count, every, from_ms, to_ms, &start, &stop);
+    m_del(uint8_t, entries, entries_size ? entries_size : 1);
+    if (stop > size) stop = size;
+
+    return parse_log(path, start, stop, from_ms, to_ms);
+}
+
+// Начальная емкость общего буфера строк мультиплексора
+#ifndef NMEA_MUX_DEFAULT_ROWS
+#define NMEA_MUX_DEFAULT_ROWS 256
+#endif
+
+// Мультиплексор потоков от многих устройств (шлюз)
+typedef struct _multiplexer_obj_t {
+    mp_obj_base_t base;
+    nmea_mux_t mux;
+    nmea_columns_t rows;    // общий буфер завершенных эпох всех устройств
+    uint32_t* device_ids;   // устройство каждой строки
+} multiplexer_obj_t;
+
+// Место в буфере строк еще на extra строк
+static void multiplexer_reserve(multiplexer_obj_t* self, size_t extra) {
+    nmea_columns_t* rows = &self->rows;
+    if (rows->count + extra <= rows->capacity) return;
+
+    size_t old = rows->capacity;
+    size_t capacity = old * 2;
+    if (capacity < rows->count + extra) capacity = rows->count + extra;
+    rows->time_ms = m_renew(int64_t, rows->time_ms, old, capacity);
+    rows->latitude = m_renew(double, rows->latitude, old, capacity);
+    rows->longitude = m_renew(double, rows->longitude, old, capacity);
+    rows->altitude = m_renew(double, rows->altitude, old, capacity);
+    rows->speed = m_renew(double, rows->speed, old, capacity);
+    rows->hdop = m_renew(double, rows->hdop, old, capacity);
+    rows->satellites = m_renew(uint8_t, rows->satellites, old, capacity);
+    self->device_ids = m_renew(uint32_t, self->device_ids, old, capacity);
+    rows->capacity = capacity;
+}
+
+// Multiplexer(max_devices[, rows=256]) - состояния max_devices устройств в одной арене
+static mp_obj_t multiplexer_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+
+    mp_int_t max_devices = mp_obj_get_int(args[0]);
+    mp_int_t capacity = (n_args > 1) ? mp_obj_get_int(args[1]) : NMEA_MUX_DEFAULT_ROWS;
+    if (max_devices <= 0 || max_devices > INT32_MAX / 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("max_devices out of range"));
+    }
+    if (capacity <= 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("rows must be > 0"));
+    }
+
+    multiplexer_obj_t* self = mp_obj_malloc(multiplexer_obj_t, type);
+    nmea_mux_device_t* devices = m_new(nmea_mux_device_t, max_devices);
+    int32_t* table = m_new(int32_t, nmea_mux_table_size(max_devices));
+    nmea_mux_init(&self->mux, devices, table, max_devices);
+
+    nmea_columns_t* rows = &self->rows;
+    rows->time_ms = m_new(int64_t, capacity);
+    rows->latitude = m_new(double, capacity);
+    rows->longitude = m_new(double, capacity);
+    rows->altitude = m_new(double, capacity);
+    rows->speed = m_new(double, capacity);
+    rows->hdop = m_new(double, capacity);
+    rows->satellites = m_new(uint8_t, capacity);
+    rows->offset = NULL;
+    rows->capacity = capacity;
+    rows->count = 0;
+    rows->dropped = 0;
+    self->device_ids = m_new(uint32_t, capacity);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Подача данных одного устройства
+static void multiplexer_feed_device(multiplexer_obj_t* self, uint32_t device_id, const char* data, size_t len) {
+    multiplexer_reserve(self, NMEA_MUX_MAX_ROWS(len));
+    if (nmea_mux_feed(&self->mux, device_id, data, len, &self->rows, self->device_ids) < 0) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("too many devices"));
+    }
+}
+
+// feed(device_id, buf) - данные устройства; возвращает число накопленных строк
+static mp_obj_t multiplexer_feed(mp_obj_t self_in, mp_obj_t device_in, mp_obj_t data_in) {
+    multiplexer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t data_buf;
+    mp_get_buffer_raise(data_in, &data_buf, MP_BUFFER_READ);
+    multiplexer_feed_device(self, (uint32_t)mp_obj_get_int_truncated(device_in), data_buf.buf, data_buf.len);
+    return mp_obj_new_int(self->rows.count);
+}
+
+// feed_batch(device_ids, offsets, data) - пачка фрагментов в одном буфере: фрагмент i -
+// data[offsets[i]:offsets[i + 1]] устройства device_ids[i]; device_ids/offsets - array('I')
+static mp_obj_t multiplexer_feed_batch(size_t n_args, const mp_obj_t *args) {
+    multiplexer_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t ids_buf, offsets_buf, data_buf;
+    mp_get_buffer_raise(args[1], &ids_buf, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[2], &offsets_buf, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[3], &data_buf, MP_BUFFER_READ);
+
+    if (!buffer_is_int32(&ids_buf) || !buffer_is_int32(&offsets_buf)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("device_ids and offsets must be array('I')"));
+    }
+    size_t n = buffer_item_count(&ids_buf);
+    if (buffer_item_count(&offsets_buf) != n + 1) {
+        mp_raise_ValueError(MP_ERROR_TEXT("offsets must have len(device_ids) + 1 items"));
+    }
+
+    const uint32_t* ids = ids_buf.buf;
+    const uint32_t* offsets = offsets_buf.buf;
+    for (size_t i = 0; i < n; i++) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > data_buf.len) {
+            mp_raise_ValueError(MP_ERROR_TEXT("offsets out of range"));
+        }
+        multiplexer_feed_device(self, ids[i], (const char*)data_buf.buf + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    return mp_obj_new_int(self->rows.count);
+}
+
+// flush([device_id]) - закрытие последней эпохи устройства (или всех) и сброс его состояния
+static mp_obj_t multiplexer_flush(size_t n_args, const mp_obj_t *args) {
+    multiplexer_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    if (n_args > 1) {
+        nmea_mux_device_t* device = nmea_mux_find(&self->mux, (uint32_t)mp_obj_get_int_truncated(args[1]), 0);
+        if (device) {
+            multiplexer_reserve(self, 1);
+            nmea_mux_flush(device, &self->rows, self->device_ids);
+        }
+    } else {
+        multiplexer_reserve(self, self->mux.count);
+        for (size_t i = 0; i < self->mux.count; i++) {
+            nmea_mux_flush(&self->mux.devices[i], &self->rows, self->device_ids);
+        }
+    }
+    return mp_obj_new_int(self->rows.count);
+}
+
+// Колонка array из первых count элементов буфера
+static mp_obj_t column_copy(char typecode, size_t item_size, const void* items, size_t count) {
+    mp_obj_array_t* array = new_column(typecode, item_size, count);
+    memcpy(array->items, items, count * item_size);
+    array->len = count;
+    return MP_OBJ_FROM_PTR(array);
+}
+
+// take() - накопленные строки как dict колонок (ключи parse_file + device) и очистка буфера
+static mp_obj_t multiplexer_take(mp_obj_t self_in) {
+    multiplexer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    nmea_columns_t* rows = &self->rows;
+    size_t n = rows->count;
+
+    mp_obj_dict_t* dict = mp_obj_new_dict(8);
+    mp_obj_dict_store(dict, mp_obj_new_str("device", 6), column_copy('I', 4, self->device_ids, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("time", 4), column_copy('q', 8, rows->time_ms, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("latitude", 8), column_copy('d', 8, rows->latitude, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("longitude", 9), column_copy('d', 8, rows->longitude, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("altitude", 8), column_copy('d', 8, rows->altitude, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("speed", 5), column_copy('d', 8, rows->speed, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("hdop", 4), column_copy('d', 8, rows->hdop, n));
+    mp_obj_dict_store(dict, mp_obj_new_str("satellites", 10), column_copy('B', 1, rows->satellites, n));
+    rows->count = 0;
+    return MP_OBJ_FROM_PTR(dict);
+}
+
+// Число известных устройств
+static mp_obj_t multiplexer_devices(mp_obj_t self_in) {
+    multiplexer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(self->mux.count);
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_3(multiplexer_feed_obj, multiplexer_feed);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(multiplexer_feed_batch_obj, 4, 4, multiplexer_feed_batch);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(multiplexer_flush_obj, 1, 2, multiplexer_flush);
+static MP_DEFINE_CONST_FUN_OBJ_1(multiplexer_take_obj, multiplexer_take);
+static MP_DEFINE_CONST_FUN_OBJ_1(multiplexer_devices_obj, multiplexer_devices);
+
+static const mp_rom_map_elem_t multiplexer_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_feed), MP_ROM_PTR(&multiplexer_feed_obj) },
+    { MP_ROM_QSTR(MP_QSTR_feed_batch), MP_ROM_PTR(&multiplexer_feed_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&multiplexer_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_take), MP_ROM_PTR(&multiplexer_take_obj) },
+    { MP_ROM_QSTR(MP_QSTR_devices), MP_ROM_PTR(&multiplexer_devices_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(multiplexer_locals_dict, multiplexer_locals_dict_table);
+
+// Тип Multiplexer
+MP_DEFINE_CONST_OBJ_TYPE(
+    multiplexer_type,
+    MP_QSTR_Multiplexer,
+    MP_TYPE_FLAG_NONE,
+    make_new, multiplexer_make_new,
+    locals_dict, &multiplexer_locals_dict
+    );
+
+// Генератор синтетического трафика
+typedef struct _generator_obj_t {
+    mp_obj_base_t base;
+    nmea_gen_t gen;
+} generator_obj_t;
+
+// Generator(trajectory="straight", rate=1, constellations=1, satellites=12,
+//           sentences="RMC,GGA,GSA,GSV,VTG", corrupt_ppm=0, seed=1, lat=, lon=, alt=, speed=,
+//           heading=, radius=, period=, event=, jump=, start_ms=)
+static mp_obj_t generator_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_trajectory, ARG_rate, ARG_constellations, ARG_satellites, ARG_sentences, ARG_corrupt_ppm,
+           ARG_seed, ARG_lat, ARG_lon, ARG_alt, ARG_speed, ARG_heading, ARG_radius, ARG_period,
+           ARG_event, ARG_jump, ARG_start_ms };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_trajectory, MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_rate, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1} },
+        { MP_QSTR_constellations, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1} },
+        { MP_QSTR_satellites, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 12} },
+        { MP_QSTR_sentences, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_corrupt_ppm, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_seed, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1} },
+        { MP_QSTR_lat, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_lon, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_alt, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_speed, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_heading, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_radius, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_period, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_event, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_jump, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_start_ms, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+
+    nmea_gen_config_t config;
+    nmea_gen_config_default(&config);
+    if (vals[ARG_trajectory].u_obj != mp_const_none) {
+        int trajectory = nmea_gen_parse_trajectory(mp_obj_str_get_str(vals[ARG_trajectory].u_obj));
+        if (trajectory < 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("unknown trajectory"));
+        }
+        config.trajectory = trajectory;
+    }
+    if (vals[ARG_sentences].u_obj != mp_const_none) {
+        int sentences = nmea_gen_parse_sentences(mp_obj_str_get_str(vals[ARG_sentences].u_obj));
+        if (sentences <= 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("unknown sentence in sentences"));
+        }
+        config.sentences = sentences;
+    }
+
+    // Необязательные вещественные параметры: None - значение по умолчанию
+    static const uint8_t float_args[] = { ARG_lat, ARG_lon, ARG_alt, ARG_speed, ARG_heading,
+                                          ARG_radius, ARG_period, ARG_event, ARG_jump };
+    double* float_fields[] = { &config.lat, &config.lon, &config.alt, &config.speed_mps, &config.heading_deg,
+                               &config.radius_m, &config.period_s, &config.event_s, &config.jump_m };
+    for (size_t i = 0; i < MP_ARRAY_SIZE(float_args); i++) {
+        if (vals[float_args[i]].u_obj != mp_const_none) {
+            *float_fields[i] = mp_obj_get_float(vals[float_args[i]].u_obj);
+        }
+    }
+    if (vals[ARG_start_ms].u_obj != mp_const_none) {
+        config.start_ms = (int64_t)get_uint64(vals[ARG_start_ms].u_obj);
+    }
+
+    mp_int_t rate = vals[ARG_rate].u_int;
+    mp_int_t constellations = vals[ARG_constellations].u_int;
+    mp_int_t satellites = vals[ARG_satellites].u_int;
+    if (rate < 1 || rate > 100 || constellations < 1 || constellations > NMEA_GEN_MAX_CONSTELLATIONS ||
+        satellites < 0 || satellites > constellations * NMEA_GEN_MAX_SATS_PER_CONSTELLATION ||
+        vals[ARG_corrupt_ppm].u_int < 0 || vals[ARG_corrupt_ppm].u_int > 1000000) {
+        mp_raise_ValueError(MP_ERROR_TEXT("generator parameter out of range"));
+    }
+    config.rate_hz = rate;
+    config.constellations = constellations;
+    config.satellites = satellites;
+    config.corrupt_ppm = vals[ARG_corrupt_ppm].u_int;
+    config.seed = (uint32_t)vals[ARG_seed].u_int;
+
+    generator_obj_t* self = mp_obj_malloc(generator_obj_t, type);
+    if (!nmea_gen_init(&self->gen, &config)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("generator parameter out of range"));
+    }
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// fill(buf) - целые эпохи в записываемый буфер; возвращает число записанных байт
+static mp_obj_t generator_fill(mp_obj_t self_in, mp_obj_t buf_in) {
+    generator_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t buf;
+    mp_get_buffer_raise(buf_in, &buf, MP_BUFFER_WRITE);
+    if (buf.len < NMEA_GEN_MAX_EPOCH) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small for one epoch"));
+    }
+    return mp_obj_new_int_from_uint(nmea_gen_fill(&self->gen, buf.buf, buf.len));
+}
+
+// epoch() - следующая эпоха как bytes
+static mp_obj_t generator_epoch(mp_obj_t self_in) {
+    generator_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    char* out = m_new(char, NMEA_GEN_MAX_EPOCH);
+    size_t len = nmea_gen_epoch(&self->gen, out);
+    mp_obj_t result = mp_obj_new_bytes((const uint8_t*)out, len);
+    m_del(char, out, NMEA_GEN_MAX_EPOCH);
+    return result;
+}
+
+// write(path, size) - файл из целых эпох размером около size байт; возвращает его длину
+static mp_obj_t generator_write(mp_obj_t self_in, mp_obj_t path, mp_obj_t size_in) {
+    generator_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    uint64_t size = get_uint64(size_in);
+    size_t capacity = NMEA_LOG_CHUNK + NMEA_GEN_MAX_EPOCH;
+    char* chunk = m_new(char, capacity);
+    mp_obj_t file = mp_call_function_2(MP_OBJ_FROM_PTR(&mp_builtin_open_obj), path, MP_OBJ_NEW_QSTR(MP_QSTR_wb));
+
+    uint64_t written = 0;
+    while (written < size) {
+        size_t len = nmea_gen_fill(&self->gen, chunk, capacity);
+        log_file_write(file, chunk, len);
+        written += len;
+    }
+    mp_stream_close(file);
+    m_del(char, chunk, capacity);
+    return mp_obj_new_int_from_ull(written);
+}
+
+// truth() - истинное состояние последней эпохи: (time_ms, lat, lon, alt, speed, course, fix)
+static mp_obj_t generator_truth(mp_obj_t self_in) {
+    generator_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    const nmea_gen_t* gen = &self->gen;
+    mp_obj_t items[7] = {
+        mp_obj_new_int_from_ll(gen->time_ms),
+        mp_obj_new_float(gen->out_lat),
+        mp_obj_new_float(gen->out_lon),
+        mp_obj_new_float(gen->config.alt),
+        mp_obj_new_float(gen->speed_mps),
+        mp_obj_new_float(gen->heading_deg),
+        mp_obj_new_bool(gen->fix),
+    };
+    return mp_obj_new_tuple(7, items);
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_2(generator_fill_obj, generator_fill);
+static MP_DEFINE_CONST_FUN_OBJ_1(generator_epoch_obj, generator_epoch);
+static MP_DEFINE_CONST_FUN_OBJ_3(generator_write_obj, generator_write);
+static MP_DEFINE_CONST_FUN_OBJ_1(generator_truth_obj, generator_truth);
+
+static const mp_rom_map_elem_t generator_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&generator_fill_obj) },
+    { MP_ROM_QSTR(MP_QSTR_epoch), MP_ROM_PTR(&generator_epoch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&generator_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_truth), MP_ROM_PTR(&generator_truth_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(generator_locals_dict, generator_locals_dict_table);
+
+// Тип Generator
+MP_DEFINE_CONST_OBJ_TYPE(
+    generator_type,
+    MP_QSTR_Generator,
+    MP_TYPE_FLAG_NONE,
+    make_new, generator_make_new,
+    locals_dict, &generator_locals_dict
+    );
+
+// Значение ключа словаря или MP_OBJ_NULL
+static mp_obj_t dict_lookup(mp_obj_t dict, qstr key) {
+    mp_map_elem_t* elem = mp_map_lookup(mp_obj_dict_get_map(dict), MP_OBJ_NEW_QSTR(key), MP_MAP_LOOKUP);
+    return elem ? elem->value : MP_OBJ_NULL;
+}
+
+static double dict_float(mp_obj_t dict, qstr key) {
+    mp_obj_t value = dict_lookup(dict, key);
+    return (value != MP_OBJ_NULL && value != mp_const_none) ? mp_obj_get_float(value) : NAN;
+}
+
+// gps_data_t из словаря в формате parse()/current() (отфильтрованные или сглаженные значения);
+// отсутствующие ключи - пустые поля
+static void gps_data_from_dict(mp_obj_t dict, gps_data_t* gps_data) {
+    if (!mp_obj_is_type(dict, &mp_type_dict)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("fix must be a dict"));
+    }
+    gps_data_init(gps_data);
+
+    mp_obj_t value = dict_lookup(dict, MP_QSTR_valid);
+    gps_data->valid = (value != MP_OBJ_NULL) && mp_obj_is_true(value);
+    gps_data->latitude = dict_float(dict, MP_QSTR_latitude);
+    gps_data->longitude = dict_float(dict, MP_QSTR_longitude);
+    gps_data->altitude = dict_float(dict, MP_QSTR_altitude);
+    gps_data->speed = dict_float(dict, MP_QSTR_speed);
+    gps_data->course = dict_float(dict, MP_QSTR_course);
+    gps_data->hdop = dict_float(dict, MP_QSTR_hdop);
+    gps_data->vdop = dict_float(dict, MP_QSTR_vdop);
+    gps_data->pdop = dict_float(dict, MP_QSTR_pdop);
+
+    if ((value = dict_lookup(dict, MP_QSTR_satellites_used)) != MP_OBJ_NULL) {
+        gps_data->satellites_used = mp_obj_get_int(value);
+        gps_data->has_satellites_used = 1;
+    }
+    if ((value = dict_lookup(dict, MP_QSTR_fix_type)) != MP_OBJ_NULL) {
+        gps_data->fix_type = mp_obj_get_int(value);
+    } else {
+        gps_data->fix_type = gps_data->valid ? 1 : 0;
+    }
+
+    // date [день, месяц, год], time [часы, минуты, секунды]
+    mp_obj_t* items;
+    size_t len;
+    if ((value = dict_lookup(dict, MP_QSTR_date)) != MP_OBJ_NULL) {
+        mp_obj_get_array_fixed_n(value, 3, &items);
+        gps_data->day = mp_obj_get_int(items[0]);
+        gps_data->month = mp_obj_get_int(items[1]);
+        gps_data->year = mp_obj_get_int(items[2]);
+    }
+    if ((value = dict_lookup(dict, MP_QSTR_time)) != MP_OBJ_NULL) {
+        mp_obj_get_array(value, &len, &items);
+        if (len < 3) {
+            mp_raise_ValueError(MP_ERROR_TEXT("time must be [hour, minute, second]"));
+        }
+        gps_data->hour = mp_obj_get_int(items[0]);
+        gps_data->minute = mp_obj_get_int(items[1]);
+        double second = mp_obj_get_float(items[2]);
+        gps_data->second = (uint8_t)second;
+        gps_data->millisecond = (uint16_t)((second - gps_data->second) * 1000.0 + 0.5);
+    }
+}
+
+// Словарь fix или текущее состояние (fix = None)
+static void fix_or_current(mp_obj_t fix, gps_data_t* gps_data) {
+    if (fix != mp_const_none) {
+        gps_data_from_dict(fix, gps_data);
+    } else {
+        if (!gps_data_initialized) {
+            gps_data_init(&current_gps_data);
+            gps_data_initialized = 1;
+        }
+        *gps_data = current_gps_data;
+    }
+}
+
+// Общий разбор аргументов encode/encode_into: (sentences[, fix[, talker]])
+static int encode_args(size_t n_args, const mp_obj_t *args, gps_data_t* gps_data, const char** talker) {
+    int sentences = nmea_encode_parse_sentences(mp_obj_str_get_str(args[0]));
+    if (sentences <= 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("sentences must list RMC, GGA, GSA, VTG"));
+    }
+
+    fix_or_current(n_args > 1 ? args[1] : mp_const_none, gps_data);
+
+    *talker = "GP";
+    if (n_args > 2) {
+        size_t talker_len;
+        *talker = mp_obj_str_get_data(args[2], &talker_len);
+        if (talker_len != 2) {
+            mp_raise_ValueError(MP_ERROR_TEXT("talker must be 2 characters"));
+        }
+    }
+    return sentences;
+}
+
+// encode(sentences[, fix[, talker]]) - предложения "RMC,GGA,GSA,VTG" из текущих данных или
+// словаря fix с контрольными суммами; возвращает bytes
+static mp_obj_t encode(size_t n_args, const mp_obj_t *args) {
+    gps_data_t gps_data;
+    const char* talker;
+    int sentences = encode_args(n_args, args, &gps_data, &talker);
+
+    char out[4 * NMEA_ENCODE_MAX_SENTENCE];
+    size_t len = nmea_encode_epoch(&gps_data, sentences, talker, out, sizeof(out));
+    return mp_obj_new_bytes((const uint8_t*)out, len);
+}
+
+// encode_into(buf, sentences[, fix[, talker]]) - то же в записываемый буфер; возвращает длину
+static mp_obj_t encode_into(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t buf;
+    mp_get_buffer_raise(args[0], &buf, MP_BUFFER_WRITE);
+
+    gps_data_t gps_data;
+    const char* talker;
+    int sentences = encode_args(n_args - 1, args + 1, &gps_data, &talker);
+
+    size_t len = nmea_encode_epoch(&gps_data, sentences, talker, buf.buf, buf.len);
+    if (len == 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+    }
+    return mp_obj_new_int_from_uint(len);
+}
+
+// Пересылка выбранных предложений без изменений
+typedef struct _router_obj_t {
+    mp_obj_base_t base;
+    nmea_router_t router;
+    char* out;              // выходной буфер, растет под размер фрагмента
+    size_t out_capacity;
+    size_t pending;         // не принятый потоком хвост в начале out, уходит первым
+} router_obj_t;
+
+// Router([types[, validate]]) - types "GGA,RMC,TXT" (по умолчанию все), validate=True
+static mp_obj_t router_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 2, false);
+
+    const char* types = (n_args > 0 && args[0] != mp_const_none) ? mp_obj_str_get_str(args[0]) : NULL;
+    int validate = (n_args > 1) ? mp_obj_is_true(args[1]) : 1;
+
+    router_obj_t* self = mp_obj_malloc(router_obj_t, type);
+    if (!nmea_router_init(&self->router, types, validate)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("types must be 3-letter sentence types, at most 16"));
+    }
+    self->out = NULL;
+    self->out_capacity = 0;
+    self->pending = 0;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// route(data[, stream]) - выбранные полные строки фрагмента; без stream возвращает bytes,
+// со stream записывает в него (UART, файл, сокет) и возвращает число записанных байт. Что
+// неблокирующий поток не принял, остается в Router и уходит первым при следующем route()
+static mp_obj_t router_route(size_t n_args, const mp_obj_t *args) {
+    router_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t data_buf;
+    mp_get_buffer_raise(args[1], &data_buf, MP_BUFFER_READ);
+
+    size_t need = self->pending + NMEA_ROUTER_MAX_OUTPUT(data_buf.len);
+    if (need > self->out_capacity) {
+        self->out = m_renew(char, self->out, self->out_capacity, need);
+        self->out_capacity = need;
+    }
+    size_t len = self->pending + nmea_router_feed(&self->router, data_buf.buf, data_buf.len, self->out + self->pending);
+    self->pending = 0;
+
+    if (n_args > 2) {
+        int errcode;
+        mp_uint_t out = mp_stream_rw(args[2], self->out, len, &errcode, MP_STREAM_RW_WRITE);
+        if (out == MP_STREAM_ERROR) {
+            // Ничего не записано: все остается до следующего вызова
+            self->pending = len;
+            if (!mp_is_nonblocking_error(errcode)) {
+                mp_raise_OSError(errcode);
+            }
+            out = 0;
+        } else if (out < len) {
+            self->pending = len - out;
+            memmove(self->out, self->out + out, self->pending);
+        }
+        return mp_obj_new_int_from_uint(out);
+    }
+    return mp_obj_new_bytes((const uint8_t*)self->out, len);
+}
+
+// stats() - (пропущено, отброшено) строк
+static mp_obj_t router_stats(mp_obj_t self_in) {
+    router_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t items[2] = {
+        mp_obj_new_int_from_uint(self->router.passed),
+        mp_obj_new_int_from_uint(self->router.dropped),
+    };
+    return mp_obj_new_tuple(2, items);
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(router_route_obj, 2, 3, router_route);
+static MP_DEFINE_CONST_FUN_OBJ_1(router_stats_obj, router_stats);
+
+static const mp_rom_map_elem_t router_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_route), MP_ROM_PTR(&router_route_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&router_stats_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(router_locals_dict, router_locals_dict_table);
+
+// Тип Router
+MP_DEFINE_CONST_OBJ_TYPE(
+    router_type,
+    MP_QSTR_Router,
+    MP_TYPE_FLAG_NONE,
+    make_new, router_make_new,
+    locals_dict, &router_locals_dict
+    );
+
+// Битовая упаковка фиксов для LPWAN
+typedef struct _packer_obj_t {
+    mp_obj_base_t base;
+    nmea_pack_frame_t frame;
+} packer_obj_t;
+
+// Packer(budget=51, lat_bits=24, lon_bits=24, alt_bits=12, speed_bits=7, hdop_bits=4, fix_bits=3,
+//        time_bits=0, delta_bits=12, time_delta_bits=8, alt_min=-500, alt_max=8000, speed_max=63, hdop_max=7)
+static mp_obj_t packer_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_budget, ARG_lat_bits, ARG_lon_bits, ARG_alt_bits, ARG_speed_bits, ARG_hdop_bits, ARG_fix_bits,
+           ARG_time_bits, ARG_delta_bits, ARG_time_delta_bits, ARG_alt_min, ARG_alt_max, ARG_speed_max,
+           ARG_hdop_max };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_budget, MP_ARG_INT, {.u_int = 51} },
+        { MP_QSTR_lat_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 24} },
+        { MP_QSTR_lon_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 24} },
+        { MP_QSTR_alt_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 12} },
+        { MP_QSTR_speed_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 7} },
+        { MP_QSTR_hdop_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 4} },
+        { MP_QSTR_fix_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 3} },
+        { MP_QSTR_time_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_delta_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 12} },
+        { MP_QSTR_time_delta_bits, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 8} },
+        { MP_QSTR_alt_min, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_alt_max, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_speed_max, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+        { MP_QSTR_hdop_max, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+
+    nmea_pack_layout_t layout;
+    nmea_pack_layout_default(&layout);
+
+    // Разрядности полей; выход за uint8_t отсекает nmea_pack_layout_check
+    static const uint8_t bits_args[] = { ARG_lat_bits, ARG_lon_bits, ARG_alt_bits, ARG_speed_bits, ARG_hdop_bits,
+                                         ARG_fix_bits, ARG_time_bits, ARG_delta_bits, ARG_time_delta_bits };
+    uint8_t* bits_fields[] = { &layout.lat_bits, &layout.lon_bits, &layout.alt_bits, &layout.speed_bits,
+                               &layout.hdop_bits, &layout.fix_bits, &layout.time_bits, &layout.delta_bits,
+                               &layout.time_delta_bits };
+    for (size_t i = 0; i < MP_ARRAY_SIZE(bits_args); i++) {
+        mp_int_t bits = vals[bits_args[i]].u_int;
+        *bits_fields[i] = (bits < 0 || bits > 32) ? 255 : (uint8_t)bits;
+    }
+
+    // Диапазоны: None - значение по умолчанию
+    static const uint8_t float_args[] = { ARG_alt_min, ARG_alt_max, ARG_speed_max, ARG_hdop_max };
+    double* float_fields[] = { &layout.alt_min, &layout.alt_max, &layout.speed_max, &layout.hdop_max };
+    for (size_t i = 0; i < MP_ARRAY_SIZE(float_args); i++) {
+        if (vals[float_args[i]].u_obj != mp_const_none) {
+            *float_fields[i] = mp_obj_get_float(vals[float_args[i]].u_obj);
+        }
+    }
+
+    mp_int_t budget = vals[ARG_budget].u_int;
+    packer_obj_t* self = mp_obj_malloc(packer_obj_t, type);
+    if (budget < 1 || budget > NMEA_PACK_MAX_FRAME || !nmea_pack_frame_init(&self->frame, &layout, budget)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("packer layout out of range"));
+    }
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// add([fix]) - текущий фикс или словарь fix в кадр; False, если не помещается (кадр пора отправить)
+static mp_obj_t packer_add(size_t n_args, const mp_obj_t *args) {
+    packer_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    gps_data_t gps_data;
+    fix_or_current(n_args > 1 ? args[1] : mp_const_none, &gps_data);
+    return mp_obj_new_bool(nmea_pack_frame_add(&self->frame, &gps_data));
+}
+
+// frame() - накопленный кадр как bytes (пустой, если точек нет); начинает новый кадр
+static mp_obj_t packer_frame(mp_obj_t self_in) {
+    packer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t result = mp_obj_new_bytes(self->frame.data, nmea_pack_frame_size(&self->frame));
+    nmea_pack_frame_reset(&self->frame);
+    return result;
+}
+
+// frame_into(buf) - то же в записываемый буфер; возвращает длину
+static mp_obj_t packer_frame_into(mp_obj_t self_in, mp_obj_t buf_in) {
+    packer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t buf;
+    mp_get_buffer_raise(buf_in, &buf, MP_BUFFER_WRITE);
+    size_t len = nmea_pack_frame_size(&self->frame);
+    if (len > buf.len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+    }
+    memcpy(buf.buf, self->frame.data, len);
+    nmea_pack_frame_reset(&self->frame);
+    return mp_obj_new_int_from_uint(len);
+}
+
+// pack([fix]) - кадр из одной точки, не трогая накопленный
+static mp_obj_t packer_pack(size_t n_args, const mp_obj_t *args) {
+    packer_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    gps_data_t gps_data;
+    fix_or_current(n_args > 1 ? args[1] : mp_const_none, &gps_data);
+
+    nmea_pack_frame_t single;
+    nmea_pack_frame_init(&single, &self->frame.layout, NMEA_PACK_MAX_FRAME);
+    nmea_pack_frame_add(&single, &gps_data);
+    return mp_obj_new_bytes(single.data, nmea_pack_frame_size(&single));
+}
+
+// unpack(data) - список словарей точек кадра (сторона сервера, та же раскладка)
+static mp_obj_t packer_unpack(mp_obj_t self_in, mp_obj_t data_in) {
+    packer_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t data;
+    mp_get_buffer_raise(data_in, &data, MP_BUFFER_READ);
+
+    nmea_pack_fix_t fixes[NMEA_PACK_MAX_POINTS];
+    int count = nmea_pack_decode(&self->frame.layout, data.buf, data.len, fixes);
+    if (count < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("frame does not match layout"));
+    }
+
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    for (int i = 0; i < count; i++) {
+        const nmea_pack_fix_t* fix = &fixes[i];
+        mp_obj_t dict = mp_obj_new_dict(8);
+        mp_obj_dict_store(dict, mp_obj_new_str("valid", 5), mp_obj_new_bool(fix->valid));
+        static const char* const names[] = { "latitude", "longitude", "altitude", "speed", "hdop" };
+        const double values[] = { fix->latitude, fix->longitude, fix->altitude, fix->speed, fix->hdop };
+        for (size_t k = 0; k < MP_ARRAY_SIZE(values); k++) {
+            if (!isnan(values[k])) {
+                mp_obj_dict_store(dict, mp_obj_new_str(names[k], strlen(names[k])), mp_obj_new_float(values[k]));
+            }
+        }
+        if (fix->fix_type >= 0) {
+            mp_obj_dict_store(dict, mp_obj_new_str("fix_type", 8), mp_obj_new_int(fix->fix_type));
+        }
+        if (fix->time_of_day >= 0) {
+            mp_obj_dict_store(dict, mp_obj_new_str("time_of_day", 11), mp_obj_new_int(fix->time_of_day));
+        }
+        mp_obj_list_append(list, dict);
+    }
+    return list;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(packer_add_obj, 1, 2, packer_add);
+static MP_DEFINE_CONST_FUN_OBJ_1(packer_frame_obj, packer_frame);
+static MP_DEFINE_CONST_FUN_OBJ_2(packer_frame_into_obj, packer_frame_into);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(packer_pack_obj, 1, 2, packer_pack);
+static MP_DEFINE_CONST_FUN_OBJ_2(packer_unpack_obj, packer_unpack);
+
+static const mp_rom_map_elem_t packer_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_add), MP_ROM_PTR(&packer_add_obj) },
+    { MP_ROM_QSTR(MP_QSTR_frame), MP_ROM_PTR(&packer_frame_obj) },
+    { MP_ROM_QSTR(MP_QSTR_frame_into), MP_ROM_PTR(&packer_frame_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack), MP_ROM_PTR(&packer_pack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&packer_unpack_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(packer_locals_dict, packer_locals_dict_table);
+
+// Тип Packer
+MP_DEFINE_CONST_OBJ_TYPE(
+    packer_type,
+    MP_QSTR_Packer,
+    MP_TYPE_FLAG_NONE,
+    make_new, packer_make_new,
+    locals_dict, &packer_locals_dict
+    );
+
+// Потоковая загрузка AssistNow из файла в приемник
+typedef struct _assist_uploader_obj_t {
+    mp_obj_base_t base;
+    mp_obj_t file;
+    mp_obj_t uart;
+    ubx_upload_t upload;
+    size_t frame_sent;      // байт текущего кадра, уже принятых UART (короткая запись)
+} assist_uploader_obj_t;
+
+// AssistUploader(file, uart[, date[, timeout_ms]]) - file открыт в "rb" (mgaoffline.ubx и т.п.),
+// uart - поток приемника (чтение без блокировки или с коротким timeout); date - (год, месяц, день)
+// для отбора MGA-ANO (None - все); timeout_ms ожидания MGA-ACK (по умолчанию 1000; ACK включается
+// в приемнике CFG-NAVSPG-ACKAIDING), 0 - без ожидания ACK
+static mp_obj_t assist_uploader_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 2, 4, false);
+
+    int year = 0, month = 0, day = 0;
+    if (n_args > 2 && args[2] != mp_const_none) {
+        size_t len;
+        mp_obj_t* items;
+        mp_obj_get_array(args[2], &len, &items);
+        if (len != 3) {
+            mp_raise_ValueError(MP_ERROR_TEXT("date must be (year, month, day)"));
+        }
+        year = mp_obj_get_int(items[0]);
+        month = mp_obj_get_int(items[1]);
+        day = mp_obj_get_int(items[2]);
+        if (year < 2000 || year > 2255 || month < 1 || month > 12 || day < 1 || day > 31) {
+            mp_raise_ValueError(MP_ERROR_TEXT("date out of range"));
+        }
+    }
+    mp_int_t timeout_ms = (n_args > 3) ? mp_obj_get_int(args[3]) : 1000;
+    if (timeout_ms < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("timeout_ms must be >= 0"));
+    }
+
+    assist_uploader_obj_t* self = mp_obj_malloc(assist_uploader_obj_t, type);
+    self->file = args[0];
+    self->uart = args[1];
+    ubx_upload_init(&self->upload, year, month, day, (uint32_t)timeout_ms);
+    self->frame_sent = 0;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Один шаг без блокировки: чтение файла, отправка не больше одного кадра, разбор ответа
+// приемника; 0 - загрузка закончена
+static int assist_uploader_poll_once(assist_uploader_obj_t* self) {
+    ubx_upload_t* upload = &self->upload;
+    for (;;) {
+        switch (ubx_upload_step(upload, mp_hal_ticks_ms())) {
+            case UBX_UPLOAD_READ:
+                ubx_upload_input(upload, log_file_read(self->file, (char*)upload->input, UBX_UPLOAD_CHUNK));
+                break;
+            case UBX_UPLOAD_WRITE: {
+                // Кадр уходит целиком до отметки об отправке: обрывок MGA сбивает разбор в приемнике
+                int errcode;
+                mp_uint_t out = mp_stream_rw(self->uart, upload->frame + self->frame_sent,
+                                             upload->frame_len - self->frame_sent, &errcode, MP_STREAM_RW_WRITE);
+                if (out == MP_STREAM_ERROR) {
+                    if (!mp_is_nonblocking_error(errcode)) {
+                        mp_raise_OSError(errcode);
+                    }
+                    out = 0;
+                }
+                self->frame_sent += out;
+                if (self->frame_sent < upload->frame_len) return 1;
+                self->frame_sent = 0;
+                ubx_upload_written(upload, mp_hal_ticks_ms());
+                return 1;
+            }
+            case UBX_UPLOAD_WAIT: {
+                uint8_t buf[UBX_FRAME_OVERHEAD + UBX_MGA_ACK_SIZE];
+                int errcode;
+                mp_uint_t out = mp_stream_rw(self->uart, buf, sizeof(buf), &errcode,
+                                             MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
+                if (out == MP_STREAM_ERROR) {
+                    if (!mp_is_nonblocking_error(errcode)) {
+                        mp_raise_OSError(errcode);
+                    }
+                    out = 0;
+                }
+                if (out == 0) return 1;
+                ubx_upload_receive(upload, buf, out);
+                break;
+            }
+            default:
+                return 0;
+        }
+    }
+}
+
+// poll() - шаг загрузки для цикла приложения; True, пока загрузка не закончена
+static mp_obj_t assist_uploader_poll(mp_obj_t self_in) {
+    assist_uploader_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_bool(assist_uploader_poll_once(self));
+}
+
+// stats() - (отправлено, ACK, NAK, пропущено других дат, без ответа) кадров
+static mp_obj_t assist_uploader_stats(mp_obj_t self_in) {
+    assist_uploader_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    const ubx_upload_t* upload = &self->upload;
+    mp_obj_t items[5] = {
+        mp_obj_new_int_from_uint(upload->sent),
+        mp_obj_new_int_from_uint(upload->acked),
+        mp_obj_new_int_from_uint(upload->nacked),
+        mp_obj_new_int_from_uint(upload->skipped),
+        mp_obj_new_int_from_uint(upload->timeouts),
+    };
+    return mp_obj_new_tuple(5, items);
+}
+
+// upload() - загрузка до конца файла с ожиданием ACK; возвращает stats()
+static mp_obj_t assist_uploader_upload(mp_obj_t self_in) {
+    assist_uploader_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    while (assist_uploader_poll_once(self)) {
+        if (self->upload.written) mp_hal_delay_ms(1);
+    }
+    return assist_uploader_stats(self_in);
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_1(assist_uploader_poll_obj, assist_uploader_poll);
+static MP_DEFINE_CONST_FUN_OBJ_1(assist_uploader_upload_obj, assist_uploader_upload);
+static MP_DEFINE_CONST_FUN_OBJ_1(assist_uploader_stats_obj, assist_uploader_stats);
+
+static const mp_rom_map_elem_t assist_uploader_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_poll), MP_ROM_PTR(&assist_uploader_poll_obj) },
+    { MP_ROM_QSTR(MP_QSTR_upload), MP_ROM_PTR(&assist_uploader_upload_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&assist_uploader_stats_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(assist_uploader_locals_dict, assist_uploader_locals_dict_table);
+
+// Тип AssistUploader
+MP_DEFINE_CONST_OBJ_TYPE(
+    assist_uploader_type,
+    MP_QSTR_AssistUploader,
+    MP_TYPE_FLAG_NONE,
+    make_new, assist_uploader_make_new,
+    locals_dict, &assist_uploader_locals_dict
+    );
+
+// Запись сырых кадров UBX в файл
+typedef struct _ubx_capture_obj_t {
+    mp_obj_base_t base;
+    mp_obj_t file;
+    ubx_capture_t capture;
+} ubx_capture_obj_t;
+
+// Размер буфера записи по умолчанию
+#define UBX_CAPTURE_DEFAULT_BUFFER 16384
+
+// Размер блока чтения pump() на стеке
+#define UBX_CAPTURE_CHUNK 256
+
+// UbxCapture(file[, classes[, buffer_size]]) - file открыт в "wb"/"ab"; classes - кортеж классов
+// UBX для записи (по умолчанию (0x02,) - RXM: RAWX, SFRBX); buffer_size - байт буфера записи
+static mp_obj_t ubx_capture_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 3, false);
+
+    mp_int_t buffer_size = (n_args > 2) ? mp_obj_get_int(args[2]) : UBX_CAPTURE_DEFAULT_BUFFER;
+    if (buffer_size < UBX_CAPTURE_MAX_FRAME + UBX_CAPTURE_BLOCK) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer_size too small"));
+    }
+
+    ubx_capture_obj_t* self = mp_obj_malloc(ubx_capture_obj_t, type);
+    self->file = args[0];
+    ubx_capture_init(&self->capture, m_new(uint8_t, buffer_size), (size_t)buffer_size);
+    if (n_args > 1 && args[1] != mp_const_none) {
+        size_t count;
+        mp_obj_t* items;
+        mp_obj_get_array(args[1], &count, &items);
+        for (size_t i = 0; i < count; i++) {
+            mp_int_t msg_class = mp_obj_get_int(items[i]);
+            if (msg_class < 0 || msg_class > 255) {
+                mp_raise_ValueError(MP_ERROR_TEXT("UBX class must be 0..255"));
+            }
+            ubx_capture_select(&self->capture, (uint8_t)msg_class);
+        }
+    } else {
+        ubx_capture_select(&self->capture, UBX_CLASS_RXM);
+    }
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Запись первых len байт буфера в файл вызывающего: при ошибке файл не закрывается, записанная
+// часть снимается с буфера, остальное остается до следующей записи
+static void ubx_capture_write(ubx_capture_obj_t* self, size_t len) {
+    int errcode;
+    mp_uint_t out = mp_stream_rw(self->file, self->capture.buf, len, &errcode, MP_STREAM_RW_WRITE);
+    if (out == MP_STREAM_ERROR) {
+        mp_raise_OSError(errcode);
+    }
+    if (out) ubx_capture_written(&self->capture, out);
+    if (out != len) {
+        mp_raise_OSError(MP_EIO);
+    }
+}
+
+// Подача байт с записью полных блоков по мере заполнения буфера
+static void ubx_capture_feed_all(ubx_capture_obj_t* self, const uint8_t* data, size_t len) {
+    ubx_capture_t* capture = &self->capture;
+    while (len > 0) {
+        size_t used = ubx_capture_feed(capture, data, len);
+        data += used;
+        len -= used;
+        size_t pending = ubx_capture_pending(capture);
+        if (pending) {
+            ubx_capture_write(self, pending);
+        }
+    }
+}
+
+// feed(data) - байты потока приемника (NMEA и другие классы пропускаются)
+static mp_obj_t ubx_capture_feed_data(mp_obj_t self_in, mp_obj_t data_in) {
+    ubx_capture_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t data;
+    mp_get_buffer_raise(data_in, &data, MP_BUFFER_READ);
+    ubx_capture_feed_all(self, data.buf, data.len);
+    return mp_const_none;
+}
+
+// pump(uart[, max_bytes]) - чтение из потока без создания объектов Python, пока есть данные
+// (но не больше max_bytes, по умолчанию 4096); возвращает число прочитанных байт
+static mp_obj_t ubx_capture_pump(size_t n_args, const mp_obj_t *args) {
+    ubx_capture_obj_t* self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t max_bytes = (n_args > 2) ? mp_obj_get_int(args[2]) : 4096;
+    uint8_t chunk[UBX_CAPTURE_CHUNK];
+    mp_int_t total = 0;
+    while (total < max_bytes) {
+        size_t want = (max_bytes - total < UBX_CAPTURE_CHUNK) ? (size_t)(max_bytes - total) : UBX_CAPTURE_CHUNK;
+        int errcode;
+        mp_uint_t out = mp_stream_rw(args[1], chunk, want, &errcode, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
+        if (out == MP_STREAM_ERROR) {
+            if (!mp_is_nonblocking_error(errcode)) {
+                mp_raise_OSError(errcode);
+            }
+            break;
+        }
+        if (out == 0) break;
+        ubx_capture_feed_all(self, chunk, out);
+        total += out;
+        if (out < want) break;
+    }
+    return mp_obj_new_int(total);
+}
+
+// flush() - запись всех принятых кадров (хвост не кратен блоку - перед закрытием файла)
+static mp_obj_t ubx_capture_flush(mp_obj_t self_in) {
+    ubx_capture_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    size_t len = self->capture.len;
+    if (len) {
+        ubx_capture_write(self, len);
+    }
+    return mp_obj_new_int_from_uint(len);
+}
+
+// stats() - (принято байт, записано байт, кадров, пропущено других классов, отброшено, записей)
+static mp_obj_t ubx_capture_stats(mp_obj_t self_in) {
+    ubx_capture_obj_t* self = MP_OBJ_TO_PTR(self_in);
+    const ubx_capture_t* capture = &self->capture;
+    mp_obj_t items[6] = {
+        mp_obj_new_int_from_ull(capture->bytes_in),
+        mp_obj_new_int_from_ull(capture->bytes_written),
+        mp_obj_new_int_from_uint(capture->messages),
+        mp_obj_new_int_from_uint(capture->skipped),
+        mp_obj_new_int_from_uint(ubx_capture_dropped(capture)),
+        mp_obj_new_int_from_uint(capture->writes),
+    };
+    return mp_obj_new_tuple(6, items);
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_2(ubx_capture_feed_obj, ubx_capture_feed_data);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ubx_capture_pump_obj, 2, 3, ubx_capture_pump);
+static MP_DEFINE_CONST_FUN_OBJ_1(ubx_capture_flush_obj, ubx_capture_flush);
+static MP_DEFINE_CONST_FUN_OBJ_1(ubx_capture_stats_obj, ubx_capture_stats);
+
+static const mp_rom_map_elem_t ubx_capture_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_feed), MP_ROM_PTR(&ubx_capture_feed_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pump), MP_ROM_PTR(&ubx_capture_pump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&ubx_capture_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&ubx_capture_stats_obj) },
+};
+
+static MP_DEFINE_CONST_DICT(ubx_capture_locals_dict, ubx_capture_locals_dict_table);
+
+// Тип UbxCapture
+MP_DEFINE_CONST_OBJ_TYPE(
+    ubx_capture_type,
+    MP_QSTR_UbxCapture,
+    MP_TYPE_FLAG_NONE,
+    make_new, ubx_capture_make_new,
+    locals_dict, &ubx_capture_locals_dict
+    );
+
+// Публичный C API (ublox_nmea.h): тот же разбор и состояние, что у parse()
+
+typedef struct {
+    ublox_nmea_listener_t callback;
+    void* context;
+} nmea_listener_entry_t;
+
+static nmea_listener_entry_t nmea_listeners[UBLOX_NMEA_MAX_LISTENERS];
+static uint8_t nmea_listener_count = 0;
+
+// Текущая эпоха: время UTC (мс от начала суток) последнего RMC/GGA
+static int32_t epoch_time_ms = -1;
+static uint8_t epoch_open = 0;
+
+// TTFF: тики mp_hal_ticks_ms() включения приемника (по умолчанию - загрузка) и время до
+// первого фикса, мс (-1 - фикса еще не было)
+static mp_uint_t ttff_start_ticks = 0;
+static int32_t ttff_ms = -1;
+
+// Неполная строка ublox_nmea_feed между вызовами
+static char feed_line[NMEA_MAX_SENTENCE + 3];
+static size_t feed_line_len = 0;
+static uint8_t feed_overflow = 0;
+
+// Таблица спутников из последнего UBX-NAV-SAT
+static ubx_sat_table_t sat_table;
+
+// Передача времени по PPS (тики mp_hal_ticks_us() и ticks_us() с маской периода); изменяется
+// из прерывания - чтение и запись кадров под атомарной секцией
+static ubx_timepulse_t timepulse;
+
+static void timepulse_reset(void) {
+    ubx_timepulse_init(&timepulse, 1000.0, MP_SMALL_INT_POSITIVE_MASK);
+}
+
+// Модель локальных часов (тики mp_hal_ticks_ms()) по приходу RMC с фиксом
+static nmea_clock_t clock_model;
+
+// Контроль радиотракта (MON-RF/MON-HW, C/N0 из GSV); пороги и обработчик переживают reset()
+static nmea_rf_t rf_monitor = {
+    .jam_ind_max = NMEA_RF_JAM_IND,
+    .min_signals = NMEA_RF_MIN_SIGNALS,
+    .cno_min = NMEA_RF_CNO_MIN,
+    .cno_drop = NMEA_RF_CNO_DROP,
+};
+
+// Обработчик тревог из rf_alerts(); в корневом указателе, чтобы его не собрал GC
+MP_REGISTER_ROOT_POINTER(mp_obj_t ublox_nmea_rf_callback);
+
+static void nmea_state_reset(void) {
+    gps_data_init(&current_gps_data);
+    gps_data_initialized = 1;
+    epoch_time_ms = -1;
+    epoch_open = 0;
+    feed_line_len = 0;
+    feed_overflow = 0;
+    ubx_sat_table_init(&sat_table);
+    timepulse_reset();
+    nmea_clock_init(&clock_model, MP_SMALL_INT_POSITIVE_MASK);
+    nmea_rf_reset(&rf_monitor);
+}
+
+static void notify_listeners(const gps_data_t* fix) {
+    for (uint8_t i = 0; i < nmea_listener_count; i++) {
+        nmea_listeners[i].callback(fix, nmea_listeners[i].context);
+    }
+}
+
+// Разбор предложения в текущее состояние: история и границы эпох для подписчиков
+static nmea_sentence_t process_sentence(const char* sentence) {
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+
+    // Состояние до предложения нужно только подписчикам (оно и есть завершенная эпоха)
+    gps_data_t previous;
+    if (nmea_listener_count > 0) {
+        previous = current_gps_data;
+    }
+
+    // Короткие строки и неверная контрольная сумма отбрасываются ядром
+    nmea_gsv_signals_t signals;
+    nmea_sentence_t type = nmea_parse_sentence_signals(sentence, &current_gps_data, &signals);
+    if (type == NMEA_SENTENCE_GSV) {
+        nmea_rf_gsv(&rf_monitor, &signals);
+    } else if (type == NMEA_SENTENCE_RMC || type == NMEA_SENTENCE_GGA) {
+        // Точка пишется только из предложения, обновившего координаты: после первого GGA
+        // RMC их не трогает, и старая позиция легла бы в историю под новым временем
+        if (type == NMEA_SENTENCE_GGA || !current_gps_data.has_gga) {
+            history_record(&current_gps_data);
+        }
+
+        // Фикс по самому предложению, а не по состоянию (оно могло прийти из load_state)
+        if (ttff_ms < 0 && ((type == NMEA_SENTENCE_RMC && current_gps_data.valid) ||
+                            (type == NMEA_SENTENCE_GGA && current_gps_data.fix_type > 0))) {
+            ttff_ms = (int32_t)(mp_hal_ticks_ms() - ttff_start_ticks);
+        }
+
+        // Пара (тики прихода, UTC эпохи) для модели часов: RMC несет дату и время целиком
+        if (type == NMEA_SENTENCE_RMC && current_gps_data.valid) {
+            int64_t utc_ms = gps_data_utc_ms(&current_gps_data);
+            if (utc_ms >= 0) nmea_clock_add(&clock_model, mp_hal_ticks_ms(), utc_ms);
+        }
+
+        // Новое время закрывает эпоху, как в parse_file()
+        int32_t time_ms = ((current_gps_data.hour * 60 + current_gps_data.minute) * 60 +
+                           current_gps_data.second) * 1000 + current_gps_data.millisecond;
+        if (time_ms != epoch_time_ms) {
+            if (epoch_open && nmea_listener_count > 0) {
+                notify_listeners(&previous);
+            }
+            // GSV идут после RMC/GGA своей эпохи - статистика C/N0 закрывается вместе с ней
+            if (epoch_open) {
+                nmea_rf_epoch(&rf_monitor);
+            }
+            epoch_time_ms = time_ms;
+            epoch_open = 1;
+        }
+    }
+    return type;
+}
+
+void ublox_nmea_init(void) {
+    nmea_state_reset();
+}
+
+nmea_sentence_t ublox_nmea_feed_sentence(const char* sentence) {
+    return process_sentence(sentence);
+}
+
+size_t ublox_nmea_feed(const char* data, size_t len) {
+    size_t parsed = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n') {
+            // Строки длиннее предела ядро все равно отбросит - не копируем их
+            if (!feed_overflow && feed_line_len > 0) {
+                if (feed_line[feed_line_len - 1] == '\r') feed_line_len--;
+                feed_line[feed_line_len] = '\0';
+                if (process_sentence(feed_line) != NMEA_SENTENCE_INVALID) parsed++;
+            }
+            feed_line_len = 0;
+            feed_overflow = 0;
+        } else if (feed_line_len < sizeof(feed_line) - 1) {
+            feed_line[feed_line_len++] = c;
+        } else {
+            feed_overflow = 1;
+        }
+    }
+    return parsed;
+}
+
+int ublox_nmea_snapshot(gps_data_t* out) {
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+    *out = current_gps_data;
+    return out->valid;
+}
+
+int ublox_nmea_feed_nav_sat(const uint8_t* frame, size_t len) {
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame, len, UBX_CLASS_NAV, UBX_NAV_SAT, &payload_len);
+    return payload ? ubx_nav_sat_decode(&sat_table, payload, payload_len) : -1;
+}
+
+const ubx_sat_table_t* ublox_nmea_satellites(void) {
+    return &sat_table;
+}
+
+int ublox_nmea_feed_tim_tp(const uint8_t* frame, size_t len) {
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame, len, UBX_CLASS_TIM, UBX_TIM_TP, &payload_len);
+    if (!payload) return -1;
+    if (timepulse.ns_per_tick == 0.0) timepulse_reset();
+    mp_uint_t state = MICROPY_BEGIN_ATOMIC_SECTION();
+    int result = ubx_tim_tp_decode(&timepulse, payload, payload_len);
+    MICROPY_END_ATOMIC_SECTION(state);
+    return result;
+}
+
+int ublox_nmea_feed_nav_timeutc(const uint8_t* frame, size_t len, int64_t* utc_ms) {
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame, len, UBX_CLASS_NAV, UBX_NAV_TIMEUTC, &payload_len);
+    if (!payload) return -1;
+    if (timepulse.ns_per_tick == 0.0) timepulse_reset();
+    mp_uint_t state = MICROPY_BEGIN_ATOMIC_SECTION();
+    int result = ubx_nav_timeutc_decode(&timepulse, payload, payload_len, utc_ms);
+    MICROPY_END_ATOMIC_SECTION(state);
+    return result;
+}
+
+void ublox_nmea_pps(mp_uint_t ticks_us) {
+    if (timepulse.ns_per_tick == 0.0) timepulse_reset();
+    ubx_timepulse_edge(&timepulse, ticks_us);
+}
+
+int ublox_nmea_pps_utc_ns(mp_uint_t ticks_us, int64_t* utc_ns) {
+    mp_uint_t state = MICROPY_BEGIN_ATOMIC_SECTION();
+    ubx_timepulse_t copy = timepulse;
+    MICROPY_END_ATOMIC_SECTION(state);
+    return ubx_timepulse_utc_ns(&copy, ticks_us, utc_ns);
+}
+
+int ublox_nmea_feed_mon_rf(const uint8_t* frame, size_t len) {
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame, len, UBX_CLASS_MON, UBX_MON_RF, &payload_len);
+    return payload ? nmea_rf_mon_rf(&rf_monitor, payload, payload_len) : -1;
+}
+
+int ublox_nmea_feed_mon_hw(const uint8_t* frame, size_t len) {
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame, len, UBX_CLASS_MON, UBX_MON_HW, &payload_len);
+    return payload ? nmea_rf_mon_hw(&rf_monitor, payload, payload_len) : -1;
+}
+
+const nmea_rf_t* ublox_nmea_rf(void) {
+    return &rf_monitor;
+}
+
+void ublox_nmea_set_rf_alert(nmea_rf_alert_t callback, void* context) {
+    MP_STATE_VM(ublox_nmea_rf_callback) = MP_OBJ_NULL;
+    rf_monitor.callback = callback;
+    rf_monitor.context = context;
+}
+
+int ublox_nmea_utc_from_ticks_ms(mp_uint_t ticks_ms, int64_t* utc_ms) {
+    double utc;
+    if (!nmea_clock_utc_ms(&clock_model, ticks_ms, &utc)) return 0;
+    *utc_ms = (int64_t)floor(utc + 0.5);
+    return 1;
+}
+
+void ublox_nmea_flush(void) {
+    // Время эпохи сохраняется: догоняющие предложения той же эпохи не открывают ее снова
+    if (epoch_open) {
+        notify_listeners(&current_gps_data);
+        // GSV этой эпохи уже пришли: статистика C/N0 закрывается здесь, а не следующим RMC/GGA
+        nmea_rf_epoch(&rf_monitor);
+        epoch_open = 0;
+    }
+}
+
+int ublox_nmea_add_listener(ublox_nmea_listener_t listener, void* context) {
+    if (listener == NULL || nmea_listener_count >= UBLOX_NMEA_MAX_LISTENERS) {
+        return 0;
+    }
+    nmea_listeners[nmea_listener_count].callback = listener;
+    nmea_listeners[nmea_listener_count].context = context;
+    nmea_listener_count++;
+    return 1;
+}
+
+int ublox_nmea_remove_listener(ublox_nmea_listener_t listener, void* context) {
+    for (uint8_t i = 0; i < nmea_listener_count; i++) {
+        if (nmea_listeners[i].callback == listener && nmea_listeners[i].context == context) {
+            for (uint8_t k = i + 1; k < nmea_listener_count; k++) {
+                nmea_listeners[k - 1] = nmea_listeners[k];
+            }
+            nmea_listener_count--;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+double ublox_nmea_distance(double lat1, double lon1, double lat2, double lon2) {
+    return calculate_distance_haversine(lat1, lon1, lat2, lon2);
+}
+
+void ublox_nmea_distance_bearing(double lat1, double lon1, double lat2, double lon2,
+                                 double* distance, double* bearing) {
+    point_trig_t a, b;
+    point_trig_set(&a, lat1, lon1);
+    point_trig_set(&b, lat2, lon2);
+    distance_bearing_trig(&a, &b, distance, bearing);
+}
+
+void ublox_nmea_destination(double lat, double lon, double distance, double bearing, double* lat2, double* lon2) {
+    point_trig_t a;
+    point_trig_set(&a, lat, lon);
+    destination_trig(&a, distance, bearing, lat2, lon2);
+}
+
+void ublox_nmea_midpoint(double lat1, double lon1, double lat2, double lon2, double* lat, double* lon) {
+    point_trig_t a, b;
+    point_trig_set(&a, lat1, lon1);
+    point_trig_set(&b, lat2, lon2);
+    midpoint_trig(&a, &b, lat, lon);
+}
+
+// save_state([history]) - снимок состояния для RTC-памяти или flash (bytes): текущий фикс,
+// начало ENU, если задано, и history последних записей истории (по умолчанию без истории)
+static mp_obj_t save_state(size_t n_args, const mp_obj_t *args) {
+    mp_int_t history = (n_args > 0) ? mp_obj_get_int(args[0]) : 0;
+    if (history < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("history must be >= 0"));
+    }
+    if (history > gps_history_count) {
+        history = gps_history_count;
+    }
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+
+    uint8_t flags = (enu_origin.set ? NMEA_STATE_ENU : 0) | (history > 0 ? NMEA_STATE_HISTORY : 0);
+    size_t capacity = NMEA_STATE_MIN_SIZE + NMEA_STATE_ENU_SIZE + 2 + history * NMEA_STATE_HISTORY_ENTRY_SIZE;
+    uint8_t* out = m_new(uint8_t, capacity);
+    uint8_t* p = out + nmea_state_begin(out, flags, &current_gps_data);
+
+    if (enu_origin.set) {
+        p = nmea_state_put_f64(p, enu_origin.latitude);
+        p = nmea_state_put_f64(p, enu_origin.longitude);
+        p = nmea_state_put_f64(p, enu_origin.altitude);
+    }
+    if (history > 0) {
+        p = nmea_state_put_u16(p, (uint16_t)history);
+        for (mp_int_t i = gps_history_count - history; i < gps_history_count; i++) {
+            const gps_history_entry_t* entry = &gps_history[(gps_history_head + i) % GPS_HISTORY_CAPACITY];
+            p = nmea_state_put_u64(p, (uint64_t)entry->utc_ms);
+            p = nmea_state_put_f64(p, entry->latitude);
+            p = nmea_state_put_f64(p, entry->longitude);
+        }
+    }
+
+    size_t len = nmea_state_finish(out, (size_t)(p - out));
+    mp_obj_t result = mp_obj_new_bytes(out, len);
+    m_del(uint8_t, out, capacity);
+    return result;
+}
+
+// load_state(blob) - восстановление снимка save_state(); секции, которых нет в снимке
+// (начало ENU, история), остаются как были
+static mp_obj_t load_state(mp_obj_t blob_in) {
+    mp_buffer_info_t blob;
+    mp_get_buffer_raise(blob_in, &blob, MP_BUFFER_READ);
+
+    uint8_t flags;
+    gps_data_t restored;
+    int offset = nmea_state_open(blob.buf, blob.len, &flags, &restored);
+    if (offset == NMEA_STATE_ERROR_VERSION) {
+        mp_raise_ValueError(MP_ERROR_TEXT("unsupported state version"));
+    }
+    if (offset < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid state blob"));
+    }
+
+    // Длины секций проверяются до изменения состояния
+    const uint8_t* data = blob.buf;
+    size_t end = blob.len - NMEA_STATE_CRC_SIZE;
+    size_t pos = offset;
+    size_t enu_pos = 0, history_pos = 0, history_len = 0;
+    if (flags & NMEA_STATE_ENU) {
+        enu_pos = pos;
+        pos += NMEA_STATE_ENU_SIZE;
+    }
+    if (flags & NMEA_STATE_HISTORY) {
+        if (pos + 2 > end) {
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid state blob"));
+        }
+        history_len = nmea_state_get_u16(data + pos);
+        history_pos = pos + 2;
+        pos = history_pos + history_len * NMEA_STATE_HISTORY_ENTRY_SIZE;
+    }
+    if (pos != end) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid state blob"));
+    }
+
+    nmea_state_reset();
+    current_gps_data = restored;
+    if (flags & NMEA_STATE_ENU) {
+        enu_origin_set(nmea_state_get_f64(data + enu_pos), nmea_state_get_f64(data + enu_pos + 8),
+                       nmea_state_get_f64(data + enu_pos + 16));
+    }
+    if (flags & NMEA_STATE_HISTORY) {
+        // Если снимок с большей емкостью - остаются последние записи
+        size_t skip = (history_len > GPS_HISTORY_CAPACITY) ? history_len - GPS_HISTORY_CAPACITY : 0;
+        gps_history_head = 0;
+        gps_history_count = 0;
+        for (size_t i = skip; i < history_len; i++) {
+            const uint8_t* p = data + history_pos + i * NMEA_STATE_HISTORY_ENTRY_SIZE;
+            gps_history_entry_t* entry = &gps_history[gps_history_count++];
+            entry->utc_ms = (int64_t)nmea_state_get_u64(p);
+            entry->latitude = nmea_state_get_f64(p + 8);
+            entry->longitude = nmea_state_get_f64(p + 16);
+        }
+    }
+    return mp_const_none;
+}
+
+// mga_ini(now_ms[, fix[, speed[, drift_ppm]]]) - UBX-MGA-INI-POS_LLH и MGA-INI-TIME_UTC для горячего
+// старта (bytes для записи в UART): последний фикс (текущее состояние, например после load_state(),
+// или словарь fix) и время RTC now_ms (UTC, мс от 1970-01-01). Точность позиции растет на speed м/с
+// (по умолчанию 1), времени - на drift_ppm (по умолчанию 50) от времени последнего фикса
+static mp_obj_t mga_ini(size_t n_args, const mp_obj_t *args) {
+    int64_t now_ms = (int64_t)get_uint64(args[0]);
+    gps_data_t gps_data;
+    fix_or_current(n_args > 1 ? args[1] : mp_const_none, &gps_data);
+
+    ubx_assist_config_t config;
+    ubx_assist_config_default(&config);
+    if (n_args > 2) {
+        config.speed_mps = mp_obj_get_float(args[2]);
+    }
+    if (n_args > 3) {
+        config.drift_ppm = mp_obj_get_float(args[3]);
+    }
+    if (!(config.speed_mps >= 0.0) || !(config.drift_ppm >= 0.0)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("speed and drift_ppm must be >= 0"));
+    }
+
+    uint8_t out[UBX_ASSIST_HOT_START_MAX];
+    size_t len = ubx_assist_hot_start(out, &gps_data, now_ms, &config);
+    return mp_obj_new_bytes(out, len);
+}
+
+// ttff_start() - отметка включения приемника (по умолчанию - загрузка); сбрасывает ttff()
+static mp_obj_t ttff_start(void) {
+    ttff_start_ticks = mp_hal_ticks_ms();
+    ttff_ms = -1;
+    return mp_const_none;
+}
+
+// ttff() - мс от отметки включения до первого предложения с фиксом или None
+static mp_obj_t ttff(void) {
+    return (ttff_ms < 0) ? mp_const_none : mp_obj_new_int(ttff_ms);
+}
+
+// nav_sat(frame) - кадр UBX-NAV-SAT целиком (B5 62 01 35 ...) в таблицу спутников; возвращает
+// число спутников в таблице
+static mp_obj_t nav_sat(mp_obj_t frame_in) {
+    mp_buffer_info_t frame;
+    mp_get_buffer_raise(frame_in, &frame, MP_BUFFER_READ);
+    int count = ublox_nmea_feed_nav_sat(frame.buf, frame.len);
+    if (count < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a valid UBX-NAV-SAT frame"));
+    }
+    return MP_OBJ_NEW_SMALL_INT(count);
+}
+
+// satellites() - словарь колонок таблицы спутников: memoryview без копирования (действительны до
+// следующего nav_sat(), длина - число спутников) и itow (мс недели GPS), dropped, epochs
+static mp_obj_t satellites(void) {
+    size_t n = sat_table.count;
+    static const struct { qstr name; char typecode; size_t offset; } columns[] = {
+        { MP_QSTR_gnss_id, 'B', offsetof(ubx_sat_table_t, gnss_id) },
+        { MP_QSTR_sv_id, 'B', offsetof(ubx_sat_table_t, sv_id) },
+        { MP_QSTR_cno, 'B', offsetof(ubx_sat_table_t, cno) },
+        { MP_QSTR_elevation, 'b', offsetof(ubx_sat_table_t, elevation) },
+        { MP_QSTR_azimuth, 'h', offsetof(ubx_sat_table_t, azimuth) },
+        { MP_QSTR_residual_dm, 'h', offsetof(ubx_sat_table_t, residual_dm) },
+        { MP_QSTR_flags, 'I', offsetof(ubx_sat_table_t, flags) },
+    };
+    mp_obj_t dict = mp_obj_new_dict(10);
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(columns[i].name),
+                          mp_obj_new_memoryview(columns[i].typecode, n, (uint8_t*)&sat_table + columns[i].offset));
+    }
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_itow), mp_obj_new_int_from_uint(sat_table.itow_ms));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dropped), MP_OBJ_NEW_SMALL_INT(sat_table.dropped));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_epochs), mp_obj_new_int_from_uint(sat_table.epochs));
+    return dict;
+}
+
+// tim_tp(frame) - кадр UBX-TIM-TP: метка и ошибка квантования следующего импульса PPS
+// (шкала времени импульса - UTC или GPS)
+static mp_obj_t tim_tp(mp_obj_t frame_in) {
+    mp_buffer_info_t frame;
+    mp_get_buffer_raise(frame_in, &frame, MP_BUFFER_READ);
+    if (ublox_nmea_feed_tim_tp(frame.buf, frame.len) < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a valid UBX-TIM-TP frame in UTC or GPS time base"));
+    }
+    return mp_const_none;
+}
+
+// nav_timeutc(frame) - кадр UBX-NAV-TIMEUTC: секунды координации и точность для PPS;
+// возвращает UTC эпохи (мс от 1970-01-01) или None, если время UTC еще не действительно
+static mp_obj_t nav_timeutc(mp_obj_t frame_in) {
+    mp_buffer_info_t frame;
+    mp_get_buffer_raise(frame_in, &frame, MP_BUFFER_READ);
+    int64_t utc_ms;
+    int result = ublox_nmea_feed_nav_timeutc(frame.buf, frame.len, &utc_ms);
+    if (result < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a valid UBX-NAV-TIMEUTC frame"));
+    }
+    return result ? mp_obj_new_int_from_ll(utc_ms) : mp_const_none;
+}
+
+// pps(ticks_us) - фронт PPS (time.ticks_us() из обработчика прерывания вывода); без выделения
+// памяти, подходит для hard IRQ
+static mp_obj_t pps(mp_obj_t ticks_in) {
+    ublox_nmea_pps((mp_uint_t)mp_obj_get_int_truncated(ticks_in));
+    return mp_const_none;
+}
+
+// pps_utc(ticks_us) - UTC момента ticks_us в нс от 1970-01-01 или None до первого импульса с меткой
+static mp_obj_t pps_utc(mp_obj_t ticks_in) {
+    int64_t utc_ns;
+    if (!ublox_nmea_pps_utc_ns((mp_uint_t)mp_obj_get_int_truncated(ticks_in), &utc_ns)) {
+        return mp_const_none;
+    }
+    return mp_obj_new_int_from_ll(utc_ns);
+}
+
+// pps_status() - (импульсов, отброшено, уход локальных часов ppm (+ - спешат), qErr пс последнего импульса,
+// точность приемника нс, секунды координации)
+static mp_obj_t pps_status(void) {
+    mp_uint_t state = MICROPY_BEGIN_ATOMIC_SECTION();
+    ubx_timepulse_t tp = timepulse;
+    MICROPY_END_ATOMIC_SECTION(state);
+    mp_float_t drift = (tp.rate > 0.0) ? (tp.ns_per_tick / tp.rate - 1.0) * 1e6 : 0.0;
+    mp_obj_t items[6] = {
+        mp_obj_new_int_from_uint(tp.pulses),
+        mp_obj_new_int_from_uint(tp.rejected),
+        mp_obj_new_float(drift),
+        mp_obj_new_int(tp.qerr_ps),
+        mp_obj_new_int_from_uint(tp.t_acc_ns),
+        mp_obj_new_int(tp.leap_seconds),
+    };
+    return mp_obj_new_tuple(6, items);
+}
+
+// clock_sample(ticks_ms, utc_ms) - своя пара (тики, UTC) для модели часов (например, по приходу
+// UBX-NAV-PVT); RMC с фиксом добавляются parse() сами. True - принята, False - выброс
+static mp_obj_t clock_sample(mp_obj_t ticks_in, mp_obj_t utc_in) {
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+    mp_uint_t ticks = (mp_uint_t)mp_obj_get_int_truncated(ticks_in);
+    return mp_obj_new_bool(nmea_clock_add(&clock_model, ticks, (int64_t)get_uint64(utc_in)));
+}
+
+// utc_from_ticks(ticks_ms) - UTC (мс от 1970-01-01) момента time.ticks_ms() или None до первой пары
+static mp_obj_t utc_from_ticks(mp_obj_t ticks_in) {
+    int64_t utc_ms;
+    if (!ublox_nmea_utc_from_ticks_ms((mp_uint_t)mp_obj_get_int_truncated(ticks_in), &utc_ms)) {
+        return mp_const_none;
+    }
+    return mp_obj_new_int_from_ll(utc_ms);
+}
+
+// utc_from_ticks_batch(ticks, out) - ticks: array('I') / array('L') / array('i') / array('l') /
+// array('q'); out: array('q') (мс) или array('d') (мс с долями); возвращает число значений
+static mp_obj_t utc_from_ticks_batch(mp_obj_t ticks_in, mp_obj_t out_in) {
+    mp_buffer_info_t ticks_buf, out_buf;
+    mp_get_buffer_raise(ticks_in, &ticks_buf, MP_BUFFER_READ);
+    mp_get_buffer_raise(out_in, &out_buf, MP_BUFFER_WRITE);
+    if (!buffer_is_int32(&ticks_buf) && ticks_buf.typecode != 'q' && ticks_buf.typecode != 'Q' &&
+        ticks_buf.typecode != 'l' && ticks_buf.typecode != 'L') {
+        mp_raise_TypeError(MP_ERROR_TEXT("ticks must be a 32- or 64-bit integer array"));
+    }
+    if (out_buf.typecode != 'q' && out_buf.typecode != 'd') {
+        mp_raise_TypeError(MP_ERROR_TEXT("out must be array('q') or array('d')"));
+    }
+    size_t count = buffer_item_count(&ticks_buf);
+    if (buffer_item_count(&out_buf) < count) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffers must have the same length"));
+    }
+    if (!clock_model.valid) {
+        mp_raise_ValueError(MP_ERROR_TEXT("no clock model yet"));
+    }
+
+    int wide = buffer_item_size(&ticks_buf) == 8;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t ticks = wide ? ((const uint64_t*)ticks_buf.buf)[i] : ((const uint32_t*)ticks_buf.buf)[i];
+        double utc;
+        nmea_clock_utc_ms(&clock_model, ticks, &utc);
+        if (out_buf.typecode == 'q') {
+            ((int64_t*)out_buf.buf)[i] = (int64_t)floor(utc + 0.5);
+        } else {
+            ((double*)out_buf.buf)[i] = utc;
+        }
+    }
+    return mp_obj_new_int(count);
+}
+
+// clock_status() - (принято пар, отброшено, уход часов ppm (+ - спешат), СКО невязок мс, пар в окне)
+static mp_obj_t clock_status(void) {
+    mp_obj_t items[5] = {
+        mp_obj_new_int_from_uint(clock_model.samples),
+        mp_obj_new_int_from_uint(clock_model.rejected),
+        mp_obj_new_float(clock_model.valid ? nmea_clock_drift_ppm(&clock_model) : 0.0),
+        mp_obj_new_float(clock_model.rms_ms),
+        MP_OBJ_NEW_SMALL_INT(clock_model.count),
+    };
+    return mp_obj_new_tuple(5, items);
+}
+
+// mon_rf(frame) / mon_hw(frame) - кадр UBX-MON-RF / UBX-MON-HW целиком: помехи, AGC, шум, антенна
+static mp_obj_t mon_rf(mp_obj_t frame_in) {
+    mp_buffer_info_t frame;
+    mp_get_buffer_raise(frame_in, &frame, MP_BUFFER_READ);
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+    if (ublox_nmea_feed_mon_rf(frame.buf, frame.len) < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a valid UBX-MON-RF frame"));
+    }
+    return mp_const_none;
+}
+
+static mp_obj_t mon_hw(mp_obj_t frame_in) {
+    mp_buffer_info_t frame;
+    mp_get_buffer_raise(frame_in, &frame, MP_BUFFER_READ);
+    if (!gps_data_initialized) {
+        nmea_state_reset();
+    }
+    if (ublox_nmea_feed_mon_hw(frame.buf, frame.len) < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a valid UBX-MON-HW frame"));
+    }
+    return mp_const_none;
+}
+
+// rf_status() - (тревоги RF_*, jammingState, jamInd, antStatus, antPower, noisePerMS, agcCnt,
+// кадров MON, эпох C/N0)
+static mp_obj_t rf_status(void) {
+    mp_obj_t items[9] = {
+        mp_obj_new_int_from_uint(rf_monitor.alerts),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.jamming_state),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.jam_ind),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.antenna_status),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.antenna_power),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.noise_per_ms),
+        MP_OBJ_NEW_SMALL_INT(rf_monitor.agc_cnt),
+        mp_obj_new_int_from_uint(rf_monitor.hw_messages),
+        mp_obj_new_int_from_uint(rf_monitor.epochs),
+    };
+    return mp_obj_new_tuple(9, items);
+}
+
+// cno_stats([system]) - статистика C/N0 последней эпохи: (сигналов, среднее, мин, макс, скользящее
+// среднее, гистограмма memoryview('H') по 5 дБГц без копирования) для system 0..4 (GPS, ГЛОНАСС,
+// Galileo, BeiDou, прочие) или кортеж таких по всем системам
+static mp_obj_t cno_system_tuple(int system) {
+    nmea_rf_cno_t* cno = &rf_monitor.cno[system];
+    mp_obj_t items[6] = {
+        MP_OBJ_NEW_SMALL_INT(cno->count),
+        mp_obj_new_float(cno->mean),
+        MP_OBJ_NEW_SMALL_INT(cno->min),
+        MP_OBJ_NEW_SMALL_INT(cno->max),
+        mp_obj_new_float(cno->rolling_mean),
+        mp_obj_new_memoryview('H', NMEA_RF_HIST_BINS, cno->hist),
+    };
+    return mp_obj_new_tuple(6, items);
+}
+
+static mp_obj_t cno_stats(size_t n_args, const mp_obj_t* args) {
+    if (n_args > 0) {
+        mp_int_t system = mp_obj_get_int(args[0]);
+        if (system < 0 || system >= NMEA_RF_SYSTEMS) {
+            mp_raise_ValueError(MP_ERROR_TEXT("system must be 0..4"));
+        }
+        return cno_system_tuple(system);
+    }
+    mp_obj_t items[NMEA_RF_SYSTEMS];
+    for (int system = 0; system < NMEA_RF_SYSTEMS; system++) {
+        items[system] = cno_system_tuple(system);
+    }
+    return mp_obj_new_tuple(NMEA_RF_SYSTEMS, items);
+}
+
+// Вызов обработчика Python: только при смене набора тревог, поэтому в штатном потоке стоит
+// одно сравнение на эпоху
+static void rf_alert_python(uint32_t alerts, uint32_t changed, void* context) {
+    mp_obj_t callback = MP_STATE_VM(ublox_nmea_rf_callback);
+    if (callback != MP_OBJ_NULL) {
+        mp_call_function_2(callback, mp_obj_new_int_from_uint(alerts), mp_obj_new_int_from_uint(changed));
+    }
+}
+
+// rf_alerts(callback[, jam_ind[, cno_min[, cno_drop]]]) - callback(alerts, changed) при смене набора
+// тревог RF_*; None - отключить. Пороги: jamInd (0 - только jammingState), средний C/N0 эпохи
+// ниже cno_min дБГц, падение на cno_drop дБ от скользящего среднего
+static mp_obj_t rf_alerts(size_t n_args, const mp_obj_t* args) {
+    if (args[0] != mp_const_none && !mp_obj_is_callable(args[0])) {
+        mp_raise_TypeError(MP_ERROR_TEXT("callback must be callable or None"));
+    }
+    if (n_args > 1) {
+        mp_int_t jam_ind = mp_obj_get_int(args[1]);
+        if (jam_ind < 0 || jam_ind > 255) {
+            mp_raise_ValueError(MP_ERROR_TEXT("jam_ind must be 0..255"));
+        }
+        rf_monitor.jam_ind_max = (uint8_t)jam_ind;
+    }
+    if (n_args > 2) rf_monitor.cno_min = (float)mp_obj_get_float(args[2]);
+    if (n_args > 3) rf_monitor.cno_drop = (float)mp_obj_get_float(args[3]);
+
+    if (args[0] == mp_const_none) {
+        MP_STATE_VM(ublox_nmea_rf_callback) = MP_OBJ_NULL;
+        rf_monitor.callback = NULL;
+    } else {
+        MP_STATE_VM(ublox_nmea_rf_callback) = args[0];
+        rf_monitor.callback = rf_alert_python;
+        rf_monitor.context = NULL;
+    }
+    return mp_const_none;
+}
+
+// Основная функция парсинга NMEA строк
+static mp_obj_t parse_nmea_string(mp_obj_t string_obj) {
+    const char* nmea_string = mp_obj_str_get_str(string_obj);
+
+    if (process_sentence(nmea_string) == NMEA_SENTENCE_INVALID) {
+        return mp_const_none;
+    }
+
+    return create_gps_dict_from_data(&current_gps_data);
+}
+
+// Функция сброса данных
+static mp_obj_t reset_gps_data(void) {
+    nmea_state_reset();
     return mp_const_none;
 }
 
@@ -721,16 +4467,140 @@ static mp_obj_t get_current(void) {
 // Определение функций для модуля
 MP_DEFINE_CONST_FUN_OBJ_1(parse_nmea_string_obj, parse_nmea_string);
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(calculate_distance_obj, 1, 2, calculate_distance);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(distance_bearing_obj, 1, 2, distance_bearing);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(destination_obj, 2, 3, destination);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(midpoint_obj, 1, 2, midpoint);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(distance_bearing_batch_obj, 4, 5, distance_bearing_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(destination_batch_obj, 4, 5, destination_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(distance_matrix_obj, 5, 5, distance_matrix);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(pairs_within_obj, 6, 7, pairs_within);
 MP_DEFINE_CONST_FUN_OBJ_0(reset_gps_data_obj, reset_gps_data);
 MP_DEFINE_CONST_FUN_OBJ_0(get_current_obj, get_current);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(save_state_obj, 0, 1, save_state);
+MP_DEFINE_CONST_FUN_OBJ_1(load_state_obj, load_state);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mga_ini_obj, 1, 4, mga_ini);
+MP_DEFINE_CONST_FUN_OBJ_0(ttff_start_obj, ttff_start);
+MP_DEFINE_CONST_FUN_OBJ_0(ttff_obj, ttff);
+MP_DEFINE_CONST_FUN_OBJ_1(nav_sat_obj, nav_sat);
+MP_DEFINE_CONST_FUN_OBJ_0(satellites_obj, satellites);
+MP_DEFINE_CONST_FUN_OBJ_1(tim_tp_obj, tim_tp);
+MP_DEFINE_CONST_FUN_OBJ_1(nav_timeutc_obj, nav_timeutc);
+MP_DEFINE_CONST_FUN_OBJ_1(pps_obj, pps);
+MP_DEFINE_CONST_FUN_OBJ_1(pps_utc_obj, pps_utc);
+MP_DEFINE_CONST_FUN_OBJ_0(pps_status_obj, pps_status);
+MP_DEFINE_CONST_FUN_OBJ_2(clock_sample_obj, clock_sample);
+MP_DEFINE_CONST_FUN_OBJ_1(utc_from_ticks_obj, utc_from_ticks);
+MP_DEFINE_CONST_FUN_OBJ_2(utc_from_ticks_batch_obj, utc_from_ticks_batch);
+MP_DEFINE_CONST_FUN_OBJ_0(clock_status_obj, clock_status);
+MP_DEFINE_CONST_FUN_OBJ_1(mon_rf_obj, mon_rf);
+MP_DEFINE_CONST_FUN_OBJ_1(mon_hw_obj, mon_hw);
+MP_DEFINE_CONST_FUN_OBJ_0(rf_status_obj, rf_status);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(cno_stats_obj, 0, 1, cno_stats);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rf_alerts_obj, 1, 4, rf_alerts);
+MP_DEFINE_CONST_FUN_OBJ_1(parse_file_obj, parse_file);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(build_index_obj, 1, 3, build_index);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(read_range_obj, 3, 4, read_range);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(encode_obj, 1, 3, encode);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(encode_into_obj, 2, 4, encode_into);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(position_at_obj, 1, 2, position_at);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(positions_at_obj, 3, 4, positions_at);
+MP_DEFINE_CONST_FUN_OBJ_0(history_len_obj, history_len);
+MP_DEFINE_CONST_FUN_OBJ_0(history_clear_obj, history_clear);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(geohash_encode_obj, 0, 3, geohash_encode);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(geohash_int_obj, 0, 3, geohash_int);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(geohash_decode_obj, 1, 2, geohash_decode);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(geohash_neighbours_obj, 1, 2, geohash_neighbours);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(geohash_batch_obj, 3, 4, geohash_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tile_xy_obj, 1, 3, tile_xy);
+MP_DEFINE_CONST_FUN_OBJ_VAR(tile_xy_batch_obj, 5, tile_xy_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(polyline_decode_obj, 3, 4, polyline_decode);
+MP_DEFINE_CONST_FUN_OBJ_1(polyline_count_obj, polyline_count);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_ecef_obj, 0, 3, to_ecef);
+MP_DEFINE_CONST_FUN_OBJ_3(from_ecef_obj, from_ecef);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(set_enu_origin_obj, 0, 3, set_enu_origin);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_enu_obj, 0, 3, to_enu);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_utm_obj, 0, 3, to_utm);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(from_utm_obj, 4, 4, from_utm);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_ecef_batch_obj, 6, 6, to_ecef_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_enu_batch_obj, 6, 6, to_enu_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(to_utm_batch_obj, 4, 5, to_utm_batch);
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(from_utm_batch_obj, 6, 6, from_utm_batch);
 
 // Определение модуля
 static const mp_rom_map_elem_t ublox_nmea_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ublox_nmea) },
     { MP_ROM_QSTR(MP_QSTR_parse), MP_ROM_PTR(&parse_nmea_string_obj) },
     { MP_ROM_QSTR(MP_QSTR_calculate_distance), MP_ROM_PTR(&calculate_distance_obj) },
+    { MP_ROM_QSTR(MP_QSTR_distance_bearing), MP_ROM_PTR(&distance_bearing_obj) },
+    { MP_ROM_QSTR(MP_QSTR_destination), MP_ROM_PTR(&destination_obj) },
+    { MP_ROM_QSTR(MP_QSTR_midpoint), MP_ROM_PTR(&midpoint_obj) },
+    { MP_ROM_QSTR(MP_QSTR_distance_bearing_batch), MP_ROM_PTR(&distance_bearing_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_destination_batch), MP_ROM_PTR(&destination_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_distance_matrix), MP_ROM_PTR(&distance_matrix_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pairs_within), MP_ROM_PTR(&pairs_within_obj) },
     { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&reset_gps_data_obj) },
     { MP_ROM_QSTR(MP_QSTR_current), MP_ROM_PTR(&get_current_obj) },
+    { MP_ROM_QSTR(MP_QSTR_save_state), MP_ROM_PTR(&save_state_obj) },
+    { MP_ROM_QSTR(MP_QSTR_load_state), MP_ROM_PTR(&load_state_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mga_ini), MP_ROM_PTR(&mga_ini_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ttff_start), MP_ROM_PTR(&ttff_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ttff), MP_ROM_PTR(&ttff_obj) },
+    { MP_ROM_QSTR(MP_QSTR_nav_sat), MP_ROM_PTR(&nav_sat_obj) },
+    { MP_ROM_QSTR(MP_QSTR_satellites), MP_ROM_PTR(&satellites_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tim_tp), MP_ROM_PTR(&tim_tp_obj) },
+    { MP_ROM_QSTR(MP_QSTR_nav_timeutc), MP_ROM_PTR(&nav_timeutc_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pps), MP_ROM_PTR(&pps_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pps_utc), MP_ROM_PTR(&pps_utc_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pps_status), MP_ROM_PTR(&pps_status_obj) },
+    { MP_ROM_QSTR(MP_QSTR_clock_sample), MP_ROM_PTR(&clock_sample_obj) },
+    { MP_ROM_QSTR(MP_QSTR_utc_from_ticks), MP_ROM_PTR(&utc_from_ticks_obj) },
+    { MP_ROM_QSTR(MP_QSTR_utc_from_ticks_batch), MP_ROM_PTR(&utc_from_ticks_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_clock_status), MP_ROM_PTR(&clock_status_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mon_rf), MP_ROM_PTR(&mon_rf_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mon_hw), MP_ROM_PTR(&mon_hw_obj) },
+    { MP_ROM_QSTR(MP_QSTR_rf_status), MP_ROM_PTR(&rf_status_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cno_stats), MP_ROM_PTR(&cno_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_rf_alerts), MP_ROM_PTR(&rf_alerts_obj) },
+    { MP_ROM_QSTR(MP_QSTR_RF_JAMMING), MP_ROM_INT(NMEA_RF_ALERT_JAMMING) },
+    { MP_ROM_QSTR(MP_QSTR_RF_ANTENNA), MP_ROM_INT(NMEA_RF_ALERT_ANTENNA) },
+    { MP_ROM_QSTR(MP_QSTR_RF_CNO_LOW), MP_ROM_INT(NMEA_RF_ALERT_CNO_LOW) },
+    { MP_ROM_QSTR(MP_QSTR_RF_CNO_DROP), MP_ROM_INT(NMEA_RF_ALERT_CNO_DROP) },
+    { MP_ROM_QSTR(MP_QSTR_parse_file), MP_ROM_PTR(&parse_file_obj) },
+    { MP_ROM_QSTR(MP_QSTR_build_index), MP_ROM_PTR(&build_index_obj) },
+    { MP_ROM_QSTR(MP_QSTR_read_range), MP_ROM_PTR(&read_range_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Multiplexer), MP_ROM_PTR(&multiplexer_type) },
+    { MP_ROM_QSTR(MP_QSTR_Generator), MP_ROM_PTR(&generator_type) },
+    { MP_ROM_QSTR(MP_QSTR_encode), MP_ROM_PTR(&encode_obj) },
+    { MP_ROM_QSTR(MP_QSTR_encode_into), MP_ROM_PTR(&encode_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Router), MP_ROM_PTR(&router_type) },
+    { MP_ROM_QSTR(MP_QSTR_Packer), MP_ROM_PTR(&packer_type) },
+    { MP_ROM_QSTR(MP_QSTR_AssistUploader), MP_ROM_PTR(&assist_uploader_type) },
+    { MP_ROM_QSTR(MP_QSTR_UbxCapture), MP_ROM_PTR(&ubx_capture_type) },
+    { MP_ROM_QSTR(MP_QSTR_position_at), MP_ROM_PTR(&position_at_obj) },
+    { MP_ROM_QSTR(MP_QSTR_positions_at), MP_ROM_PTR(&positions_at_obj) },
+    { MP_ROM_QSTR(MP_QSTR_history_len), MP_ROM_PTR(&history_len_obj) },
+    { MP_ROM_QSTR(MP_QSTR_history_clear), MP_ROM_PTR(&history_clear_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Route), MP_ROM_PTR(&route_type) },
+    { MP_ROM_QSTR(MP_QSTR_geohash_encode), MP_ROM_PTR(&geohash_encode_obj) },
+    { MP_ROM_QSTR(MP_QSTR_geohash_int), MP_ROM_PTR(&geohash_int_obj) },
+    { MP_ROM_QSTR(MP_QSTR_geohash_decode), MP_ROM_PTR(&geohash_decode_obj) },
+    { MP_ROM_QSTR(MP_QSTR_geohash_neighbours), MP_ROM_PTR(&geohash_neighbours_obj) },
+    { MP_ROM_QSTR(MP_QSTR_geohash_batch), MP_ROM_PTR(&geohash_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tile_xy), MP_ROM_PTR(&tile_xy_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tile_xy_batch), MP_ROM_PTR(&tile_xy_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_PolylineEncoder), MP_ROM_PTR(&polyline_encoder_type) },
+    { MP_ROM_QSTR(MP_QSTR_polyline_decode), MP_ROM_PTR(&polyline_decode_obj) },
+    { MP_ROM_QSTR(MP_QSTR_polyline_count), MP_ROM_PTR(&polyline_count_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_ecef), MP_ROM_PTR(&to_ecef_obj) },
+    { MP_ROM_QSTR(MP_QSTR_from_ecef), MP_ROM_PTR(&from_ecef_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_enu_origin), MP_ROM_PTR(&set_enu_origin_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_enu), MP_ROM_PTR(&to_enu_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_utm), MP_ROM_PTR(&to_utm_obj) },
+    { MP_ROM_QSTR(MP_QSTR_from_utm), MP_ROM_PTR(&from_utm_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_ecef_batch), MP_ROM_PTR(&to_ecef_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_enu_batch), MP_ROM_PTR(&to_enu_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_to_utm_batch), MP_ROM_PTR(&to_utm_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_from_utm_batch), MP_ROM_PTR(&from_utm_batch_obj) },
 };
 
 static MP_DEFINE_CONST_DICT(ublox_nmea_globals, ublox_nmea_globals_table);
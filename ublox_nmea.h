@@ -4,36 +4,81 @@
 #include "py/obj.h"
 #include "py/runtime.h"
 #include <math.h>
+#include "ublox_nmea_core.h"
+#include "ublox_nmea_ubx.h"
+#include "ublox_nmea_rf.h"
 
-// Структура для хранения GPS данных
-typedef struct {
-    double latitude;
-    double longitude;
-    double altitude;
-    double speed;
-    double course;
-    uint8_t satellites_used;
-    uint8_t satellites_visible;
-    uint8_t fix_type;
-    double hdop;
-    double vdop;
-    double pdop;
-    double accuracy;  // точность в метрах
-    uint16_t year;
-    uint8_t month;
-    uint8_t day;
-    uint8_t hour;
-    uint8_t minute;
-    uint8_t second;
-    uint8_t valid;
-    uint8_t has_gga;
-    uint8_t has_gsa;
-    uint8_t has_gsv;
-    uint8_t has_vtg;
-    uint8_t has_satellites_used;
-    uint8_t has_satellites_visible;
-    uint8_t has_accuracy;
-    char timestamp[25]; // Формат: "2024-01-15T14:30:45Z" + null terminator
-} gps_data_t;
-
-#endif
\ No newline at end of file
+// Публичный C API модуля для других нативных модулей той же прошивки (слияние с IMU,
+// упаковка для LoRa): фиксы и расчеты без объектов Python. Состояние общее с parse()
+#define UBLOX_NMEA_API_VERSION 1
+
+// Число подписчиков на эпохи (можно переопределить через CFLAGS)
+#ifndef UBLOX_NMEA_MAX_LISTENERS
+#define UBLOX_NMEA_MAX_LISTENERS 4
+#endif
+
+// Подписчик получает состояние завершенной эпохи (группа предложений с одним временем UTC):
+// эпоха закрывается первым RMC/GGA с новым временем или ublox_nmea_flush().
+// Вызывается синхронно из разбора; из подписчика нельзя подавать данные в парсер
+typedef void (*ublox_nmea_listener_t)(const gps_data_t* fix, void* context);
+
+// Сброс состояния парсера (как reset())
+void ublox_nmea_init(void);
+
+// Одно предложение (нуль-терминированное, как parse()); возвращает его тип
+nmea_sentence_t ublox_nmea_feed_sentence(const char* sentence);
+
+// Поток байт от приемника: строки собираются между вызовами; возвращает число
+// разобранных предложений с верной контрольной суммой
+size_t ublox_nmea_feed(const char* data, size_t len);
+
+// Копия текущего состояния; возвращает признак валидного фикса
+int ublox_nmea_snapshot(gps_data_t* out);
+
+// Закрытие текущей эпохи без ожидания следующей (например, по паузе UART)
+void ublox_nmea_flush(void);
+
+// Кадр UBX-NAV-SAT целиком в таблицу спутников (как nav_sat()); число спутников или -1
+int ublox_nmea_feed_nav_sat(const uint8_t* frame, size_t len);
+
+// Таблица спутников последнего NAV-SAT (колонки читаются напрямую, до следующего кадра)
+const ubx_sat_table_t* ublox_nmea_satellites(void);
+
+// Передача времени по PPS: кадры UBX-TIM-TP (метка следующего импульса) и UBX-NAV-TIMEUTC
+// (секунды координации, точность); 0 / 1 - принят (NAV-TIMEUTC: 1 - *utc_ms действительно), -1 - нет
+int ublox_nmea_feed_tim_tp(const uint8_t* frame, size_t len);
+int ublox_nmea_feed_nav_timeutc(const uint8_t* frame, size_t len, int64_t* utc_ms);
+
+// Фронт PPS в тиках mp_hal_ticks_us(); можно вызывать из обработчика прерывания
+void ublox_nmea_pps(mp_uint_t ticks_us);
+
+// UTC (нс от 1970-01-01) момента ticks_us; 0, если импульсов с меткой еще не было
+int ublox_nmea_pps_utc_ns(mp_uint_t ticks_us, int64_t* utc_ns);
+
+// UTC (мс от 1970-01-01) момента ticks_ms (mp_hal_ticks_ms()) по модели часов, обновляемой
+// приходом RMC с фиксом; 0, если модели еще нет
+int ublox_nmea_utc_from_ticks_ms(mp_uint_t ticks_ms, int64_t* utc_ms);
+
+// Контроль радиотракта: кадры UBX-MON-RF / UBX-MON-HW целиком (0 или -1), состояние с
+// статистикой C/N0 по GSV (обновляется на границе эпохи разбора)
+int ublox_nmea_feed_mon_rf(const uint8_t* frame, size_t len);
+int ublox_nmea_feed_mon_hw(const uint8_t* frame, size_t len);
+const nmea_rf_t* ublox_nmea_rf(void);
+
+// Обработчик смены набора тревог NMEA_RF_ALERT_* (заменяет заданный из rf_alerts(); NULL - нет)
+void ublox_nmea_set_rf_alert(nmea_rf_alert_t callback, void* context);
+
+// Регистрация подписчика; 0, если все UBLOX_NMEA_MAX_LISTENERS мест заняты
+int ublox_nmea_add_listener(ublox_nmea_listener_t listener, void* context);
+
+// Удаление подписчика с той же парой (listener, context); 0, если не найден
+int ublox_nmea_remove_listener(ublox_nmea_listener_t listener, void* context);
+
+// Расчеты на сфере (градусы, метры): те же ядра, что у distance_bearing() / destination() / midpoint()
+double ublox_nmea_distance(double lat1, double lon1, double lat2, double lon2);
+void ublox_nmea_distance_bearing(double lat1, double lon1, double lat2, double lon2,
+                                 double* distance, double* bearing);
+void ublox_nmea_destination(double lat, double lon, double distance, double bearing, double* lat2, double* lon2);
+void ublox_nmea_midpoint(double lat1, double lon1, double lat2, double lon2, double* lat, double* lon);
+
+#endif
@@ -0,0 +1,112 @@
+#include "ublox_nmea_clock.h"
+#include <math.h>
+#include <string.h>
+
+void nmea_clock_init(nmea_clock_t* clock, uint64_t ticks_mask) {
+    memset(clock, 0, sizeof(*clock));
+    clock->ticks_mask = ticks_mask;
+    clock->slope = 1.0;
+}
+
+// Разность тиков a - b по модулю периода счетчика (со знаком)
+static int64_t clock_ticks_diff(const nmea_clock_t* clock, uint64_t a, uint64_t b) {
+    uint64_t diff = (a - b) & clock->ticks_mask;
+    return (diff > (clock->ticks_mask >> 1)) ? -(int64_t)((clock->ticks_mask - diff) + 1) : (int64_t)diff;
+}
+
+static inline size_t clock_slot(const nmea_clock_t* clock, size_t i) {
+    return (clock->head + NMEA_CLOCK_WINDOW - clock->count + i) % NMEA_CLOCK_WINDOW;
+}
+
+// Наименьшие квадраты по парам окна относительно опорной (самой новой); пары с невязкой больше
+// limit к предыдущей модели не участвуют (limit <= 0 - все)
+static void clock_fit(nmea_clock_t* clock, double limit) {
+    double sum_x = 0.0, sum_y = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < clock->count; i++) {
+        size_t k = clock_slot(clock, i);
+        double x = (double)clock_ticks_diff(clock, clock->ticks[k], clock->ref_ticks);
+        double y = (double)(clock->utc_ms[k] - clock->ref_utc_ms);
+        if (limit > 0.0 && fabs(y - (clock->offset_ms + clock->slope * x)) > limit) continue;
+        sum_x += x;
+        sum_y += y;
+        n++;
+    }
+    if (n == 0) return;
+    double mean_x = sum_x / n, mean_y = sum_y / n;
+
+    double sxx = 0.0, sxy = 0.0;
+    for (size_t i = 0; i < clock->count; i++) {
+        size_t k = clock_slot(clock, i);
+        double x = (double)clock_ticks_diff(clock, clock->ticks[k], clock->ref_ticks);
+        double y = (double)(clock->utc_ms[k] - clock->ref_utc_ms);
+        if (limit > 0.0 && fabs(y - (clock->offset_ms + clock->slope * x)) > limit) continue;
+        sxx += (x - mean_x) * (x - mean_x);
+        sxy += (x - mean_x) * (y - mean_y);
+    }
+    // Наклон по короткому окну неустойчив: номинал, пока разброс тиков меньше секунды
+    double slope = (sxx > 1e6 && n >= 3) ? sxy / sxx : 1.0;
+    double offset = mean_y - slope * mean_x;
+
+    double sum_r2 = 0.0;
+    for (size_t i = 0; i < clock->count; i++) {
+        size_t k = clock_slot(clock, i);
+        double x = (double)clock_ticks_diff(clock, clock->ticks[k], clock->ref_ticks);
+        double y = (double)(clock->utc_ms[k] - clock->ref_utc_ms);
+        if (limit > 0.0 && fabs(y - (clock->offset_ms + clock->slope * x)) > limit) continue;
+        double r = y - (offset + slope * x);
+        sum_r2 += r * r;
+    }
+    clock->slope = slope;
+    clock->offset_ms = offset;
+    clock->rms_ms = sqrt(sum_r2 / n);
+    clock->valid = 1;
+}
+
+static double clock_outlier_limit(const nmea_clock_t* clock) {
+    double limit = NMEA_CLOCK_OUTLIER_SIGMA * clock->rms_ms;
+    return (limit > NMEA_CLOCK_OUTLIER_MIN_MS) ? limit : NMEA_CLOCK_OUTLIER_MIN_MS;
+}
+
+int nmea_clock_add(nmea_clock_t* clock, uint64_t ticks, int64_t utc_ms) {
+    // Проверка новой пары по текущей модели (после нескольких пар)
+    if (clock->valid && clock->count >= 4) {
+        double predicted;
+        nmea_clock_utc_ms(clock, ticks, &predicted);
+        if (fabs((double)utc_ms - predicted) > clock_outlier_limit(clock)) {
+            clock->rejected++;
+            if (++clock->misses < NMEA_CLOCK_MAX_MISSES) return 0;
+            // Несколько выбросов подряд - часы или UTC скачком сменились: окно заново
+            uint64_t mask = clock->ticks_mask;
+            uint32_t samples = clock->samples, rejected = clock->rejected;
+            nmea_clock_init(clock, mask);
+            clock->samples = samples;
+            clock->rejected = rejected;
+        }
+    }
+    clock->misses = 0;
+
+    clock->ticks[clock->head] = ticks;
+    clock->utc_ms[clock->head] = utc_ms;
+    clock->head = (clock->head + 1) % NMEA_CLOCK_WINDOW;
+    if (clock->count < NMEA_CLOCK_WINDOW) clock->count++;
+    clock->ref_ticks = ticks;
+    clock->ref_utc_ms = utc_ms;
+    clock->samples++;
+
+    // Первый проход - по всем парам окна, второй - без выбросов первого
+    clock_fit(clock, 0.0);
+    clock_fit(clock, clock_outlier_limit(clock));
+    return 1;
+}
+
+int nmea_clock_utc_ms(const nmea_clock_t* clock, uint64_t ticks, double* utc_ms) {
+    if (!clock->valid) return 0;
+    double x = (double)clock_ticks_diff(clock, ticks, clock->ref_ticks);
+    *utc_ms = (double)clock->ref_utc_ms + clock->offset_ms + clock->slope * x;
+    return 1;
+}
+
+double nmea_clock_drift_ppm(const nmea_clock_t* clock) {
+    return (clock->slope > 0.0) ? (1.0 / clock->slope - 1.0) * 1e6 : 0.0;
+}
@@ -0,0 +1,48 @@
+#ifndef UBLOX_NMEA_CLOCK_H
+#define UBLOX_NMEA_CLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Линейная модель локальных часов относительно UTC без PPS: UTC = опорное UTC + смещение +
+// наклон * (тики - опорные тики). Оценка - наименьшие квадраты по окну последних пар
+// (тики прихода предложения эпохи, UTC эпохи) с отбрасыванием выбросов
+
+#define NMEA_CLOCK_WINDOW 64
+
+// Выбросы: невязка больше NMEA_CLOCK_OUTLIER_SIGMA СКО модели (но не меньше NMEA_CLOCK_OUTLIER_MIN_MS)
+#define NMEA_CLOCK_OUTLIER_SIGMA 4.0
+#define NMEA_CLOCK_OUTLIER_MIN_MS 20.0
+
+// Подряд отброшенных пар, после которых окно сбрасывается (скачок часов, сон)
+#define NMEA_CLOCK_MAX_MISSES 3
+
+typedef struct {
+    uint64_t ticks_mask;                    // период счетчика тиков - 1
+    uint64_t ticks[NMEA_CLOCK_WINDOW];      // кольцевое окно пар
+    int64_t utc_ms[NMEA_CLOCK_WINDOW];
+    uint8_t head;
+    uint8_t count;
+    uint8_t misses;
+    uint8_t valid;                          // модель построена
+    uint64_t ref_ticks;                     // опорная пара - самая новая в окне
+    int64_t ref_utc_ms;
+    double offset_ms;                       // модель в опорной точке минус ref_utc_ms
+    double slope;                           // мс UTC на тик
+    double rms_ms;                          // СКО невязок принятых пар
+    uint32_t samples;                       // принято пар всего
+    uint32_t rejected;
+} nmea_clock_t;
+
+void nmea_clock_init(nmea_clock_t* clock, uint64_t ticks_mask);
+
+// Пара (тики, UTC мс) с пересчетом модели; 1 - принята, 0 - отброшена как выброс
+int nmea_clock_add(nmea_clock_t* clock, uint64_t ticks, int64_t utc_ms);
+
+// UTC (мс от 1970-01-01) момента ticks; 0, если модели еще нет
+int nmea_clock_utc_ms(const nmea_clock_t* clock, uint64_t ticks, double* utc_ms);
+
+// Уход локальных часов, ppm (+ - спешат)
+double nmea_clock_drift_ppm(const nmea_clock_t* clock);
+
+#endif
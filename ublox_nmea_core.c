@@ -0,0 +1,550 @@
+#include "ublox_nmea_core.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Ядро парсера NMEA: не зависит от MicroPython и используется всеми слоями привязок
+
+// Прототипы внутренних функций
+static double parse_coordinate(const char* coord, char direction);
+static int parse_fields(const char* sentence, char fields[][NMEA_MAX_FIELD + 1], int max_fields);
+static void parse_gga(const char* sentence, gps_data_t* gps_data);
+static void parse_rmc(const char* sentence, gps_data_t* gps_data);
+static void parse_gsa(const char* sentence, gps_data_t* gps_data);
+static void parse_gsv(const char* sentence, gps_data_t* gps_data, nmea_gsv_signals_t* signals);
+static void parse_vtg(const char* sentence, gps_data_t* gps_data);
+static double calculate_accuracy(double hdop, uint8_t satellites_used);
+static void update_accuracy(gps_data_t* gps_data);
+static void parse_time_field(const char* field, gps_data_t* gps_data);
+
+// Инициализация структуры GPS данных
+void gps_data_init(gps_data_t* gps_data) {
+    gps_data->latitude = NAN;
+    gps_data->longitude = NAN;
+    gps_data->altitude = NAN;
+    gps_data->geoid_separation = NAN;
+    gps_data->speed = NAN;
+    gps_data->course = NAN;
+    gps_data->satellites_used = 0;
+    gps_data->satellites_visible = 0;
+    gps_data->fix_type = 0;
+    gps_data->hdop = NAN;
+    gps_data->vdop = NAN;
+    gps_data->pdop = NAN;
+    gps_data->accuracy = NAN;
+    gps_data->year = 0;
+    gps_data->month = 0;
+    gps_data->day = 0;
+    gps_data->hour = 0;
+    gps_data->minute = 0;
+    gps_data->second = 0;
+    gps_data->millisecond = 0;
+    gps_data->valid = 0;
+    gps_data->has_gga = 0;
+    gps_data->has_gsa = 0;
+    gps_data->has_gsv = 0;
+    gps_data->has_vtg = 0;
+    gps_data->has_satellites_used = 0;
+    gps_data->has_satellites_visible = 0;
+    gps_data->has_accuracy = 0;
+    gps_data->timestamp[0] = '\0';  // Инициализируем пустой строкой
+}
+
+// Функция расчета accuracy на основе HDOP и количества спутников
+static double calculate_accuracy(double hdop, uint8_t satellites_used) {
+    double base_accuracy = hdop * 4.9;  // базовый множитель
+
+    // Корректировка по количеству спутников
+    if (satellites_used >= 8) {
+        base_accuracy *= 0.7;  // высокая точность
+    } else if (satellites_used >= 5) {
+        base_accuracy *= 0.9;  // средняя точность
+    } else if (satellites_used <= 3) {
+        base_accuracy *= 1.5;  // низкая точность
+    }
+
+    return base_accuracy;
+}
+
+// Обновление accuracy
+static void update_accuracy(gps_data_t* gps_data) {
+    if (!isnan(gps_data->hdop) && gps_data->has_satellites_used) {
+        gps_data->accuracy = calculate_accuracy(gps_data->hdop, gps_data->satellites_used);
+        gps_data->accuracy = round(gps_data->accuracy * 10.0) / 10.0; // округление
+        gps_data->has_accuracy = 1;
+    } else {
+        gps_data->accuracy = NAN;
+        gps_data->has_accuracy = 0;
+    }
+}
+
+// Запись числа фиксированной ширины с ведущими нулями
+static char* put_digits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return out + width;
+}
+
+// Функция для обновления timestamp в структуре
+// Формат YYYY-MM-DDTHH:MM:SSZ собирается вручную: snprintf доминировал в пакетном разборе логов
+void gps_data_update_timestamp(gps_data_t* gps_data) {
+    // Проверяем наличие полной даты и времени
+    if (gps_data->year > 0 && gps_data->month > 0 && gps_data->day > 0 &&
+        gps_data->year <= 9999 && gps_data->month <= 99 && gps_data->day <= 99 &&
+        gps_data->hour <= 99 && gps_data->minute <= 99 && gps_data->second <= 99) {
+        char* p = gps_data->timestamp;
+        p = put_digits(p, gps_data->year, 4);
+        *p++ = '-';
+        p = put_digits(p, gps_data->month, 2);
+        *p++ = '-';
+        p = put_digits(p, gps_data->day, 2);
+        *p++ = 'T';
+        p = put_digits(p, gps_data->hour, 2);
+        *p++ = ':';
+        p = put_digits(p, gps_data->minute, 2);
+        *p++ = ':';
+        p = put_digits(p, gps_data->second, 2);
+        *p++ = 'Z';
+        *p = '\0';
+    } else {
+        gps_data->timestamp[0] = '\0';
+    }
+}
+
+// Парсинг поля времени hhmmss.ss (дробная часть -> миллисекунды)
+static void parse_time_field(const char* field, gps_data_t* gps_data) {
+    if (strlen(field) < 6) return;
+
+    gps_data->hour = (field[0] - '0') * 10 + (field[1] - '0');
+    gps_data->minute = (field[2] - '0') * 10 + (field[3] - '0');
+    gps_data->second = (field[4] - '0') * 10 + (field[5] - '0');
+
+    uint16_t ms = 0;
+    if (field[6] == '.') {
+        uint16_t scale = 100;
+        for (const char* p = field + 7; *p >= '0' && *p <= '9' && scale > 0; p++) {
+            ms += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+    gps_data->millisecond = ms;
+}
+
+static double parse_coordinate(const char* coord, char direction) {
+    if (strlen(coord) < 7) return NAN;
+
+    // Находим позицию десятичной точки
+    const char* dot_pos = strchr(coord, '.');
+    if (!dot_pos) return NAN;
+
+    int dot_index = dot_pos - coord;
+
+    // Определяем количество цифр в градусах по позиции точки
+    // Форматы NMEA:
+    // DDM.MMMMM   - точка на позиции 2 (нестандартный)
+    // DDMM.MMMMM  - точка на позиции 4 (стандартный для широты)
+    // DDDMM.MMMMM - точка на позиции 5 (стандартный для долготы)
+    // DDDDMM.MMMMM - точка на позиции 6 (расширенный)
+
+    int degree_digits;
+    if (dot_index == 2) {
+        degree_digits = 1;  // DDM.MMMMM
+    } else if (dot_index == 3) {
+        degree_digits = 2;  // DDM.MMMMM (редкий)
+    } else if (dot_index == 4) {
+        degree_digits = 2;  // DDMM.MMMMM (широта)
+    } else if (dot_index == 5) {
+        degree_digits = 3;  // DDDMM.MMMMM (долгота)
+    } else if (dot_index == 6) {
+        degree_digits = 4;  // DDDDMM.MMMMM (высокая точность)
+    } else {
+        return NAN;  // Неизвестный формат
+    }
+
+    // Извлекаем градусы
+    char degrees_str[5] = {0};  // увеличен буфер для 4 цифр
+    strncpy(degrees_str, coord, degree_digits);
+    degrees_str[degree_digits] = '\0';
+
+    // Извлекаем минуты (всё после градусов)
+    char minutes_str[16] = {0};
+    strncpy(minutes_str, coord + degree_digits, sizeof(minutes_str) - 1);
+
+    double degrees = atof(degrees_str);
+    double minutes = atof(minutes_str);
+
+    double result = degrees + minutes / 60.0;
+
+    if (direction == 'S' || direction == 'W') {
+        result = -result;
+    }
+
+    return result;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Проверка контрольной суммы за один проход: не дальше NMEA_MAX_SENTENCE символов,
+// после '*' - ровно две шестнадцатеричные цифры
+int nmea_checksum_valid(const char* sentence) {
+    if (sentence[0] != '$') return 0;
+
+    uint8_t calculated_checksum = 0;
+    const char* p = sentence + 1;
+    const char* limit = sentence + NMEA_MAX_SENTENCE - 2;
+    for (;; p++) {
+        if (p >= limit || *p == '\0') return 0;
+        if (*p == '*') break;
+        calculated_checksum ^= (uint8_t)*p;
+    }
+
+    int high = hex_digit(p[1]);
+    if (high < 0) return 0;
+    int low = hex_digit(p[2]);
+    if (low < 0) return 0;
+    return calculated_checksum == (uint8_t)(high << 4 | low);
+}
+
+// Разбиение на поля до '*' (после проверки контрольной суммы - в пределах NMEA_MAX_SENTENCE)
+static int parse_fields(const char* sentence, char fields[][NMEA_MAX_FIELD + 1], int max_fields) {
+    int field_count = 0;
+    const char* start = sentence;
+
+    while (field_count < max_fields) {
+        char c = *sentence;
+        if (c == ',' || c == '*' || c == '\0') {
+            size_t len = sentence - start;
+            if (len <= NMEA_MAX_FIELD) {
+                memcpy(fields[field_count], start, len);
+                fields[field_count][len] = '\0';
+            } else {
+                fields[field_count][0] = '\0';
+            }
+            field_count++;
+            if (c != ',') break;
+            start = sentence + 1;
+        }
+        sentence++;
+    }
+
+    return field_count;
+}
+
+// Парсинг GGA сообщения
+static void parse_gga(const char* sentence, gps_data_t* gps_data) {
+    char fields[NMEA_MAX_FIELDS][NMEA_MAX_FIELD + 1] = {0};
+    int field_count = parse_fields(sentence, fields, NMEA_MAX_FIELDS);
+
+    if (field_count < 14) return;
+
+    // Время
+    parse_time_field(fields[1], gps_data);
+
+    // Координаты (GGA имеет приоритет для высоты и точности)
+    if (strlen(fields[2]) > 0 && strlen(fields[3]) > 0) {
+        gps_data->latitude = parse_coordinate(fields[2], fields[3][0]);
+    }
+
+    if (strlen(fields[4]) > 0 && strlen(fields[5]) > 0) {
+        gps_data->longitude = parse_coordinate(fields[4], fields[5][0]);
+    }
+
+    // Качество фикса
+    if (strlen(fields[6]) > 0) {
+        gps_data->fix_type = atoi(fields[6]);
+    }
+
+    // Количество спутников
+    if (strlen(fields[7]) > 0) {
+        gps_data->satellites_used = atoi(fields[7]);
+        gps_data->has_satellites_used = 1;
+    }
+
+    // HDOP
+    if (strlen(fields[8]) > 0) {
+        gps_data->hdop = atof(fields[8]);
+    }
+
+    // Высота (округляем до 1 знака после запятой)
+    if (strlen(fields[9]) > 0) {
+        gps_data->altitude = round(atof(fields[9]) * 10.0) / 10.0;
+    }
+
+    // Превышение геоида над эллипсоидом (для перехода к эллипсоидальной высоте)
+    if (strlen(fields[11]) > 0) {
+        gps_data->geoid_separation = atof(fields[11]);
+    }
+
+    gps_data->has_gga = 1;
+
+    // Обновляем accuracy и timestamp
+    update_accuracy(gps_data);
+    gps_data_update_timestamp(gps_data);
+}
+
+// Парсинг RMC сообщения
+static void parse_rmc(const char* sentence, gps_data_t* gps_data) {
+    char fields[NMEA_MAX_FIELDS][NMEA_MAX_FIELD + 1] = {0};
+    int field_count = parse_fields(sentence, fields, NMEA_MAX_FIELDS);
+
+    if (field_count < 12) return;
+
+    // ВАЖНО: RMC НЕ сбрасывает флаги других предложений
+    // Каждое предложение дополняет общую картину
+
+    // Время (RMC имеет приоритет для даты и общего статуса)
+    parse_time_field(fields[1], gps_data);
+
+    // Статус - основной индикатор валидности позиции
+    gps_data->valid = (fields[2][0] == 'A') ? 1 : 0;
+
+    // Координаты (используем если нет от GGA или GGA невалидны)
+    if (strlen(fields[3]) > 0 && strlen(fields[4]) > 0 &&
+        (isnan(gps_data->latitude) || !gps_data->has_gga)) {
+        gps_data->latitude = parse_coordinate(fields[3], fields[4][0]);
+    }
+
+    if (strlen(fields[5]) > 0 && strlen(fields[6]) > 0 &&
+        (isnan(gps_data->longitude) || !gps_data->has_gga)) {
+        gps_data->longitude = parse_coordinate(fields[5], fields[6][0]);
+    }
+
+    // Скорость (узлы -> м/с, округляем до 1 знака после запятой)
+    if (strlen(fields[7]) > 0) {
+        double speed_knots = atof(fields[7]);
+        gps_data->speed = round(speed_knots * 0.514444 * 10.0) / 10.0;
+    }
+
+    // Курс из RMC (округляем до 1 знака после запятой)
+    if (strlen(fields[8]) > 0) {
+        gps_data->course = round(atof(fields[8]) * 10.0) / 10.0;
+    }
+
+    // Дата (RMC - основной источник даты)
+    if (strlen(fields[9]) >= 6) {
+        gps_data->day = (fields[9][0] - '0') * 10 + (fields[9][1] - '0');
+        gps_data->month = (fields[9][2] - '0') * 10 + (fields[9][3] - '0');
+        gps_data->year = 2000 + (fields[9][4] - '0') * 10 + (fields[9][5] - '0');
+    }
+
+    // Обновляем timestamp
+    gps_data_update_timestamp(gps_data);
+}
+
+// Парсинг GSA сообщения
+static void parse_gsa(const char* sentence, gps_data_t* gps_data) {
+    char fields[NMEA_MAX_FIELDS][NMEA_MAX_FIELD + 1] = {0};
+    int field_count = parse_fields(sentence, fields, NMEA_MAX_FIELDS);
+
+    if (field_count < 17) return;
+
+    // PDOP, HDOP, VDOP (округляем до 1 знака после запятой)
+    // GSA имеет приоритет для DOP параметров
+    if (strlen(fields[15]) > 0) {
+        gps_data->pdop = round(atof(fields[15]) * 10.0) / 10.0;
+    }
+
+    if (strlen(fields[16]) > 0) {
+        gps_data->hdop = round(atof(fields[16]) * 10.0) / 10.0;
+    }
+
+    if (strlen(fields[17]) > 0) {
+        gps_data->vdop = round(atof(fields[17]) * 10.0) / 10.0;
+    }
+
+    gps_data->has_gsa = 1;
+
+    // Обновляем accuracy
+    update_accuracy(gps_data);
+}
+
+// Парсинг GSV сообщения - подсчет видимых спутников; signals (может быть NULL) получает
+// номера и SNR спутников предложения
+static void parse_gsv(const char* sentence, gps_data_t* gps_data, nmea_gsv_signals_t* signals) {
+    char fields[NMEA_MAX_FIELDS][NMEA_MAX_FIELD + 1] = {0};
+    int field_count = parse_fields(sentence, fields, NMEA_MAX_FIELDS);
+
+    if (field_count < 4) return;
+
+    // ЛОГИКА: В GSV предложениях:
+    // Поле 1 - общее количество GSV сообщений для полного набора данных
+    // Поле 2 - номер текущего GSV сообщения
+    // Поле 3 - общее количество видимых спутников
+    // Поля 4-7, 8-11, 12-15, 16-19 - данные по 4 спутникам за сообщение
+
+    // Используем поле 3 - общее количество видимых спутников
+    if (strlen(fields[3]) > 0) {
+        gps_data->satellites_visible = atoi(fields[3]);
+        gps_data->has_satellites_visible = 1;
+        gps_data->has_gsv = 1;
+    }
+
+    if (signals) {
+        signals->talker[0] = sentence[1];
+        signals->talker[1] = sentence[2];
+        // Только полные блоки из 4 полей: одиночное поле после них - signalId NMEA 4.10
+        for (int i = 4; i + 3 < field_count && signals->count < 4; i += 4) {
+            if (fields[i][0] == '\0') continue;
+            uint8_t k = signals->count++;
+            signals->prn[k] = (uint16_t)atoi(fields[i]);
+            // Пустое SNR - спутник виден, но не отслеживается
+            signals->snr[k] = fields[i + 3][0] ? (uint8_t)atoi(fields[i + 3]) : NMEA_GSV_NO_SNR;
+        }
+    }
+}
+
+// Парсинг VTG сообщения - курс и скорость относительно земли
+static void parse_vtg(const char* sentence, gps_data_t* gps_data) {
+    char fields[NMEA_MAX_FIELDS][NMEA_MAX_FIELD + 1] = {0};
+    int field_count = parse_fields(sentence, fields, NMEA_MAX_FIELDS);
+
+    if (field_count < 8) return;
+
+    // VTG используется как дополнение к RMC
+    // Курс относительно истинного севера (поле 1)
+    if (strlen(fields[1]) > 0 && isnan(gps_data->course)) {
+        gps_data->course = round(atof(fields[1]) * 10.0) / 10.0;
+    }
+
+    // Скорость в км/ч (поле 7) - конвертируем в м/с
+    // Используем только если в RMC не было скорости
+    if (strlen(fields[7]) > 0 && (isnan(gps_data->speed) || gps_data->speed < 0.1)) {
+        double speed_kmh = atof(fields[7]);
+        gps_data->speed = round((speed_kmh / 3.6) * 10.0) / 10.0;
+    }
+
+    gps_data->has_vtg = 1;
+}
+
+// Функция расчета расстояния между двумя точками (формула гаверсинуса)
+double calculate_distance_haversine(double lat1, double lon1, double lat2, double lon2) {
+    double lat1_rad = lat1 * DEG_TO_RAD;
+    double lon1_rad = lon1 * DEG_TO_RAD;
+    double lat2_rad = lat2 * DEG_TO_RAD;
+    double lon2_rad = lon2 * DEG_TO_RAD;
+
+    double dlat = lat2_rad - lat1_rad;
+    double dlon = lon2_rad - lon1_rad;
+
+    double a = sin(dlat/2) * sin(dlat/2) +
+               cos(lat1_rad) * cos(lat2_rad) *
+               sin(dlon/2) * sin(dlon/2);
+
+    double c = 2 * atan2(sqrt(a), sqrt(1-a));
+
+    return EARTH_RADIUS_M * c;
+}
+
+// Количество дней от 1970-01-01 (алгоритм days_from_civil, годы от 0)
+int64_t nmea_days_from_civil(int year, int month, int day) {
+    int32_t y = year - (month <= 2 ? 1 : 0);
+    int32_t era = y / 400;
+    int32_t yoe = y - era * 400;
+    int32_t mp = (month + 9) % 12;
+    int32_t doy = (153 * mp + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+// Перевод даты/времени фикса в миллисекунды UTC от 1970-01-01 (-1 если даты нет)
+int64_t gps_data_utc_ms(const gps_data_t* gps_data) {
+    if (gps_data->year == 0 || gps_data->month == 0 || gps_data->day == 0) {
+        return -1;
+    }
+
+    int64_t days = nmea_days_from_civil(gps_data->year, gps_data->month, gps_data->day);
+    int64_t seconds = days * 86400 + gps_data->hour * 3600 + gps_data->minute * 60 + gps_data->second;
+    return seconds * 1000 + gps_data->millisecond;
+}
+
+// Календарная дата из числа дней от 1970-01-01 (алгоритм Хиннанта)
+void nmea_civil_from_days(int64_t days, int* year, int* month, int* day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+// Разбор одного NMEA предложения с обновлением gps_data
+// ЛОГИКА: Каждое предложение дополняет общую картину данных
+nmea_sentence_t nmea_parse_sentence(const char* nmea_string, gps_data_t* gps_data) {
+    return nmea_parse_sentence_signals(nmea_string, gps_data, NULL);
+}
+
+nmea_sentence_t nmea_parse_sentence_signals(const char* nmea_string, gps_data_t* gps_data,
+                                            nmea_gsv_signals_t* signals) {
+    if (signals) signals->count = 0;
+    if (!nmea_string) {
+        return NMEA_SENTENCE_INVALID;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (nmea_string[i] == '\0') return NMEA_SENTENCE_INVALID;
+    }
+
+    if (!nmea_checksum_valid(nmea_string)) {
+        return NMEA_SENTENCE_INVALID;
+    }
+
+    return nmea_dispatch_sentence_signals(nmea_string, gps_data, signals);
+}
+
+// Talker (две буквы после '$') из списка пар, например "GPGN"
+static int talker_in(const char* sentence, const char* talkers) {
+    for (; *talkers; talkers += 2) {
+        if (sentence[1] == talkers[0] && sentence[2] == talkers[1]) return 1;
+    }
+    return 0;
+}
+
+// Тип предложения (три буквы после talker)
+static int type_is(const char* sentence, const char* type) {
+    return sentence[3] == type[0] && sentence[4] == type[1] && sentence[5] == type[2];
+}
+
+// Разбор предложения, уже прошедшего проверку длины и контрольной суммы
+// Тип определяется по шести первым символам без поиска по строке
+nmea_sentence_t nmea_dispatch_sentence(const char* nmea_string, gps_data_t* gps_data) {
+    return nmea_dispatch_sentence_signals(nmea_string, gps_data, NULL);
+}
+
+nmea_sentence_t nmea_dispatch_sentence_signals(const char* nmea_string, gps_data_t* gps_data,
+                                               nmea_gsv_signals_t* signals) {
+    if (signals) signals->count = 0;
+    if (nmea_string[0] != '$') {
+        return NMEA_SENTENCE_UNKNOWN;
+    }
+
+    if (type_is(nmea_string, "RMC") && talker_in(nmea_string, "GPGN")) {
+        parse_rmc(nmea_string, gps_data);
+        return NMEA_SENTENCE_RMC;
+    }
+    else if (type_is(nmea_string, "GGA") && talker_in(nmea_string, "GPGN")) {
+        parse_gga(nmea_string, gps_data);
+        return NMEA_SENTENCE_GGA;
+    }
+    else if (type_is(nmea_string, "GSA") && talker_in(nmea_string, "GPGN")) {
+        parse_gsa(nmea_string, gps_data);
+        return NMEA_SENTENCE_GSA;
+    }
+    else if (type_is(nmea_string, "GSV") && talker_in(nmea_string, "GPGLGNGB")) {
+        parse_gsv(nmea_string, gps_data, signals);
+        return NMEA_SENTENCE_GSV;
+    }
+    else if (type_is(nmea_string, "VTG") && talker_in(nmea_string, "GPGN")) {
+        parse_vtg(nmea_string, gps_data);
+        return NMEA_SENTENCE_VTG;
+    }
+    return NMEA_SENTENCE_UNKNOWN;
+}
@@ -0,0 +1,95 @@
+#ifndef UBLOX_NMEA_CORE_H
+#define UBLOX_NMEA_CORE_H
+
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Константы для расчета расстояния
+#define EARTH_RADIUS_M 6371000.0
+#define DEG_TO_RAD (M_PI / 180.0)
+
+// Границы разбора: предложение длиннее NMEA_MAX_SENTENCE символов от '$' до контрольной суммы
+// включительно отбрасывается (стандарт - 82 с "\r\n", запас под координаты высокой точности),
+// поле длиннее NMEA_MAX_FIELD читается как пустое, после NMEA_MAX_FIELDS полей разбор прекращается.
+// nmea_parse_sentence читает не больше NMEA_MAX_SENTENCE + 1 байт входа за один проход
+// (плюс разбор полей внутри этой границы), поэтому время вызова ограничено для любых байтов
+#ifndef NMEA_MAX_SENTENCE
+#define NMEA_MAX_SENTENCE 127
+#endif
+#define NMEA_MAX_FIELD 15
+#define NMEA_MAX_FIELDS 20
+
+// Структура для хранения GPS данных
+typedef struct {
+    double latitude;
+    double longitude;
+    double altitude;
+    double geoid_separation; // превышение геоида над эллипсоидом WGS84
+    double speed;
+    double course;
+    uint8_t satellites_used;
+    uint8_t satellites_visible;
+    uint8_t fix_type;
+    double hdop;
+    double vdop;
+    double pdop;
+    double accuracy;  // точность в метрах
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint16_t millisecond; // дробная часть секунды из hhmmss.ss
+    uint8_t valid;
+    uint8_t has_gga;
+    uint8_t has_gsa;
+    uint8_t has_gsv;
+    uint8_t has_vtg;
+    uint8_t has_satellites_used;
+    uint8_t has_satellites_visible;
+    uint8_t has_accuracy;
+    char timestamp[25]; // Формат: "2024-01-15T14:30:45Z" + null terminator
+} gps_data_t;
+
+// Тип разобранного предложения
+typedef enum {
+    NMEA_SENTENCE_INVALID = -1,  // короткая строка или неверная контрольная сумма
+    NMEA_SENTENCE_UNKNOWN = 0,   // корректное, но не поддерживаемое предложение
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_GGA,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_GSV,
+    NMEA_SENTENCE_VTG,
+} nmea_sentence_t;
+
+// Спутники одного GSV (до 4): номер и SNR (C/N0, дБГц); talker - система ("GP", "GL", "GB", "GN")
+#define NMEA_GSV_NO_SNR 0xFF
+typedef struct {
+    char talker[2];
+    uint8_t count;
+    uint16_t prn[4];
+    uint8_t snr[4];         // NMEA_GSV_NO_SNR - спутник не отслеживается
+} nmea_gsv_signals_t;
+
+void gps_data_init(gps_data_t* gps_data);
+nmea_sentence_t nmea_parse_sentence(const char* nmea_string, gps_data_t* gps_data);
+nmea_sentence_t nmea_dispatch_sentence(const char* nmea_string, gps_data_t* gps_data);
+
+// То же с выдачей спутников GSV в signals (count = 0 для остальных предложений)
+nmea_sentence_t nmea_parse_sentence_signals(const char* nmea_string, gps_data_t* gps_data,
+                                            nmea_gsv_signals_t* signals);
+nmea_sentence_t nmea_dispatch_sentence_signals(const char* nmea_string, gps_data_t* gps_data,
+                                               nmea_gsv_signals_t* signals);
+int nmea_checksum_valid(const char* sentence);
+int64_t gps_data_utc_ms(const gps_data_t* gps_data);
+void gps_data_update_timestamp(gps_data_t* gps_data);
+int64_t nmea_days_from_civil(int year, int month, int day);
+void nmea_civil_from_days(int64_t days, int* year, int* month, int* day);
+double calculate_distance_haversine(double lat1, double lon1, double lat2, double lon2);
+
+#endif
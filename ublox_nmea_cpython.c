@@ -0,0 +1,2142 @@
+// Привязка ядра парсера к CPython (серверная обработка логов)
+// Использует тот же ublox_nmea_core.c, что и модуль MicroPython
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "ublox_nmea_core.h"
+#include "ublox_nmea_log.h"
+#include "ublox_nmea_mux.h"
+#include "ublox_nmea_gen.h"
+#include "ublox_nmea_encode.h"
+#include "ublox_nmea_pack.h"
+#include "ublox_nmea_state.h"
+#include "ublox_nmea_ubx.h"
+#include "ublox_nmea_clock.h"
+#include "ublox_nmea_rf.h"
+
+// Глобальная структура для хранения текущих GPS данных
+static gps_data_t current_gps_data;
+static uint8_t gps_data_initialized = 0;
+
+// Таблица спутников из последнего UBX-NAV-SAT
+static ubx_sat_table_t sat_table;
+
+// Передача времени по PPS; тики - микросекунды вызывающего (например, time.monotonic_ns() // 1000)
+static ubx_timepulse_t timepulse = { .ns_per_tick = 1000.0, .ticks_mask = UINT64_MAX,
+                                     .leap_seconds = UBX_GPS_LEAP_SECONDS };
+
+// Модель локальных часов по парам clock_sample(); тики - миллисекунды вызывающего
+static nmea_clock_t clock_model = { .ticks_mask = UINT64_MAX, .slope = 1.0 };
+
+// Контроль радиотракта; эпоха C/N0 закрывается сменой времени RMC/GGA, как в модуле MicroPython
+static nmea_rf_t rf_monitor = {
+    .jam_ind_max = NMEA_RF_JAM_IND,
+    .min_signals = NMEA_RF_MIN_SIGNALS,
+    .cno_min = NMEA_RF_CNO_MIN,
+    .cno_drop = NMEA_RF_CNO_DROP,
+};
+static int32_t rf_epoch_time_ms = -1;
+static PyObject* rf_callback = NULL;
+
+// Запись значения в словарь с освобождением ссылки
+static int dict_set_new(PyObject* dict, const char* key, PyObject* value) {
+    if (!value) return -1;
+    int result = PyDict_SetItemString(dict, key, value);
+    Py_DECREF(value);
+    return result;
+}
+
+// Словарь из GPS данных (те же поля и правила, что и в модуле MicroPython)
+static PyObject* create_gps_dict_from_data(const gps_data_t* gps_data) {
+    PyObject* dict = PyDict_New();
+    if (!dict) return NULL;
+
+    int err = 0;
+
+    // Основные поля (всегда присутствуют)
+    err |= dict_set_new(dict, "valid", PyBool_FromLong(gps_data->valid));
+
+    // Координаты (только если есть данные)
+    if (!isnan(gps_data->latitude)) {
+        err |= dict_set_new(dict, "latitude", PyFloat_FromDouble(gps_data->latitude));
+    }
+    if (!isnan(gps_data->longitude)) {
+        err |= dict_set_new(dict, "longitude", PyFloat_FromDouble(gps_data->longitude));
+    }
+
+    // Высота (только если есть данные из GGA)
+    if (gps_data->has_gga && !isnan(gps_data->altitude)) {
+        err |= dict_set_new(dict, "altitude", PyFloat_FromDouble(gps_data->altitude));
+    }
+
+    // Скорость и курс (только если есть данные)
+    if (!isnan(gps_data->speed)) {
+        err |= dict_set_new(dict, "speed", PyFloat_FromDouble(round(gps_data->speed * 10.0) / 10.0));
+    }
+    if (!isnan(gps_data->course)) {
+        err |= dict_set_new(dict, "course", PyFloat_FromDouble(round(gps_data->course * 10.0) / 10.0));
+    }
+
+    // Спутники (только если есть данные)
+    if (gps_data->has_satellites_used) {
+        err |= dict_set_new(dict, "satellites_used", PyLong_FromLong(gps_data->satellites_used));
+    }
+    if (gps_data->has_satellites_visible) {
+        err |= dict_set_new(dict, "satellites_visible", PyLong_FromLong(gps_data->satellites_visible));
+    }
+
+    // Тип фикса (только если есть данные из GGA)
+    if (gps_data->has_gga) {
+        err |= dict_set_new(dict, "fix_type", PyLong_FromLong(gps_data->fix_type));
+    }
+
+    // DOP параметры (только если есть данные из GSA)
+    if (gps_data->has_gsa && !isnan(gps_data->hdop)) {
+        err |= dict_set_new(dict, "hdop", PyFloat_FromDouble(round(gps_data->hdop * 10.0) / 10.0));
+    }
+    if (gps_data->has_gsa && !isnan(gps_data->vdop)) {
+        err |= dict_set_new(dict, "vdop", PyFloat_FromDouble(round(gps_data->vdop * 10.0) / 10.0));
+    }
+    if (gps_data->has_gsa && !isnan(gps_data->pdop)) {
+        err |= dict_set_new(dict, "pdop", PyFloat_FromDouble(round(gps_data->pdop * 10.0) / 10.0));
+    }
+
+    // Accuracy (только если есть данные)
+    if (gps_data->has_accuracy && !isnan(gps_data->accuracy)) {
+        err |= dict_set_new(dict, "accuracy", PyFloat_FromDouble(gps_data->accuracy));
+    }
+
+    // Дата и время (только если есть данные)
+    if (gps_data->year > 0 && gps_data->month > 0 && gps_data->day > 0) {
+        err |= dict_set_new(dict, "date", Py_BuildValue("[iii]", gps_data->day, gps_data->month, gps_data->year));
+    }
+    if (gps_data->year > 0) {
+        err |= dict_set_new(dict, "time", Py_BuildValue("[iii]", gps_data->hour, gps_data->minute, gps_data->second));
+    }
+
+    // Timestamp в формате ISO 8601 (только если есть данные)
+    if (gps_data->timestamp[0] != '\0') {
+        err |= dict_set_new(dict, "timestamp", PyUnicode_FromString(gps_data->timestamp));
+    }
+
+    if (err) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+    return dict;
+}
+
+// parse(sentence) - sentence: str или bytes
+static PyObject* py_parse(PyObject* self, PyObject* arg) {
+    const char* nmea_string;
+    if (PyUnicode_Check(arg)) {
+        nmea_string = PyUnicode_AsUTF8(arg);
+    } else if (PyBytes_Check(arg)) {
+        nmea_string = PyBytes_AS_STRING(arg);
+    } else {
+        PyErr_SetString(PyExc_TypeError, "sentence must be str or bytes");
+        return NULL;
+    }
+    if (!nmea_string) return NULL;
+
+    // Инициализация при первом вызове
+    if (!gps_data_initialized) {
+        gps_data_init(&current_gps_data);
+        gps_data_initialized = 1;
+    }
+
+    nmea_gsv_signals_t signals;
+    nmea_sentence_t type = nmea_parse_sentence_signals(nmea_string, &current_gps_data, &signals);
+    if (type == NMEA_SENTENCE_INVALID) {
+        Py_RETURN_NONE;
+    }
+    if (type == NMEA_SENTENCE_GSV) {
+        nmea_rf_gsv(&rf_monitor, &signals);
+    } else if (type == NMEA_SENTENCE_RMC || type == NMEA_SENTENCE_GGA) {
+        int32_t time_ms = ((current_gps_data.hour * 60 + current_gps_data.minute) * 60 +
+                           current_gps_data.second) * 1000 + current_gps_data.millisecond;
+        if (time_ms != rf_epoch_time_ms) {
+            if (rf_epoch_time_ms >= 0) nmea_rf_epoch(&rf_monitor);
+            rf_epoch_time_ms = time_ms;
+            // Исключение из обработчика тревог
+            if (PyErr_Occurred()) return NULL;
+        }
+    }
+
+    return create_gps_dict_from_data(&current_gps_data);
+}
+
+// current() - текущие данные
+static PyObject* py_current(PyObject* self, PyObject* unused) {
+    if (!gps_data_initialized) {
+        return Py_BuildValue("{s:O}", "valid", Py_False);
+    }
+    return create_gps_dict_from_data(&current_gps_data);
+}
+
+// reset() - сброс данных
+static PyObject* py_reset(PyObject* self, PyObject* unused) {
+    gps_data_init(&current_gps_data);
+    gps_data_initialized = 1;
+    ubx_sat_table_init(&sat_table);
+    ubx_timepulse_init(&timepulse, 1000.0, UINT64_MAX);
+    nmea_clock_init(&clock_model, UINT64_MAX);
+    nmea_rf_reset(&rf_monitor);
+    rf_epoch_time_ms = -1;
+    Py_RETURN_NONE;
+}
+
+// save_state() - снимок текущего фикса в формате MicroPython-модуля (без ENU и истории)
+static PyObject* py_save_state(PyObject* self, PyObject* unused) {
+    if (!gps_data_initialized) {
+        gps_data_init(&current_gps_data);
+        gps_data_initialized = 1;
+    }
+    uint8_t out[NMEA_STATE_MIN_SIZE];
+    size_t len = nmea_state_finish(out, nmea_state_begin(out, 0, &current_gps_data));
+    return PyBytes_FromStringAndSize((const char*)out, (Py_ssize_t)len);
+}
+
+// load_state(blob) - восстановление фикса; секции ENU и истории снимка с устройства пропускаются
+static PyObject* py_load_state(PyObject* self, PyObject* args) {
+    Py_buffer blob;
+    if (!PyArg_ParseTuple(args, "y*", &blob)) return NULL;
+    uint8_t flags;
+    gps_data_t restored;
+    int offset = nmea_state_open(blob.buf, (size_t)blob.len, &flags, &restored);
+    PyBuffer_Release(&blob);
+    if (offset == NMEA_STATE_ERROR_VERSION) {
+        PyErr_SetString(PyExc_ValueError, "unsupported state version");
+        return NULL;
+    }
+    if (offset < 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid state blob");
+        return NULL;
+    }
+    current_gps_data = restored;
+    gps_data_initialized = 1;
+    Py_RETURN_NONE;
+}
+
+// Точка [lat, lon] из кортежа или списка
+static int get_point(PyObject* obj, double* lat, double* lon, const char* name) {
+    if (!PyTuple_Check(obj) && !PyList_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "%s must be tuple or list [lat, lon]", name);
+        return 0;
+    }
+    if (PySequence_Size(obj) < 2) {
+        PyErr_Format(PyExc_ValueError, "%s must have at least 2 elements [lat, lon]", name);
+        return 0;
+    }
+
+    PyObject* items[2] = { PySequence_Fast_GET_ITEM(obj, 0), PySequence_Fast_GET_ITEM(obj, 1) };
+    for (int i = 0; i < 2; i++) {
+        if (!PyFloat_Check(items[i]) && !PyLong_Check(items[i])) {
+            PyErr_SetString(PyExc_TypeError, i == 0 ? "latitude must be float or int" : "longitude must be float or int");
+            return 0;
+        }
+    }
+
+    *lat = PyFloat_AsDouble(items[0]);
+    *lon = PyFloat_AsDouble(items[1]);
+    return !PyErr_Occurred();
+}
+
+// calculate_distance(target) / calculate_distance(a, b)
+static PyObject* py_calculate_distance(PyObject* self, PyObject* args) {
+    Py_ssize_t n_args = PyTuple_GET_SIZE(args);
+    if (n_args < 1 || n_args > 2) {
+        PyErr_SetString(PyExc_TypeError, "calculate_distance() takes 1 or 2 arguments");
+        return NULL;
+    }
+
+    double lat1, lon1, lat2, lon2;
+    if (n_args == 1) {
+        // Один аргумент - расчет от текущей позиции до указанной точки
+        if (!gps_data_initialized || isnan(current_gps_data.latitude) || isnan(current_gps_data.longitude)) {
+            Py_RETURN_NONE;
+        }
+        lat1 = current_gps_data.latitude;
+        lon1 = current_gps_data.longitude;
+        if (!get_point(PyTuple_GET_ITEM(args, 0), &lat2, &lon2, "target")) return NULL;
+    } else {
+        if (!get_point(PyTuple_GET_ITEM(args, 0), &lat1, &lon1, "first argument")) return NULL;
+        if (!get_point(PyTuple_GET_ITEM(args, 1), &lat2, &lon2, "second argument")) return NULL;
+    }
+
+    // Проверяем валидность координат
+    if (lat1 < -90.0 || lat1 > 90.0 || lat2 < -90.0 || lat2 > 90.0) {
+        PyErr_SetString(PyExc_ValueError, "latitude must be between -90 and 90 degrees");
+        return NULL;
+    }
+    if (lon1 < -180.0 || lon1 > 180.0 || lon2 < -180.0 || lon2 > 180.0) {
+        PyErr_SetString(PyExc_ValueError, "longitude must be between -180 and 180 degrees");
+        return NULL;
+    }
+
+    double distance = calculate_distance_haversine(lat1, lon1, lat2, lon2);
+    return PyFloat_FromDouble(round(distance * 10.0) / 10.0);
+}
+
+// Колонка array.array(typecode) из сырых данных
+static PyObject* new_column(PyObject* array_type, const char* typecode, const void* data, size_t size) {
+    PyObject* array = PyObject_CallFunction(array_type, "s", typecode);
+    if (!array) return NULL;
+
+    PyObject* result = PyObject_CallMethod(array, "frombytes", "y#", (const char*)data, (Py_ssize_t)size);
+    if (!result) {
+        Py_DECREF(array);
+        return NULL;
+    }
+    Py_DECREF(result);
+    return array;
+}
+
+// Словарь колонок array.array (те же ключи, что и в модуле MicroPython)
+static PyObject* columns_to_dict(const nmea_columns_t* columns) {
+    PyObject* array_module = PyImport_ImportModule("array");
+    if (!array_module) return NULL;
+    PyObject* array_type = PyObject_GetAttrString(array_module, "array");
+    Py_DECREF(array_module);
+    if (!array_type) return NULL;
+
+    size_t n = columns->count;
+    PyObject* dict = PyDict_New();
+    int err = !dict;
+    if (!err) {
+        err |= dict_set_new(dict, "time", new_column(array_type, "q", columns->time_ms, n * sizeof(int64_t)));
+        err |= dict_set_new(dict, "latitude", new_column(array_type, "d", columns->latitude, n * sizeof(double)));
+        err |= dict_set_new(dict, "longitude", new_column(array_type, "d", columns->longitude, n * sizeof(double)));
+        err |= dict_set_new(dict, "altitude", new_column(array_type, "d", columns->altitude, n * sizeof(double)));
+        err |= dict_set_new(dict, "speed", new_column(array_type, "d", columns->speed, n * sizeof(double)));
+        err |= dict_set_new(dict, "hdop", new_column(array_type, "d", columns->hdop, n * sizeof(double)));
+        err |= dict_set_new(dict, "satellites", new_column(array_type, "B", columns->satellites, n));
+    }
+    Py_DECREF(array_type);
+
+    if (err) {
+        Py_XDECREF(dict);
+        return NULL;
+    }
+    return dict;
+}
+
+// Разбор буфера в колонки в workers потоках (без GIL)
+static int parse_buffer_to_columns(const char* data, size_t len, size_t workers, nmea_columns_t* columns) {
+    int result;
+
+    Py_BEGIN_ALLOW_THREADS
+    result = nmea_log_parse_parallel(data, len, workers, columns);
+    Py_END_ALLOW_THREADS
+
+    if (result != 0) {
+        PyErr_NoMemory();
+        return 0;
+    }
+    return 1;
+}
+
+// Отображение файла в память; *data = NULL для пустого файла.
+// sequential - файл читается целиком (предзагрузка страниц), иначе - выборочно (индекс)
+static int map_file(PyObject* path_obj, const char** data, size_t* len, int sequential) {
+    PyObject* path_bytes;
+    if (!PyUnicode_FSConverter(path_obj, &path_bytes)) return 0;
+
+    int fd = open(PyBytes_AS_STRING(path_bytes), O_RDONLY);
+    if (fd < 0) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path_obj);
+        Py_DECREF(path_bytes);
+        return 0;
+    }
+    Py_DECREF(path_bytes);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        close(fd);
+        return 0;
+    }
+
+    *len = (size_t)st.st_size;
+    *data = NULL;
+    if (*len > 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (sequential) flags |= MAP_POPULATE;
+#endif
+        void* mapped = mmap(NULL, *len, PROT_READ, flags, fd, 0);
+        if (mapped == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            close(fd);
+            return 0;
+        }
+        madvise(mapped, *len, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        *data = mapped;
+    }
+    close(fd);
+    return 1;
+}
+
+// parse_file(path_or_buffer, workers=0) - путь (str / os.PathLike) отображается через mmap,
+// иначе buffer protocol; workers=0 - по числу ядер
+static PyObject* py_parse_file(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "source", "workers", NULL };
+    PyObject* source;
+    Py_ssize_t workers = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", keywords, &source, &workers)) return NULL;
+    if (workers < 0) {
+        PyErr_SetString(PyExc_ValueError, "workers must be >= 0");
+        return NULL;
+    }
+
+    nmea_columns_t columns;
+    int ok;
+
+    if (PyUnicode_Check(source) || PyObject_HasAttrString(source, "__fspath__")) {
+        const char* data;
+        size_t len;
+        if (!map_file(source, &data, &len, 1)) return NULL;
+        ok = parse_buffer_to_columns(data ? data : "", len, (size_t)workers, &columns);
+        if (data) munmap((void*)data, len);
+    } else {
+        Py_buffer view;
+        if (PyObject_GetBuffer(source, &view, PyBUF_SIMPLE) < 0) return NULL;
+        ok = parse_buffer_to_columns(view.buf, (size_t)view.len, (size_t)workers, &columns);
+        PyBuffer_Release(&view);
+    }
+    if (!ok) return NULL;
+
+    PyObject* dict = columns_to_dict(&columns);
+    nmea_columns_free(&columns);
+    return dict;
+}
+
+// Путь индекса: явный index_path или "<путь лога>.idx"
+static PyObject* index_path_for(PyObject* path, PyObject* index_path) {
+    if (index_path && index_path != Py_None) {
+        Py_INCREF(index_path);
+        return index_path;
+    }
+    PyObject* fs_path = PyOS_FSPath(path);
+    if (!fs_path) return NULL;
+    PyObject* result = PyUnicode_Check(fs_path) ? PyUnicode_FromFormat("%U.idx", fs_path)
+                                                : PyBytes_FromFormat("%s.idx", PyBytes_AS_STRING(fs_path));
+    Py_DECREF(fs_path);
+    return result;
+}
+
+// Открытие файла индекса через stdio
+static FILE* open_index(PyObject* index_path, const char* mode) {
+    PyObject* path_bytes;
+    if (!PyUnicode_FSConverter(index_path, &path_bytes)) return NULL;
+    FILE* f = fopen(PyBytes_AS_STRING(path_bytes), mode);
+    Py_DECREF(path_bytes);
+    if (!f) PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, index_path);
+    return f;
+}
+
+// Упакованные записи индекса в растущем буфере
+typedef struct {
+    uint8_t* data;
+    size_t count;
+    size_t capacity;
+} index_buffer_t;
+
+static int index_buffer_append(index_buffer_t* buffer, const nmea_log_index_entry_t* entries, size_t n) {
+    if (buffer->count + n > buffer->capacity) {
+        size_t capacity = buffer->capacity * 2 + n;
+        uint8_t* grown = realloc(buffer->data, capacity * NMEA_LOG_INDEX_ENTRY_SIZE);
+        if (!grown) return 0;
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    for (size_t i = 0; i < n; i++) {
+        nmea_log_index_pack_entry(buffer->data + buffer->count++ * NMEA_LOG_INDEX_ENTRY_SIZE, &entries[i]);
+    }
+    return 1;
+}
+
+// Индекс всего лога (без GIL); 0 при нехватке памяти
+static int build_index_entries(const char* data, size_t len, uint32_t every, index_buffer_t* buffer) {
+    nmea_log_indexer_t* indexer = malloc(sizeof(nmea_log_indexer_t));
+    if (!indexer) return 0;
+    nmea_log_indexer_init(indexer, every);
+
+    int ok = 1;
+    for (size_t pos = 0; pos < len && ok; pos += NMEA_LOG_INDEX_SLICE) {
+        size_t piece = (len - pos < NMEA_LOG_INDEX_SLICE) ? len - pos : NMEA_LOG_INDEX_SLICE;
+        size_t n = nmea_log_indexer_feed(indexer, data + pos, piece);
+        ok = index_buffer_append(buffer, indexer->entries, n);
+    }
+    if (ok) {
+        size_t n = nmea_log_indexer_finish(indexer);
+        ok = index_buffer_append(buffer, indexer->entries, n);
+    }
+    free(indexer);
+    return ok;
+}
+
+// build_index(path, every=60, index_path=None) - индекс каждой every-й эпохи в файл
+// "<path>.idx"; возвращает число записей
+static PyObject* py_build_index(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "path", "every", "index_path", NULL };
+    PyObject* path;
+    unsigned int every = 60;
+    PyObject* index_path = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|IO", keywords, &path, &every, &index_path)) return NULL;
+    if (every == 0) {
+        PyErr_SetString(PyExc_ValueError, "every must be > 0");
+        return NULL;
+    }
+
+    const char* data;
+    size_t len;
+    if (!map_file(path, &data, &len, 1)) return NULL;
+
+    index_buffer_t buffer = { NULL, 0, 0 };
+    int ok;
+    Py_BEGIN_ALLOW_THREADS
+    ok = build_index_entries(data, len, every, &buffer);
+    Py_END_ALLOW_THREADS
+    if (data) munmap((void*)data, len);
+    if (!ok) {
+        free(buffer.data);
+        return PyErr_NoMemory();
+    }
+
+    PyObject* target = index_path_for(path, index_path);
+    FILE* f = target ? open_index(target, "wb") : NULL;
+    if (!f) {
+        Py_XDECREF(target);
+        free(buffer.data);
+        return NULL;
+    }
+
+    uint8_t header[NMEA_LOG_INDEX_HEADER_SIZE];
+    nmea_log_index_pack_header(header, every, len, buffer.count);
+    ok = fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+         fwrite(buffer.data, NMEA_LOG_INDEX_ENTRY_SIZE, buffer.count, f) == buffer.count;
+    ok = (fclose(f) == 0) && ok;
+    free(buffer.data);
+    if (!ok) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, target);
+        Py_DECREF(target);
+        return NULL;
+    }
+    Py_DECREF(target);
+    return PyLong_FromSize_t(buffer.count);
+}
+
+// Чтение файла индекса целиком; записи в куче
+static uint8_t* read_index(PyObject* index_path, uint32_t* every, uint64_t* source_size, size_t* count) {
+    FILE* f = open_index(index_path, "rb");
+    if (!f) return NULL;
+
+    uint8_t header[NMEA_LOG_INDEX_HEADER_SIZE];
+    uint64_t entries_count;
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+        !nmea_log_index_unpack_header(header, every, source_size, &entries_count)) {
+        fclose(f);
+        PyErr_SetString(PyExc_ValueError, "not an NMEA index file");
+        return NULL;
+    }
+
+    // Число записей из заголовка - не больше, чем помещается в файле, без переполнения размера
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0 || (uint64_t)st.st_size < NMEA_LOG_INDEX_HEADER_SIZE ||
+        entries_count > ((uint64_t)st.st_size - NMEA_LOG_INDEX_HEADER_SIZE) / NMEA_LOG_INDEX_ENTRY_SIZE ||
+        entries_count > SIZE_MAX / NMEA_LOG_INDEX_ENTRY_SIZE) {
+        fclose(f);
+        PyErr_SetString(PyExc_ValueError, "truncated NMEA index file");
+        return NULL;
+    }
+
+    uint8_t* entries = malloc(entries_count ? entries_count * NMEA_LOG_INDEX_ENTRY_SIZE : 1);
+    if (!entries) {
+        fclose(f);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    if (fread(entries, NMEA_LOG_INDEX_ENTRY_SIZE, entries_count, f) != entries_count) {
+        fclose(f);
+        free(entries);
+        PyErr_SetString(PyExc_ValueError, "truncated NMEA index file");
+        return NULL;
+    }
+    fclose(f);
+    *count = (size_t)entries_count;
+    return entries;
+}
+
+// read_range(path, from_ms, to_ms, index_path=None) - колонки эпох с from_ms <= time <= to_ms;
+// по индексу разбирается только нужный участок файла
+static PyObject* py_read_range(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "path", "from_ms", "to_ms", "index_path", NULL };
+    PyObject* path;
+    long long from_ms;
+    long long to_ms;
+    PyObject* index_path = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OLL|O", keywords, &path, &from_ms, &to_ms, &index_path)) {
+        return NULL;
+    }
+
+    PyObject* target = index_path_for(path, index_path);
+    if (!target) return NULL;
+    uint32_t every;
+    uint64_t source_size;
+    size_t count;
+    uint8_t* entries = read_index(target, &every, &source_size, &count);
+    Py_DECREF(target);
+    if (!entries) return NULL;
+
+    const char* data;
+    size_t len;
+    if (!map_file(path, &data, &len, 0)) {
+        free(entries);
+        return NULL;
+    }
+    if (source_size != len) {
+        free(entries);
+        if (data) munmap((void*)data, len);
+        PyErr_SetString(PyExc_ValueError, "index does not match log file, rebuild it with build_index");
+        return NULL;
+    }
+
+    uint64_t start;
+    uint64_t stop;
+    nmea_log_index_range(entries, count, every, from_ms, to_ms, &start, &stop);
+    free(entries);
+    if (stop > len) stop = len;
+    if (start > stop) start = stop;
+
+    nmea_columns_t columns;
+    int ok = parse_buffer_to_columns(data ? data + start : "", (size_t)(stop - start), 0, &columns);
+    if (data) munmap((void*)data, len);
+    if (!ok) return NULL;
+
+    nmea_columns_filter_time(&columns, from_ms, to_ms);
+    PyObject* dict = columns_to_dict(&columns);
+    nmea_columns_free(&columns);
+    return dict;
+}
+
+// Мультиплексор потоков от многих устройств (шлюз)
+typedef struct {
+    PyObject_HEAD
+    nmea_mux_t mux;
+    nmea_columns_t rows;    // общий буфер завершенных эпох всех устройств
+    uint32_t* device_ids;   // устройство каждой строки
+} MultiplexerObject;
+
+static void multiplexer_free_buffers(MultiplexerObject* self) {
+    PyMem_Free(self->mux.devices);
+    PyMem_Free(self->mux.table);
+    PyMem_Free(self->rows.time_ms);
+    PyMem_Free(self->rows.latitude);
+    PyMem_Free(self->rows.longitude);
+    PyMem_Free(self->rows.altitude);
+    PyMem_Free(self->rows.speed);
+    PyMem_Free(self->rows.hdop);
+    PyMem_Free(self->rows.satellites);
+    PyMem_Free(self->device_ids);
+    memset(&self->mux, 0, sizeof(self->mux));
+    memset(&self->rows, 0, sizeof(self->rows));
+    self->device_ids = NULL;
+}
+
+static void multiplexer_dealloc(MultiplexerObject* self) {
+    multiplexer_free_buffers(self);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// Место в буфере строк еще на extra строк
+static int multiplexer_reserve(MultiplexerObject* self, size_t extra) {
+    nmea_columns_t* rows = &self->rows;
+    if (rows->count + extra <= rows->capacity) return 1;
+
+    size_t capacity = rows->capacity * 2;
+    if (capacity < rows->count + extra) capacity = rows->count + extra;
+
+    void** columns[] = {
+        (void**)&rows->time_ms, (void**)&rows->latitude, (void**)&rows->longitude, (void**)&rows->altitude,
+        (void**)&rows->speed, (void**)&rows->hdop, (void**)&rows->satellites, (void**)&self->device_ids,
+    };
+    size_t item_sizes[] = { 8, 8, 8, 8, 8, 8, 1, 4 };
+    for (size_t i = 0; i < sizeof(item_sizes) / sizeof(item_sizes[0]); i++) {
+        void* grown = PyMem_Realloc(*columns[i], capacity * item_sizes[i]);
+        if (!grown) {
+            PyErr_NoMemory();
+            return 0;
+        }
+        *columns[i] = grown;
+    }
+    rows->capacity = capacity;
+    return 1;
+}
+
+// Multiplexer(max_devices, rows=256) - состояния max_devices устройств в одной арене
+static int multiplexer_init(MultiplexerObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "max_devices", "rows", NULL };
+    Py_ssize_t max_devices;
+    Py_ssize_t capacity = 256;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", keywords, &max_devices, &capacity)) return -1;
+    if (max_devices <= 0 || max_devices > INT32_MAX / 2) {
+        PyErr_SetString(PyExc_ValueError, "max_devices out of range");
+        return -1;
+    }
+    if (capacity <= 0) {
+        PyErr_SetString(PyExc_ValueError, "rows must be > 0");
+        return -1;
+    }
+
+    multiplexer_free_buffers(self);
+    nmea_mux_device_t* devices = PyMem_Malloc(max_devices * sizeof(nmea_mux_device_t));
+    int32_t* table = PyMem_Malloc(nmea_mux_table_size(max_devices) * sizeof(int32_t));
+    if (!devices || !table) {
+        PyMem_Free(devices);
+        PyMem_Free(table);
+        PyErr_NoMemory();
+        return -1;
+    }
+    nmea_mux_init(&self->mux, devices, table, max_devices);
+    return multiplexer_reserve(self, capacity) ? 0 : -1;
+}
+
+// Подача данных одного устройства
+static int multiplexer_feed_device(MultiplexerObject* self, uint32_t device_id, const char* data, size_t len) {
+    if (!multiplexer_reserve(self, NMEA_MUX_MAX_ROWS(len))) return 0;
+    if (nmea_mux_feed(&self->mux, device_id, data, len, &self->rows, self->device_ids) < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "too many devices");
+        return 0;
+    }
+    return 1;
+}
+
+// feed(device_id, buf) - данные устройства; возвращает число накопленных строк
+static PyObject* multiplexer_feed(MultiplexerObject* self, PyObject* args) {
+    unsigned int device_id;
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "Iy*", &device_id, &data)) return NULL;
+    int ok = multiplexer_feed_device(self, device_id, data.buf, (size_t)data.len);
+    PyBuffer_Release(&data);
+    if (!ok) return NULL;
+    return PyLong_FromSize_t(self->rows.count);
+}
+
+// Буфер целых без знака по 4 байта ('I' / 'L' там, где long - 32 бита)
+static int get_uint32_buffer(PyObject* obj, Py_buffer* view, const char* name) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT) < 0) return 0;
+    const char* format = view->format ? view->format : "B";
+    if (view->itemsize != 4 || (strcmp(format, "I") != 0 && strcmp(format, "L") != 0)) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_TypeError, "%s must be array('I')", name);
+        return 0;
+    }
+    return 1;
+}
+
+// feed_batch(device_ids, offsets, data) - фрагмент i - data[offsets[i]:offsets[i + 1]]
+// устройства device_ids[i]; device_ids/offsets - array('I')
+static PyObject* multiplexer_feed_batch(MultiplexerObject* self, PyObject* args) {
+    PyObject* ids_obj;
+    PyObject* offsets_obj;
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "OOy*", &ids_obj, &offsets_obj, &data)) return NULL;
+
+    Py_buffer ids, offsets;
+    if (!get_uint32_buffer(ids_obj, &ids, "device_ids")) {
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+    if (!get_uint32_buffer(offsets_obj, &offsets, "offsets")) {
+        PyBuffer_Release(&ids);
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+
+    size_t n = (size_t)ids.len / 4;
+    const uint32_t* id_items = ids.buf;
+    const uint32_t* offset_items = offsets.buf;
+    int ok = 1;
+    if ((size_t)offsets.len / 4 != n + 1) {
+        PyErr_SetString(PyExc_ValueError, "offsets must have len(device_ids) + 1 items");
+        ok = 0;
+    }
+    for (size_t i = 0; ok && i < n; i++) {
+        if (offset_items[i] > offset_items[i + 1] || offset_items[i + 1] > (size_t)data.len) {
+            PyErr_SetString(PyExc_ValueError, "offsets out of range");
+            ok = 0;
+            break;
+        }
+        ok = multiplexer_feed_device(self, id_items[i], (const char*)data.buf + offset_items[i],
+                                     offset_items[i + 1] - offset_items[i]);
+    }
+
+    PyBuffer_Release(&offsets);
+    PyBuffer_Release(&ids);
+    PyBuffer_Release(&data);
+    if (!ok) return NULL;
+    return PyLong_FromSize_t(self->rows.count);
+}
+
+// flush(device_id=None) - закрытие последней эпохи устройства (или всех) и сброс его состояния
+static PyObject* multiplexer_flush(MultiplexerObject* self, PyObject* args) {
+    PyObject* device_obj = Py_None;
+    if (!PyArg_ParseTuple(args, "|O", &device_obj)) return NULL;
+
+    if (device_obj != Py_None) {
+        unsigned long device_id = PyLong_AsUnsignedLong(device_obj);
+        if (PyErr_Occurred()) return NULL;
+        nmea_mux_device_t* device = nmea_mux_find(&self->mux, (uint32_t)device_id, 0);
+        if (device) {
+            if (!multiplexer_reserve(self, 1)) return NULL;
+            nmea_mux_flush(device, &self->rows, self->device_ids);
+        }
+    } else {
+        if (!multiplexer_reserve(self, self->mux.count)) return NULL;
+        for (size_t i = 0; i < self->mux.count; i++) {
+            nmea_mux_flush(&self->mux.devices[i], &self->rows, self->device_ids);
+        }
+    }
+    return PyLong_FromSize_t(self->rows.count);
+}
+
+// take() - накопленные строки как dict колонок (ключи parse_file + device) и очистка буфера
+static PyObject* multiplexer_take(MultiplexerObject* self, PyObject* unused) {
+    PyObject* dict = columns_to_dict(&self->rows);
+    if (!dict) return NULL;
+
+    PyObject* array_module = PyImport_ImportModule("array");
+    PyObject* array_type = array_module ? PyObject_GetAttrString(array_module, "array") : NULL;
+    Py_XDECREF(array_module);
+    int err = !array_type ||
+              dict_set_new(dict, "device", new_column(array_type, "I", self->device_ids, self->rows.count * 4));
+    Py_XDECREF(array_type);
+    if (err) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+
+    self->rows.count = 0;
+    return dict;
+}
+
+// devices() - число известных устройств
+static PyObject* multiplexer_devices(MultiplexerObject* self, PyObject* unused) {
+    return PyLong_FromSize_t(self->mux.count);
+}
+
+static PyMethodDef multiplexer_methods[] = {
+    { "feed", (PyCFunction)multiplexer_feed, METH_VARARGS, "Feed bytes received from one device" },
+    { "feed_batch", (PyCFunction)multiplexer_feed_batch, METH_VARARGS,
+      "Feed many device fragments packed into one buffer" },
+    { "flush", (PyCFunction)multiplexer_flush, METH_VARARGS, "Close the last epoch of a device (or all)" },
+    { "take", (PyCFunction)multiplexer_take, METH_NOARGS, "Return completed epochs as columns and clear them" },
+    { "devices", (PyCFunction)multiplexer_devices, METH_NOARGS, "Number of known devices" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject MultiplexerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.Multiplexer",
+    .tp_doc = "Per-device NMEA parser states in one arena",
+    .tp_basicsize = sizeof(MultiplexerObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)multiplexer_init,
+    .tp_dealloc = (destructor)multiplexer_dealloc,
+    .tp_methods = multiplexer_methods,
+};
+
+// Генератор синтетического трафика
+typedef struct {
+    PyObject_HEAD
+    nmea_gen_t gen;
+    PyThread_type_lock lock;    // fill()/write() работают без GIL: self->gen - под этой блокировкой
+} GeneratorObject;
+
+// Захват блокировки генератора; ожидание - без GIL (держатель блокировки GIL не берет)
+static int generator_lock(GeneratorObject* self) {
+    if (!self->lock) {
+        PyErr_SetString(PyExc_RuntimeError, "Generator is not initialised");
+        return 0;
+    }
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+    return 1;
+}
+
+static void generator_dealloc(GeneratorObject* self) {
+    if (self->lock) PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// Generator(trajectory="straight", rate=1, constellations=1, satellites=12,
+//           sentences="RMC,GGA,GSA,GSV,VTG", corrupt_ppm=0, seed=1, lat=, lon=, alt=, speed=,
+//           heading=, radius=, period=, event=, jump=, start_ms=)
+static int generator_init(GeneratorObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "trajectory", "rate", "constellations", "satellites", "sentences", "corrupt_ppm",
+                                "seed", "lat", "lon", "alt", "speed", "heading", "radius", "period", "event",
+                                "jump", "start_ms", NULL };
+    nmea_gen_config_t config;
+    nmea_gen_config_default(&config);
+    const char* trajectory = NULL;
+    const char* sentences = NULL;
+    int rate = config.rate_hz;
+    int constellations = config.constellations;
+    int satellites = config.satellites;
+    long corrupt_ppm = 0;
+    unsigned long seed = config.seed;
+    long long start_ms = config.start_ms;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|z$iiizlkdddddddddL", keywords, &trajectory, &rate,
+                                     &constellations, &satellites, &sentences, &corrupt_ppm, &seed,
+                                     &config.lat, &config.lon, &config.alt, &config.speed_mps,
+                                     &config.heading_deg, &config.radius_m, &config.period_s, &config.event_s,
+                                     &config.jump_m, &start_ms)) {
+        return -1;
+    }
+
+    if (trajectory) {
+        int value = nmea_gen_parse_trajectory(trajectory);
+        if (value < 0) {
+            PyErr_SetString(PyExc_ValueError, "unknown trajectory");
+            return -1;
+        }
+        config.trajectory = value;
+    }
+    if (sentences) {
+        int mask = nmea_gen_parse_sentences(sentences);
+        if (mask <= 0) {
+            PyErr_SetString(PyExc_ValueError, "unknown sentence in sentences");
+            return -1;
+        }
+        config.sentences = mask;
+    }
+    if (rate < 1 || rate > 100 || constellations < 1 || constellations > NMEA_GEN_MAX_CONSTELLATIONS ||
+        satellites < 0 || satellites > constellations * NMEA_GEN_MAX_SATS_PER_CONSTELLATION ||
+        corrupt_ppm < 0 || corrupt_ppm > 1000000) {
+        PyErr_SetString(PyExc_ValueError, "generator parameter out of range");
+        return -1;
+    }
+    config.rate_hz = rate;
+    config.constellations = constellations;
+    config.satellites = satellites;
+    config.corrupt_ppm = (uint32_t)corrupt_ppm;
+    config.seed = (uint32_t)seed;
+    config.start_ms = start_ms;
+
+    if (!self->lock) {
+        self->lock = PyThread_allocate_lock();
+        if (!self->lock) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    generator_lock(self);
+    int ok = nmea_gen_init(&self->gen, &config);
+    PyThread_release_lock(self->lock);
+    if (!ok) {
+        PyErr_SetString(PyExc_ValueError, "generator parameter out of range");
+        return -1;
+    }
+    return 0;
+}
+
+// fill(buf) - целые эпохи в записываемый буфер; возвращает число записанных байт
+static PyObject* generator_fill(GeneratorObject* self, PyObject* args) {
+    Py_buffer buf;
+    if (!PyArg_ParseTuple(args, "w*", &buf)) return NULL;
+    if ((size_t)buf.len < NMEA_GEN_MAX_EPOCH) {
+        PyBuffer_Release(&buf);
+        PyErr_SetString(PyExc_ValueError, "buffer too small for one epoch");
+        return NULL;
+    }
+    if (!generator_lock(self)) {
+        PyBuffer_Release(&buf);
+        return NULL;
+    }
+    size_t len;
+    Py_BEGIN_ALLOW_THREADS
+    len = nmea_gen_fill(&self->gen, buf.buf, (size_t)buf.len);
+    Py_END_ALLOW_THREADS
+    PyThread_release_lock(self->lock);
+    PyBuffer_Release(&buf);
+    return PyLong_FromSize_t(len);
+}
+
+// epoch() - следующая эпоха как bytes
+static PyObject* generator_epoch(GeneratorObject* self, PyObject* unused) {
+    char out[NMEA_GEN_MAX_EPOCH];
+    if (!generator_lock(self)) return NULL;
+    size_t len = nmea_gen_epoch(&self->gen, out);
+    PyThread_release_lock(self->lock);
+    return PyBytes_FromStringAndSize(out, (Py_ssize_t)len);
+}
+
+// write(path, size) - файл из целых эпох размером около size байт; возвращает его длину
+static PyObject* generator_write(GeneratorObject* self, PyObject* args) {
+    PyObject* path;
+    unsigned long long size;
+    if (!PyArg_ParseTuple(args, "OK", &path, &size)) return NULL;
+
+    size_t capacity = (1 << 20) + NMEA_GEN_MAX_EPOCH;
+    char* chunk = malloc(capacity);
+    if (!chunk) return PyErr_NoMemory();
+    FILE* f = open_index(path, "wb");
+    if (!f) {
+        free(chunk);
+        return NULL;
+    }
+
+    if (!generator_lock(self)) {
+        fclose(f);
+        free(chunk);
+        return NULL;
+    }
+    unsigned long long written = 0;
+    int ok = 1;
+    Py_BEGIN_ALLOW_THREADS
+    while (ok && written < size) {
+        size_t len = nmea_gen_fill(&self->gen, chunk, capacity);
+        ok = fwrite(chunk, 1, len, f) == len;
+        written += len;
+    }
+    ok = (fclose(f) == 0) && ok;
+    Py_END_ALLOW_THREADS
+    PyThread_release_lock(self->lock);
+    free(chunk);
+    if (!ok) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return NULL;
+    }
+    return PyLong_FromUnsignedLongLong(written);
+}
+
+// truth() - истинное состояние последней эпохи: (time_ms, lat, lon, alt, speed, course, fix)
+static PyObject* generator_truth(GeneratorObject* self, PyObject* unused) {
+    if (!generator_lock(self)) return NULL;
+    const nmea_gen_t* gen = &self->gen;
+    PyObject* result = Py_BuildValue("(LdddddO)", (long long)gen->time_ms, gen->out_lat, gen->out_lon,
+                                     gen->config.alt, gen->speed_mps, gen->heading_deg,
+                                     gen->fix ? Py_True : Py_False);
+    PyThread_release_lock(self->lock);
+    return result;
+}
+
+static PyMethodDef generator_methods[] = {
+    { "fill", (PyCFunction)generator_fill, METH_VARARGS, "Write whole epochs into a writable buffer" },
+    { "epoch", (PyCFunction)generator_epoch, METH_NOARGS, "Return the next epoch as bytes" },
+    { "write", (PyCFunction)generator_write, METH_VARARGS, "Write about size bytes of whole epochs to a file" },
+    { "truth", (PyCFunction)generator_truth, METH_NOARGS, "True state of the last generated epoch" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject GeneratorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.Generator",
+    .tp_doc = "Synthetic NMEA / UBX traffic along a parametrised trajectory",
+    .tp_basicsize = sizeof(GeneratorObject),
+    .tp_dealloc = (destructor)generator_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)generator_init,
+    .tp_methods = generator_methods,
+};
+
+// Вещественное значение ключа словаря или NAN (нет ключа, None); -1 при ошибке
+static int dict_get_double(PyObject* dict, const char* key, double* value) {
+    PyObject* item = PyDict_GetItemString(dict, key);
+    *value = NAN;
+    if (!item || item == Py_None) return 0;
+    *value = PyFloat_AsDouble(item);
+    return (*value == -1.0 && PyErr_Occurred()) ? -1 : 0;
+}
+
+// Целое значение ключа словаря; 0 - нет ключа, 1 - есть, -1 при ошибке
+static int dict_get_long(PyObject* dict, const char* key, long* value) {
+    PyObject* item = PyDict_GetItemString(dict, key);
+    if (!item || item == Py_None) return 0;
+    *value = PyLong_AsLong(item);
+    return (*value == -1 && PyErr_Occurred()) ? -1 : 1;
+}
+
+// gps_data_t из словаря в формате parse()/current(); отсутствующие ключи - пустые поля
+static int gps_data_from_dict(PyObject* dict, gps_data_t* gps_data) {
+    if (!PyDict_Check(dict)) {
+        PyErr_SetString(PyExc_TypeError, "fix must be a dict");
+        return 0;
+    }
+    gps_data_init(gps_data);
+
+    PyObject* valid = PyDict_GetItemString(dict, "valid");
+    gps_data->valid = valid ? PyObject_IsTrue(valid) == 1 : 0;
+    if (dict_get_double(dict, "latitude", &gps_data->latitude) < 0 ||
+        dict_get_double(dict, "longitude", &gps_data->longitude) < 0 ||
+        dict_get_double(dict, "altitude", &gps_data->altitude) < 0 ||
+        dict_get_double(dict, "speed", &gps_data->speed) < 0 ||
+        dict_get_double(dict, "course", &gps_data->course) < 0 ||
+        dict_get_double(dict, "hdop", &gps_data->hdop) < 0 ||
+        dict_get_double(dict, "vdop", &gps_data->vdop) < 0 ||
+        dict_get_double(dict, "pdop", &gps_data->pdop) < 0) {
+        return 0;
+    }
+
+    long value;
+    int found = dict_get_long(dict, "satellites_used", &value);
+    if (found < 0) return 0;
+    if (found) {
+        gps_data->satellites_used = (uint8_t)value;
+        gps_data->has_satellites_used = 1;
+    }
+    found = dict_get_long(dict, "fix_type", &value);
+    if (found < 0) return 0;
+    gps_data->fix_type = found ? (uint8_t)value : (gps_data->valid ? 1 : 0);
+
+    // date [день, месяц, год], time [часы, минуты, секунды]
+    PyObject* date = PyDict_GetItemString(dict, "date");
+    if (date) {
+        PyObject* tuple = PySequence_Tuple(date);
+        int day, month, year;
+        int ok = tuple && PyArg_ParseTuple(tuple, "iii", &day, &month, &year);
+        Py_XDECREF(tuple);
+        if (!ok) return 0;
+        gps_data->day = day;
+        gps_data->month = month;
+        gps_data->year = year;
+    }
+    PyObject* time = PyDict_GetItemString(dict, "time");
+    if (time) {
+        PyObject* tuple = PySequence_Tuple(time);
+        int hour, minute;
+        double second;
+        int ok = tuple && PyArg_ParseTuple(tuple, "iid", &hour, &minute, &second);
+        Py_XDECREF(tuple);
+        if (!ok) return 0;
+        gps_data->hour = hour;
+        gps_data->minute = minute;
+        gps_data->second = (uint8_t)second;
+        gps_data->millisecond = (uint16_t)((second - gps_data->second) * 1000.0 + 0.5);
+    }
+    return 1;
+}
+
+// Словарь fix или текущее состояние (fix = None); 0 при ошибке
+static int fix_or_current(PyObject* fix, gps_data_t* gps_data) {
+    if (fix != Py_None) return gps_data_from_dict(fix, gps_data);
+    if (!gps_data_initialized) {
+        gps_data_init(&current_gps_data);
+        gps_data_initialized = 1;
+    }
+    *gps_data = current_gps_data;
+    return 1;
+}
+
+// Общий разбор аргументов encode/encode_into
+static int encode_args(const char* sentences_list, PyObject* fix, const char* talker, gps_data_t* gps_data) {
+    int sentences = nmea_encode_parse_sentences(sentences_list);
+    if (sentences <= 0) {
+        PyErr_SetString(PyExc_ValueError, "sentences must list RMC, GGA, GSA, VTG");
+        return 0;
+    }
+    if (strlen(talker) != 2) {
+        PyErr_SetString(PyExc_ValueError, "talker must be 2 characters");
+        return 0;
+    }
+    if (!fix_or_current(fix, gps_data)) return 0;
+    return sentences;
+}
+
+// encode(sentences, fix=None, talker="GP") - предложения "RMC,GGA,GSA,VTG" из текущих данных
+// или словаря fix с контрольными суммами; возвращает bytes
+static PyObject* py_encode(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "sentences", "fix", "talker", NULL };
+    const char* sentences_list;
+    PyObject* fix = Py_None;
+    const char* talker = "GP";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|Os", keywords, &sentences_list, &fix, &talker)) return NULL;
+
+    gps_data_t gps_data;
+    int sentences = encode_args(sentences_list, fix, talker, &gps_data);
+    if (!sentences) return NULL;
+
+    char out[4 * NMEA_ENCODE_MAX_SENTENCE];
+    size_t len = nmea_encode_epoch(&gps_data, sentences, talker, out, sizeof(out));
+    return PyBytes_FromStringAndSize(out, (Py_ssize_t)len);
+}
+
+// encode_into(buf, sentences, fix=None, talker="GP") - то же в записываемый буфер; возвращает длину
+static PyObject* py_encode_into(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "buf", "sentences", "fix", "talker", NULL };
+    Py_buffer buf;
+    const char* sentences_list;
+    PyObject* fix = Py_None;
+    const char* talker = "GP";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "w*s|Os", keywords, &buf, &sentences_list, &fix, &talker)) {
+        return NULL;
+    }
+
+    gps_data_t gps_data;
+    int sentences = encode_args(sentences_list, fix, talker, &gps_data);
+    size_t len = sentences ? nmea_encode_epoch(&gps_data, sentences, talker, buf.buf, (size_t)buf.len) : 0;
+    PyBuffer_Release(&buf);
+    if (!sentences) return NULL;
+    if (len == 0) {
+        PyErr_SetString(PyExc_ValueError, "buffer too small");
+        return NULL;
+    }
+    return PyLong_FromSize_t(len);
+}
+
+// mga_ini(now_ms, fix=None, speed=1.0, drift_ppm=50.0) - UBX-MGA-INI-POS_LLH и MGA-INI-TIME_UTC
+// для горячего старта из последнего фикса и времени now_ms (UTC, мс от 1970-01-01)
+static PyObject* py_mga_ini(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "now_ms", "fix", "speed", "drift_ppm", NULL };
+    long long now_ms;
+    PyObject* fix = Py_None;
+    ubx_assist_config_t config;
+    ubx_assist_config_default(&config);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "L|Odd", keywords, &now_ms, &fix, &config.speed_mps,
+                                     &config.drift_ppm)) {
+        return NULL;
+    }
+    if (!(config.speed_mps >= 0.0) || !(config.drift_ppm >= 0.0)) {
+        PyErr_SetString(PyExc_ValueError, "speed and drift_ppm must be >= 0");
+        return NULL;
+    }
+    gps_data_t gps_data;
+    if (!fix_or_current(fix, &gps_data)) return NULL;
+
+    uint8_t out[UBX_ASSIST_HOT_START_MAX];
+    size_t len = ubx_assist_hot_start(out, &gps_data, (int64_t)now_ms, &config);
+    return PyBytes_FromStringAndSize((const char*)out, (Py_ssize_t)len);
+}
+
+// nav_sat(frame) - кадр UBX-NAV-SAT целиком в таблицу спутников; число спутников
+static PyObject* py_nav_sat(PyObject* self, PyObject* args) {
+    Py_buffer frame;
+    if (!PyArg_ParseTuple(args, "y*", &frame)) return NULL;
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame.buf, (size_t)frame.len, UBX_CLASS_NAV, UBX_NAV_SAT,
+                                               &payload_len);
+    int count = payload ? ubx_nav_sat_decode(&sat_table, payload, payload_len) : -1;
+    PyBuffer_Release(&frame);
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "not a valid UBX-NAV-SAT frame");
+        return NULL;
+    }
+    return PyLong_FromLong(count);
+}
+
+// satellites() - колонки таблицы как memoryview без копирования (до следующего nav_sat())
+static PyObject* py_satellites(PyObject* self, PyObject* unused) {
+    static const struct { const char* name; const char* format; size_t offset; size_t item_size; } columns[] = {
+        { "gnss_id", "B", offsetof(ubx_sat_table_t, gnss_id), 1 },
+        { "sv_id", "B", offsetof(ubx_sat_table_t, sv_id), 1 },
+        { "cno", "B", offsetof(ubx_sat_table_t, cno), 1 },
+        { "elevation", "b", offsetof(ubx_sat_table_t, elevation), 1 },
+        { "azimuth", "h", offsetof(ubx_sat_table_t, azimuth), 2 },
+        { "residual_dm", "h", offsetof(ubx_sat_table_t, residual_dm), 2 },
+        { "flags", "I", offsetof(ubx_sat_table_t, flags), 4 },
+    };
+    PyObject* dict = PyDict_New();
+    if (!dict) return NULL;
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        PyObject* raw = PyMemoryView_FromMemory((char*)&sat_table + columns[i].offset,
+                                                (Py_ssize_t)(sat_table.count * columns[i].item_size), PyBUF_READ);
+        PyObject* view = raw ? PyObject_CallMethod(raw, "cast", "s", columns[i].format) : NULL;
+        Py_XDECREF(raw);
+        if (dict_set_new(dict, columns[i].name, view) < 0) {
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+    if (dict_set_new(dict, "itow", PyLong_FromUnsignedLong(sat_table.itow_ms)) < 0 ||
+        dict_set_new(dict, "dropped", PyLong_FromLong(sat_table.dropped)) < 0 ||
+        dict_set_new(dict, "epochs", PyLong_FromUnsignedLong(sat_table.epochs)) < 0) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+    return dict;
+}
+
+// tim_tp(frame) - кадр UBX-TIM-TP: метка следующего импульса PPS
+static PyObject* py_tim_tp(PyObject* self, PyObject* args) {
+    Py_buffer frame;
+    if (!PyArg_ParseTuple(args, "y*", &frame)) return NULL;
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame.buf, (size_t)frame.len, UBX_CLASS_TIM, UBX_TIM_TP,
+                                               &payload_len);
+    int result = payload ? ubx_tim_tp_decode(&timepulse, payload, payload_len) : -1;
+    PyBuffer_Release(&frame);
+    if (result < 0) {
+        PyErr_SetString(PyExc_ValueError, "not a valid UBX-TIM-TP frame in UTC or GPS time base");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+// nav_timeutc(frame) - кадр UBX-NAV-TIMEUTC; UTC эпохи (мс от 1970-01-01) или None
+static PyObject* py_nav_timeutc(PyObject* self, PyObject* args) {
+    Py_buffer frame;
+    if (!PyArg_ParseTuple(args, "y*", &frame)) return NULL;
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame.buf, (size_t)frame.len, UBX_CLASS_NAV, UBX_NAV_TIMEUTC,
+                                               &payload_len);
+    int64_t utc_ms;
+    int result = payload ? ubx_nav_timeutc_decode(&timepulse, payload, payload_len, &utc_ms) : -1;
+    PyBuffer_Release(&frame);
+    if (result < 0) {
+        PyErr_SetString(PyExc_ValueError, "not a valid UBX-NAV-TIMEUTC frame");
+        return NULL;
+    }
+    if (!result) Py_RETURN_NONE;
+    return PyLong_FromLongLong(utc_ms);
+}
+
+// pps(ticks_us) - фронт PPS в тиках вызывающего
+static PyObject* py_pps(PyObject* self, PyObject* args) {
+    unsigned long long ticks;
+    if (!PyArg_ParseTuple(args, "K", &ticks)) return NULL;
+    ubx_timepulse_edge(&timepulse, ticks);
+    Py_RETURN_NONE;
+}
+
+// pps_utc(ticks_us) - UTC момента ticks_us в нс от 1970-01-01 или None
+static PyObject* py_pps_utc(PyObject* self, PyObject* args) {
+    unsigned long long ticks;
+    if (!PyArg_ParseTuple(args, "K", &ticks)) return NULL;
+    int64_t utc_ns;
+    if (!ubx_timepulse_utc_ns(&timepulse, ticks, &utc_ns)) Py_RETURN_NONE;
+    return PyLong_FromLongLong(utc_ns);
+}
+
+// pps_status() - (импульсов, отброшено, уход ppm, qErr пс, точность нс, секунды координации)
+static PyObject* py_pps_status(PyObject* self, PyObject* unused) {
+    double drift = (timepulse.rate > 0.0) ? (timepulse.ns_per_tick / timepulse.rate - 1.0) * 1e6 : 0.0;
+    return Py_BuildValue("(IIdiIi)", timepulse.pulses, timepulse.rejected, drift, timepulse.qerr_ps,
+                         timepulse.t_acc_ns, timepulse.leap_seconds);
+}
+
+// clock_sample(ticks_ms, utc_ms) - пара (тики прихода эпохи, UTC эпохи) для модели часов;
+// True - принята, False - выброс
+static PyObject* py_clock_sample(PyObject* self, PyObject* args) {
+    unsigned long long ticks;
+    long long utc_ms;
+    if (!PyArg_ParseTuple(args, "KL", &ticks, &utc_ms)) return NULL;
+    return PyBool_FromLong(nmea_clock_add(&clock_model, ticks, (int64_t)utc_ms));
+}
+
+// utc_from_ticks(ticks_ms) - UTC (мс от 1970-01-01) или None, пока модели нет
+static PyObject* py_utc_from_ticks(PyObject* self, PyObject* args) {
+    unsigned long long ticks;
+    if (!PyArg_ParseTuple(args, "K", &ticks)) return NULL;
+    double utc;
+    if (!nmea_clock_utc_ms(&clock_model, ticks, &utc)) Py_RETURN_NONE;
+    return PyLong_FromLongLong((long long)floor(utc + 0.5));
+}
+
+// utc_from_ticks_batch(ticks, out) - ticks: array('I') / array('q') / array('Q'),
+// out: array('q') или array('d'); число значений
+static PyObject* py_utc_from_ticks_batch(PyObject* self, PyObject* args) {
+    PyObject* ticks_obj;
+    PyObject* out_obj;
+    if (!PyArg_ParseTuple(args, "OO", &ticks_obj, &out_obj)) return NULL;
+    Py_buffer ticks_buf, out_buf;
+    if (PyObject_GetBuffer(ticks_obj, &ticks_buf, PyBUF_FORMAT) < 0) return NULL;
+    if (PyObject_GetBuffer(out_obj, &out_buf, PyBUF_FORMAT | PyBUF_WRITABLE) < 0) {
+        PyBuffer_Release(&ticks_buf);
+        return NULL;
+    }
+
+    const char* ticks_format = ticks_buf.format ? ticks_buf.format : "B";
+    const char* out_format = out_buf.format ? out_buf.format : "B";
+    int out_double = strcmp(out_format, "d") == 0;
+    Py_ssize_t count = ticks_buf.itemsize ? ticks_buf.len / ticks_buf.itemsize : 0;
+    const char* error = NULL;
+    if ((ticks_buf.itemsize != 4 && ticks_buf.itemsize != 8) || strchr("iIlLqQ", ticks_format[0]) == NULL) {
+        error = "ticks must be a 32- or 64-bit integer array";
+    } else if (out_buf.itemsize != 8 || (!out_double && strcmp(out_format, "q") != 0)) {
+        error = "out must be array('q') or array('d')";
+    } else if (out_buf.len / 8 < count) {
+        error = "buffers must have the same length";
+    } else if (!clock_model.valid) {
+        error = "no clock model yet";
+    }
+    if (error) {
+        PyBuffer_Release(&ticks_buf);
+        PyBuffer_Release(&out_buf);
+        PyErr_SetString(PyExc_ValueError, error);
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++) {
+        uint64_t ticks = (ticks_buf.itemsize == 8) ? ((const uint64_t*)ticks_buf.buf)[i]
+                                                   : ((const uint32_t*)ticks_buf.buf)[i];
+        double utc;
+        nmea_clock_utc_ms(&clock_model, ticks, &utc);
+        if (out_double) {
+            ((double*)out_buf.buf)[i] = utc;
+        } else {
+            ((int64_t*)out_buf.buf)[i] = (int64_t)floor(utc + 0.5);
+        }
+    }
+    PyBuffer_Release(&ticks_buf);
+    PyBuffer_Release(&out_buf);
+    return PyLong_FromSsize_t(count);
+}
+
+// clock_status() - (принято пар, отброшено, уход часов ppm, СКО невязок мс, пар в окне)
+static PyObject* py_clock_status(PyObject* self, PyObject* unused) {
+    double drift = clock_model.valid ? nmea_clock_drift_ppm(&clock_model) : 0.0;
+    return Py_BuildValue("(IIddi)", clock_model.samples, clock_model.rejected, drift, clock_model.rms_ms,
+                         (int)clock_model.count);
+}
+
+// mon_rf(frame) / mon_hw(frame) - кадр UBX-MON-RF / UBX-MON-HW целиком: помехи, AGC, шум, антенна
+static PyObject* rf_feed_mon(PyObject* args, uint8_t id, const char* error) {
+    Py_buffer frame;
+    if (!PyArg_ParseTuple(args, "y*", &frame)) return NULL;
+    size_t payload_len;
+    const uint8_t* payload = ubx_frame_payload(frame.buf, (size_t)frame.len, UBX_CLASS_MON, id, &payload_len);
+    int result = -1;
+    if (payload) {
+        result = (id == UBX_MON_RF) ? nmea_rf_mon_rf(&rf_monitor, payload, payload_len)
+                                    : nmea_rf_mon_hw(&rf_monitor, payload, payload_len);
+    }
+    PyBuffer_Release(&frame);
+    if (PyErr_Occurred()) return NULL;
+    if (result < 0) {
+        PyErr_SetString(PyExc_ValueError, error);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_mon_rf(PyObject* self, PyObject* args) {
+    return rf_feed_mon(args, UBX_MON_RF, "not a valid UBX-MON-RF frame");
+}
+
+static PyObject* py_mon_hw(PyObject* self, PyObject* args) {
+    return rf_feed_mon(args, UBX_MON_HW, "not a valid UBX-MON-HW frame");
+}
+
+// rf_status() - (тревоги, jammingState, jamInd, antStatus, antPower, noisePerMS, agcCnt, кадров MON, эпох)
+static PyObject* py_rf_status(PyObject* self, PyObject* unused) {
+    return Py_BuildValue("(IiiiiiiII)", rf_monitor.alerts, rf_monitor.jamming_state, rf_monitor.jam_ind,
+                         rf_monitor.antenna_status, rf_monitor.antenna_power, rf_monitor.noise_per_ms,
+                         rf_monitor.agc_cnt, rf_monitor.hw_messages, rf_monitor.epochs);
+}
+
+// (сигналов, среднее, мин, макс, скользящее среднее, гистограмма memoryview('H')) системы
+static PyObject* cno_system_tuple(int system) {
+    nmea_rf_cno_t* cno = &rf_monitor.cno[system];
+    PyObject* raw = PyMemoryView_FromMemory((char*)cno->hist, sizeof(cno->hist), PyBUF_READ);
+    PyObject* hist = raw ? PyObject_CallMethod(raw, "cast", "s", "H") : NULL;
+    Py_XDECREF(raw);
+    if (!hist) return NULL;
+    return Py_BuildValue("(idiidN)", cno->count, (double)cno->mean, cno->min, cno->max,
+                         (double)cno->rolling_mean, hist);
+}
+
+// cno_stats([system]) - статистика C/N0 последней эпохи системы 0..4 или кортеж по всем
+static PyObject* py_cno_stats(PyObject* self, PyObject* args) {
+    int system = -1;
+    if (!PyArg_ParseTuple(args, "|i", &system)) return NULL;
+    if (system < -1 || system >= NMEA_RF_SYSTEMS) {
+        PyErr_SetString(PyExc_ValueError, "system must be 0..4");
+        return NULL;
+    }
+    if (system >= 0) return cno_system_tuple(system);
+    PyObject* result = PyTuple_New(NMEA_RF_SYSTEMS);
+    if (!result) return NULL;
+    for (int i = 0; i < NMEA_RF_SYSTEMS; i++) {
+        PyObject* item = cno_system_tuple(i);
+        if (!item) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(result, i, item);
+    }
+    return result;
+}
+
+// Вызов обработчика Python только при смене набора тревог; исключение остается установленным
+// и возвращается из parse() / mon_rf() / mon_hw()
+static void rf_alert_python(uint32_t alerts, uint32_t changed, void* context) {
+    if (!rf_callback || PyErr_Occurred()) return;
+    PyObject* result = PyObject_CallFunction(rf_callback, "II", alerts, changed);
+    Py_XDECREF(result);
+}
+
+// rf_alerts(callback, jam_ind=-1, cno_min, cno_drop) - callback(alerts, changed) при смене набора
+// тревог RF_*; None - отключить; не заданные пороги (jam_ind=-1) не меняются
+static PyObject* py_rf_alerts(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "callback", "jam_ind", "cno_min", "cno_drop", NULL };
+    PyObject* callback;
+    int jam_ind = -1;
+    double cno_min = rf_monitor.cno_min;
+    double cno_drop = rf_monitor.cno_drop;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|idd", keywords, &callback, &jam_ind, &cno_min, &cno_drop)) {
+        return NULL;
+    }
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable or None");
+        return NULL;
+    }
+    if (jam_ind < -1 || jam_ind > 255) {
+        PyErr_SetString(PyExc_ValueError, "jam_ind must be 0..255");
+        return NULL;
+    }
+    if (jam_ind >= 0) rf_monitor.jam_ind_max = (uint8_t)jam_ind;
+    rf_monitor.cno_min = (float)cno_min;
+    rf_monitor.cno_drop = (float)cno_drop;
+
+    Py_CLEAR(rf_callback);
+    if (callback != Py_None) {
+        Py_INCREF(callback);
+        rf_callback = callback;
+        rf_monitor.callback = rf_alert_python;
+    } else {
+        rf_monitor.callback = NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+// Пересылка выбранных предложений без изменений
+typedef struct {
+    PyObject_HEAD
+    nmea_router_t router;
+} RouterObject;
+
+// Router(types=None, validate=True) - types "GGA,RMC,TXT" (по умолчанию все)
+static int router_init(RouterObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "types", "validate", NULL };
+    const char* types = NULL;
+    int validate = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|zp", keywords, &types, &validate)) return -1;
+    if (!nmea_router_init(&self->router, types, validate)) {
+        PyErr_SetString(PyExc_ValueError, "types must be 3-letter sentence types, at most 16");
+        return -1;
+    }
+    return 0;
+}
+
+// route(data) - выбранные полные строки фрагмента как bytes
+static PyObject* router_route(RouterObject* self, PyObject* args) {
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "y*", &data)) return NULL;
+
+    PyObject* result = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)NMEA_ROUTER_MAX_OUTPUT((size_t)data.len));
+    if (!result) {
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+    // Под GIL: nmea_router_feed изменяет self->router, один Router может быть у нескольких потоков
+    size_t len = nmea_router_feed(&self->router, data.buf, (size_t)data.len, PyBytes_AS_STRING(result));
+    PyBuffer_Release(&data);
+    if (_PyBytes_Resize(&result, (Py_ssize_t)len) < 0) return NULL;
+    return result;
+}
+
+// stats() - (пропущено, отброшено) строк
+static PyObject* router_stats(RouterObject* self, PyObject* unused) {
+    return Py_BuildValue("(II)", self->router.passed, self->router.dropped);
+}
+
+static PyMethodDef router_methods[] = {
+    { "route", (PyCFunction)router_route, METH_VARARGS, "Return the selected complete sentences verbatim" },
+    { "stats", (PyCFunction)router_stats, METH_NOARGS, "(passed, dropped) line counters" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject RouterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.Router",
+    .tp_doc = "Passthrough of selected NMEA sentences without re-formatting",
+    .tp_basicsize = sizeof(RouterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)router_init,
+    .tp_methods = router_methods,
+};
+
+// Битовая упаковка фиксов для LPWAN
+typedef struct {
+    PyObject_HEAD
+    nmea_pack_frame_t frame;
+} PackerObject;
+
+// Packer(budget=51, lat_bits=24, lon_bits=24, alt_bits=12, speed_bits=7, hdop_bits=4, fix_bits=3,
+//        time_bits=0, delta_bits=12, time_delta_bits=8, alt_min=-500, alt_max=8000, speed_max=63, hdop_max=7)
+static int packer_init(PackerObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "budget", "lat_bits", "lon_bits", "alt_bits", "speed_bits", "hdop_bits",
+                                "fix_bits", "time_bits", "delta_bits", "time_delta_bits", "alt_min", "alt_max",
+                                "speed_max", "hdop_max", NULL };
+    nmea_pack_layout_t layout;
+    nmea_pack_layout_default(&layout);
+    int budget = 51;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i$bbbbbbbbbdddd", keywords, &budget,
+                                     &layout.lat_bits, &layout.lon_bits, &layout.alt_bits, &layout.speed_bits,
+                                     &layout.hdop_bits, &layout.fix_bits, &layout.time_bits, &layout.delta_bits,
+                                     &layout.time_delta_bits, &layout.alt_min, &layout.alt_max,
+                                     &layout.speed_max, &layout.hdop_max)) {
+        return -1;
+    }
+    if (budget < 1 || budget > NMEA_PACK_MAX_FRAME || !nmea_pack_frame_init(&self->frame, &layout, (size_t)budget)) {
+        PyErr_SetString(PyExc_ValueError, "packer layout out of range");
+        return -1;
+    }
+    return 0;
+}
+
+// add(fix=None) - текущий фикс или словарь fix в кадр; False, если не помещается (кадр пора отправить)
+static PyObject* packer_add(PackerObject* self, PyObject* args) {
+    PyObject* fix = Py_None;
+    if (!PyArg_ParseTuple(args, "|O", &fix)) return NULL;
+    gps_data_t gps_data;
+    if (!fix_or_current(fix, &gps_data)) return NULL;
+    return PyBool_FromLong(nmea_pack_frame_add(&self->frame, &gps_data));
+}
+
+// frame() - накопленный кадр как bytes (пустой, если точек нет); начинает новый кадр
+static PyObject* packer_frame(PackerObject* self, PyObject* unused) {
+    PyObject* result = PyBytes_FromStringAndSize((const char*)self->frame.data,
+                                                 (Py_ssize_t)nmea_pack_frame_size(&self->frame));
+    nmea_pack_frame_reset(&self->frame);
+    return result;
+}
+
+// frame_into(buf) - то же в записываемый буфер; возвращает длину
+static PyObject* packer_frame_into(PackerObject* self, PyObject* args) {
+    Py_buffer buf;
+    if (!PyArg_ParseTuple(args, "w*", &buf)) return NULL;
+    size_t len = nmea_pack_frame_size(&self->frame);
+    if (len > (size_t)buf.len) {
+        PyBuffer_Release(&buf);
+        PyErr_SetString(PyExc_ValueError, "buffer too small");
+        return NULL;
+    }
+    memcpy(buf.buf, self->frame.data, len);
+    PyBuffer_Release(&buf);
+    nmea_pack_frame_reset(&self->frame);
+    return PyLong_FromSize_t(len);
+}
+
+// pack(fix=None) - кадр из одной точки, не трогая накопленный
+static PyObject* packer_pack(PackerObject* self, PyObject* args) {
+    PyObject* fix = Py_None;
+    if (!PyArg_ParseTuple(args, "|O", &fix)) return NULL;
+    gps_data_t gps_data;
+    if (!fix_or_current(fix, &gps_data)) return NULL;
+
+    nmea_pack_frame_t single;
+    nmea_pack_frame_init(&single, &self->frame.layout, NMEA_PACK_MAX_FRAME);
+    nmea_pack_frame_add(&single, &gps_data);
+    return PyBytes_FromStringAndSize((const char*)single.data, (Py_ssize_t)nmea_pack_frame_size(&single));
+}
+
+// Значение в словарь с передачей ссылки; 0 при ошибке
+static int dict_set_steal(PyObject* dict, const char* key, PyObject* value) {
+    int ok = value && PyDict_SetItemString(dict, key, value) == 0;
+    Py_XDECREF(value);
+    return ok;
+}
+
+// unpack(data) - список словарей точек кадра (сторона сервера, та же раскладка)
+static PyObject* packer_unpack(PackerObject* self, PyObject* args) {
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "y*", &data)) return NULL;
+    nmea_pack_fix_t fixes[NMEA_PACK_MAX_POINTS];
+    int count = nmea_pack_decode(&self->frame.layout, data.buf, (size_t)data.len, fixes);
+    PyBuffer_Release(&data);
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "frame does not match layout");
+        return NULL;
+    }
+
+    PyObject* list = PyList_New(count);
+    if (!list) return NULL;
+    for (int i = 0; i < count; i++) {
+        const nmea_pack_fix_t* fix = &fixes[i];
+        PyObject* dict = PyDict_New();
+        if (!dict) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, dict);
+
+        int ok = dict_set_steal(dict, "valid", PyBool_FromLong(fix->valid));
+        static const char* const names[] = { "latitude", "longitude", "altitude", "speed", "hdop" };
+        const double values[] = { fix->latitude, fix->longitude, fix->altitude, fix->speed, fix->hdop };
+        for (size_t k = 0; ok && k < sizeof(values) / sizeof(values[0]); k++) {
+            if (!isnan(values[k])) ok = dict_set_steal(dict, names[k], PyFloat_FromDouble(values[k]));
+        }
+        if (ok && fix->fix_type >= 0) ok = dict_set_steal(dict, "fix_type", PyLong_FromLong(fix->fix_type));
+        if (ok && fix->time_of_day >= 0) {
+            ok = dict_set_steal(dict, "time_of_day", PyLong_FromLong(fix->time_of_day));
+        }
+        if (!ok) {
+            Py_DECREF(list);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+static PyMethodDef packer_methods[] = {
+    { "add", (PyCFunction)packer_add, METH_VARARGS, "Add the current fix (or a fix dict) to the frame; False if full" },
+    { "frame", (PyCFunction)packer_frame, METH_NOARGS, "Return the accumulated frame as bytes and start a new one" },
+    { "frame_into", (PyCFunction)packer_frame_into, METH_VARARGS, "Copy the frame into a writable buffer" },
+    { "pack", (PyCFunction)packer_pack, METH_VARARGS, "Single-point frame of the current fix (or a fix dict)" },
+    { "unpack", (PyCFunction)packer_unpack, METH_VARARGS, "Decode a frame into a list of fix dicts" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject PackerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.Packer",
+    .tp_doc = "Bit-packed LPWAN payload encoder and decoder with multi-fix delta frames",
+    .tp_basicsize = sizeof(PackerObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)packer_init,
+    .tp_methods = packer_methods,
+};
+
+// Потоковая загрузка AssistNow: file.read(n), uart.write(b), uart.read(n) - любые объекты с этими
+// методами (файл, pyserial, имитатор приемника в тестах)
+typedef struct {
+    PyObject_HEAD
+    PyObject* file;
+    PyObject* uart;
+    ubx_upload_t upload;
+    size_t frame_sent;      // байт текущего кадра, уже принятых uart.write()
+} AssistUploaderObject;
+
+static void assist_uploader_dealloc(AssistUploaderObject* self) {
+    Py_XDECREF(self->file);
+    Py_XDECREF(self->uart);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// Монотонные миллисекунды для таймаутов ACK
+static uint32_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000);
+}
+
+// AssistUploader(file, uart, date=None, timeout_ms=1000) - date (год, месяц, день) для отбора MGA-ANO
+static int assist_uploader_init(AssistUploaderObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "file", "uart", "date", "timeout_ms", NULL };
+    PyObject* file;
+    PyObject* uart;
+    PyObject* date = Py_None;
+    int timeout_ms = 1000;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|Oi", keywords, &file, &uart, &date, &timeout_ms)) return -1;
+
+    int year = 0, month = 0, day = 0;
+    if (date != Py_None && !PyArg_ParseTuple(date, "iii", &year, &month, &day)) return -1;
+    if (date != Py_None && (year < 2000 || year > 2255 || month < 1 || month > 12 || day < 1 || day > 31)) {
+        PyErr_SetString(PyExc_ValueError, "date out of range");
+        return -1;
+    }
+    if (timeout_ms < 0) {
+        PyErr_SetString(PyExc_ValueError, "timeout_ms must be >= 0");
+        return -1;
+    }
+
+    Py_INCREF(file);
+    Py_INCREF(uart);
+    Py_XSETREF(self->file, file);
+    Py_XSETREF(self->uart, uart);
+    ubx_upload_init(&self->upload, year, month, day, (uint32_t)timeout_ms);
+    self->frame_sent = 0;
+    return 0;
+}
+
+// Вызов obj.read(n); длина прочитанного или -1 при ошибке (None - нет данных)
+static Py_ssize_t call_read(PyObject* obj, uint8_t* out, size_t capacity) {
+    PyObject* data = PyObject_CallMethod(obj, "read", "n", (Py_ssize_t)capacity);
+    if (!data) return -1;
+    if (data == Py_None) {
+        Py_DECREF(data);
+        return 0;
+    }
+    Py_buffer buf;
+    if (PyObject_GetBuffer(data, &buf, PyBUF_SIMPLE) < 0) {
+        Py_DECREF(data);
+        return -1;
+    }
+    Py_ssize_t len = buf.len < (Py_ssize_t)capacity ? buf.len : (Py_ssize_t)capacity;
+    memcpy(out, buf.buf, (size_t)len);
+    PyBuffer_Release(&buf);
+    Py_DECREF(data);
+    return len;
+}
+
+// Шаг без блокировки, как в модуле MicroPython: 1 - продолжается, 0 - закончена, -1 - ошибка
+static int assist_uploader_poll_once(AssistUploaderObject* self) {
+    ubx_upload_t* upload = &self->upload;
+    for (;;) {
+        switch (ubx_upload_step(upload, monotonic_ms())) {
+            case UBX_UPLOAD_READ: {
+                Py_ssize_t len = call_read(self->file, upload->input, UBX_UPLOAD_CHUNK);
+                if (len < 0) return -1;
+                ubx_upload_input(upload, (size_t)len);
+                break;
+            }
+            case UBX_UPLOAD_WRITE: {
+                // Кадр уходит целиком до отметки об отправке; write() может принять часть (None - ничего)
+                PyObject* result = PyObject_CallMethod(self->uart, "write", "y#",
+                                                       (const char*)upload->frame + self->frame_sent,
+                                                       (Py_ssize_t)(upload->frame_len - self->frame_sent));
+                if (!result) return -1;
+                Py_ssize_t count = (result == Py_None) ? 0 : PyLong_AsSsize_t(result);
+                Py_DECREF(result);
+                if (count < 0) {
+                    if (!PyErr_Occurred()) PyErr_SetString(PyExc_OSError, "uart.write() returned a negative count");
+                    return -1;
+                }
+                if ((size_t)count > upload->frame_len - self->frame_sent) count = upload->frame_len - self->frame_sent;
+                self->frame_sent += (size_t)count;
+                if (self->frame_sent < upload->frame_len) return 1;
+                self->frame_sent = 0;
+                ubx_upload_written(upload, monotonic_ms());
+                return 1;
+            }
+            case UBX_UPLOAD_WAIT: {
+                uint8_t buf[UBX_FRAME_OVERHEAD + UBX_MGA_ACK_SIZE];
+                Py_ssize_t len = call_read(self->uart, buf, sizeof(buf));
+                if (len < 0) return -1;
+                if (len == 0) return 1;
+                ubx_upload_receive(upload, buf, (size_t)len);
+                break;
+            }
+            default:
+                return 0;
+        }
+    }
+}
+
+// poll() - шаг загрузки; True, пока загрузка не закончена
+static PyObject* assist_uploader_poll(AssistUploaderObject* self, PyObject* unused) {
+    int result = assist_uploader_poll_once(self);
+    if (result < 0) return NULL;
+    return PyBool_FromLong(result);
+}
+
+// stats() - (отправлено, ACK, NAK, пропущено других дат, без ответа) кадров
+static PyObject* assist_uploader_stats(AssistUploaderObject* self, PyObject* unused) {
+    const ubx_upload_t* upload = &self->upload;
+    return Py_BuildValue("(IIIII)", upload->sent, upload->acked, upload->nacked, upload->skipped, upload->timeouts);
+}
+
+// upload() - загрузка до конца файла; возвращает stats()
+static PyObject* assist_uploader_upload(AssistUploaderObject* self, PyObject* unused) {
+    int result;
+    while ((result = assist_uploader_poll_once(self)) > 0) {
+        if (self->upload.written) {
+            Py_BEGIN_ALLOW_THREADS
+            usleep(1000);
+            Py_END_ALLOW_THREADS
+        }
+    }
+    if (result < 0) return NULL;
+    return assist_uploader_stats(self, NULL);
+}
+
+static PyMethodDef assist_uploader_methods[] = {
+    { "poll", (PyCFunction)assist_uploader_poll, METH_NOARGS, "Advance the upload without blocking; False when done" },
+    { "upload", (PyCFunction)assist_uploader_upload, METH_NOARGS, "Upload the whole file and return stats()" },
+    { "stats", (PyCFunction)assist_uploader_stats, METH_NOARGS,
+      "(sent, acked, nacked, skipped, timeouts) frame counters" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject AssistUploaderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.AssistUploader",
+    .tp_doc = "Streaming AssistNow upload with UBX-MGA-ACK flow control",
+    .tp_basicsize = sizeof(AssistUploaderObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)assist_uploader_init,
+    .tp_dealloc = (destructor)assist_uploader_dealloc,
+    .tp_methods = assist_uploader_methods,
+};
+
+// Запись сырых кадров UBX в файл: file.write() получает memoryview буфера без копии
+typedef struct {
+    PyObject_HEAD
+    PyObject* file;
+    ubx_capture_t capture;
+} UbxCaptureObject;
+
+static void ubx_capture_dealloc(UbxCaptureObject* self) {
+    Py_XDECREF(self->file);
+    PyMem_Free(self->capture.buf);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// UbxCapture(file, classes=(0x02,), buffer_size=16384)
+static int ubx_capture_init_object(UbxCaptureObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = { "file", "classes", "buffer_size", NULL };
+    PyObject* file;
+    PyObject* classes = Py_None;
+    Py_ssize_t buffer_size = 16384;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|On", keywords, &file, &classes, &buffer_size)) return -1;
+    if (buffer_size < UBX_CAPTURE_MAX_FRAME + UBX_CAPTURE_BLOCK) {
+        PyErr_SetString(PyExc_ValueError, "buffer_size too small");
+        return -1;
+    }
+
+    uint8_t* buf = PyMem_Malloc((size_t)buffer_size);
+    if (!buf) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    PyMem_Free(self->capture.buf);
+    ubx_capture_init(&self->capture, buf, (size_t)buffer_size);
+    if (classes == Py_None) {
+        ubx_capture_select(&self->capture, UBX_CLASS_RXM);
+    } else {
+        PyObject* seq = PySequence_Fast(classes, "classes must be a sequence of UBX class numbers");
+        if (!seq) return -1;
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+            long msg_class = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+            if (msg_class < 0 || msg_class > 255) {
+                Py_DECREF(seq);
+                if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "UBX class must be 0..255");
+                return -1;
+            }
+            ubx_capture_select(&self->capture, (uint8_t)msg_class);
+        }
+        Py_DECREF(seq);
+    }
+
+    Py_INCREF(file);
+    Py_XSETREF(self->file, file);
+    return 0;
+}
+
+// Запись n байт с начала буфера; 0 при ошибке
+static int ubx_capture_write(UbxCaptureObject* self, size_t n) {
+    // Небуферизованный файл пишет не все сразу: повтор с остатка, пока write() продвигается
+    size_t done = 0;
+    while (done < n) {
+        PyObject* view = PyMemoryView_FromMemory((char*)self->capture.buf + done, (Py_ssize_t)(n - done), PyBUF_READ);
+        if (!view) break;
+        PyObject* result = PyObject_CallMethod(self->file, "write", "O", view);
+        Py_DECREF(view);
+        if (!result) break;
+        Py_ssize_t count = (result == Py_None) ? 0 : PyLong_AsSsize_t(result);
+        Py_DECREF(result);
+        if (count < 0 && PyErr_Occurred()) break;
+        if (count <= 0 || (size_t)count > n - done) {
+            PyErr_SetString(PyExc_OSError, "file.write() made no progress");
+            break;
+        }
+        done += (size_t)count;
+    }
+    // Записанное не повторяется, остальное остается в буфере до следующей записи
+    if (done) ubx_capture_written(&self->capture, done);
+    return done == n;
+}
+
+// Подача байт с записью полных блоков; 0 при ошибке записи
+static int ubx_capture_feed_all(UbxCaptureObject* self, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t used = ubx_capture_feed(&self->capture, data, len);
+        data += used;
+        len -= used;
+        size_t pending = ubx_capture_pending(&self->capture);
+        if (pending && !ubx_capture_write(self, pending)) return 0;
+    }
+    return 1;
+}
+
+// feed(data) - байты потока приемника
+static PyObject* ubx_capture_feed_data(UbxCaptureObject* self, PyObject* args) {
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "y*", &data)) return NULL;
+    int ok = ubx_capture_feed_all(self, data.buf, (size_t)data.len);
+    PyBuffer_Release(&data);
+    if (!ok) return NULL;
+    Py_RETURN_NONE;
+}
+
+// pump(uart, max_bytes=4096) - чтение uart.read(n), пока есть данные; число прочитанных байт
+static PyObject* ubx_capture_pump(UbxCaptureObject* self, PyObject* args) {
+    PyObject* uart;
+    Py_ssize_t max_bytes = 4096;
+    if (!PyArg_ParseTuple(args, "O|n", &uart, &max_bytes)) return NULL;
+    uint8_t chunk[256];
+    Py_ssize_t total = 0;
+    while (total < max_bytes) {
+        size_t want = (max_bytes - total < (Py_ssize_t)sizeof(chunk)) ? (size_t)(max_bytes - total) : sizeof(chunk);
+        Py_ssize_t got = call_read(uart, chunk, want);
+        if (got < 0) return NULL;
+        if (got == 0) break;
+        if (!ubx_capture_feed_all(self, chunk, (size_t)got)) return NULL;
+        total += got;
+        if ((size_t)got < want) break;
+    }
+    return PyLong_FromSsize_t(total);
+}
+
+// flush() - запись всех принятых кадров; число записанных байт
+static PyObject* ubx_capture_flush(UbxCaptureObject* self, PyObject* unused) {
+    size_t len = self->capture.len;
+    if (len && !ubx_capture_write(self, len)) return NULL;
+    return PyLong_FromSize_t(len);
+}
+
+// stats() - (принято байт, записано байт, кадров, пропущено других классов, отброшено, записей)
+static PyObject* ubx_capture_stats(UbxCaptureObject* self, PyObject* unused) {
+    const ubx_capture_t* capture = &self->capture;
+    return Py_BuildValue("(KKIIII)", (unsigned long long)capture->bytes_in,
+                         (unsigned long long)capture->bytes_written, capture->messages, capture->skipped,
+                         ubx_capture_dropped(capture), capture->writes);
+}
+
+static PyMethodDef ubx_capture_methods[] = {
+    { "feed", (PyCFunction)ubx_capture_feed_data, METH_VARARGS, "Frame receiver bytes and buffer selected UBX frames" },
+    { "pump", (PyCFunction)ubx_capture_pump, METH_VARARGS, "Read from a stream while data is available" },
+    { "flush", (PyCFunction)ubx_capture_flush, METH_NOARGS, "Write all buffered frames to the file" },
+    { "stats", (PyCFunction)ubx_capture_stats, METH_NOARGS,
+      "(bytes_in, bytes_written, messages, skipped, dropped, writes) counters" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject UbxCaptureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ublox_nmea.UbxCapture",
+    .tp_doc = "Verbatim capture of selected UBX classes into block-aligned file writes",
+    .tp_basicsize = sizeof(UbxCaptureObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)ubx_capture_init_object,
+    .tp_dealloc = (destructor)ubx_capture_dealloc,
+    .tp_methods = ubx_capture_methods,
+};
+
+// Определение функций для модуля
+static PyMethodDef ublox_nmea_methods[] = {
+    { "parse", py_parse, METH_O, "Parse one NMEA sentence and return the current fix as dict" },
+    { "current", py_current, METH_NOARGS, "Return the current fix as dict" },
+    { "reset", py_reset, METH_NOARGS, "Reset parser state" },
+    { "save_state", py_save_state, METH_NOARGS, "Serialise the current fix into a versioned blob" },
+    { "load_state", py_load_state, METH_VARARGS, "Restore the current fix from a save_state() blob" },
+    { "calculate_distance", py_calculate_distance, METH_VARARGS, "Haversine distance in metres" },
+    { "parse_file", (PyCFunction)(void (*)(void))py_parse_file, METH_VARARGS | METH_KEYWORDS,
+      "Parse a whole NMEA log (path or buffer) into per-epoch columns on worker threads" },
+    { "build_index", (PyCFunction)(void (*)(void))py_build_index, METH_VARARGS | METH_KEYWORDS,
+      "Write a sidecar index with the offset and UTC time of every Nth epoch" },
+    { "read_range", (PyCFunction)(void (*)(void))py_read_range, METH_VARARGS | METH_KEYWORDS,
+      "Parse only the epochs between from_ms and to_ms using the sidecar index" },
+    { "encode", (PyCFunction)(void (*)(void))py_encode, METH_VARARGS | METH_KEYWORDS,
+      "Encode the current fix (or a fix dict) as checksummed NMEA sentences" },
+    { "encode_into", (PyCFunction)(void (*)(void))py_encode_into, METH_VARARGS | METH_KEYWORDS,
+      "Encode NMEA sentences into a writable buffer and return their length" },
+    { "mga_ini", (PyCFunction)(void (*)(void))py_mga_ini, METH_VARARGS | METH_KEYWORDS,
+      "UBX-MGA-INI position and time messages for a hot start from the last fix" },
+    { "nav_sat", py_nav_sat, METH_VARARGS, "Decode a UBX-NAV-SAT frame into the satellite table" },
+    { "satellites", py_satellites, METH_NOARGS, "Satellite table columns as zero-copy memoryviews" },
+    { "tim_tp", py_tim_tp, METH_VARARGS, "Label the next PPS edge from a UBX-TIM-TP frame" },
+    { "nav_timeutc", py_nav_timeutc, METH_VARARGS, "Leap seconds and accuracy from a UBX-NAV-TIMEUTC frame" },
+    { "pps", py_pps, METH_VARARGS, "Record a PPS edge captured at ticks_us" },
+    { "pps_utc", py_pps_utc, METH_VARARGS, "UTC nanoseconds of a local ticks_us value" },
+    { "pps_status", py_pps_status, METH_NOARGS,
+      "(pulses, rejected, drift_ppm, qerr_ps, t_acc_ns, leap_seconds) of the PPS time transfer" },
+    { "clock_sample", py_clock_sample, METH_VARARGS, "Add a (ticks_ms, utc_ms) pair to the clock model" },
+    { "utc_from_ticks", py_utc_from_ticks, METH_VARARGS, "UTC milliseconds of a local ticks_ms value" },
+    { "utc_from_ticks_batch", py_utc_from_ticks_batch, METH_VARARGS,
+      "Convert an array of ticks_ms into UTC milliseconds in place of out" },
+    { "clock_status", py_clock_status, METH_NOARGS,
+      "(samples, rejected, drift_ppm, rms_ms, window) of the clock model" },
+    { "mon_rf", py_mon_rf, METH_VARARGS, "Jamming, AGC, noise and antenna state from a UBX-MON-RF frame" },
+    { "mon_hw", py_mon_hw, METH_VARARGS, "Jamming, AGC, noise and antenna state from a UBX-MON-HW frame" },
+    { "rf_status", py_rf_status, METH_NOARGS,
+      "(alerts, jamming_state, jam_ind, antenna_status, antenna_power, noise_per_ms, agc_cnt, messages, epochs)" },
+    { "cno_stats", py_cno_stats, METH_VARARGS, "Per-constellation C/N0 statistics of the last GSV epoch" },
+    { "rf_alerts", (PyCFunction)(void (*)(void))py_rf_alerts, METH_VARARGS | METH_KEYWORDS,
+      "Call callback(alerts, changed) when the set of RF alerts changes" },
+    { NULL, NULL, 0, NULL },
+};
+
+// Определение модуля
+static struct PyModuleDef ublox_nmea_module = {
+    PyModuleDef_HEAD_INIT,
+    "ublox_nmea",
+    "NMEA parser sharing its core with the MicroPython module",
+    -1,
+    ublox_nmea_methods,
+};
+
+PyMODINIT_FUNC PyInit_ublox_nmea(void) {
+    if (PyType_Ready(&MultiplexerType) < 0) return NULL;
+    if (PyType_Ready(&GeneratorType) < 0) return NULL;
+    if (PyType_Ready(&RouterType) < 0) return NULL;
+    if (PyType_Ready(&PackerType) < 0) return NULL;
+    if (PyType_Ready(&AssistUploaderType) < 0) return NULL;
+    if (PyType_Ready(&UbxCaptureType) < 0) return NULL;
+
+    PyObject* module = PyModule_Create(&ublox_nmea_module);
+    if (!module) return NULL;
+
+    Py_INCREF(&MultiplexerType);
+    if (PyModule_AddObject(module, "Multiplexer", (PyObject*)&MultiplexerType) < 0) {
+        Py_DECREF(&MultiplexerType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&GeneratorType);
+    if (PyModule_AddObject(module, "Generator", (PyObject*)&GeneratorType) < 0) {
+        Py_DECREF(&GeneratorType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&RouterType);
+    if (PyModule_AddObject(module, "Router", (PyObject*)&RouterType) < 0) {
+        Py_DECREF(&RouterType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&PackerType);
+    if (PyModule_AddObject(module, "Packer", (PyObject*)&PackerType) < 0) {
+        Py_DECREF(&PackerType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&AssistUploaderType);
+    if (PyModule_AddObject(module, "AssistUploader", (PyObject*)&AssistUploaderType) < 0) {
+        Py_DECREF(&AssistUploaderType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&UbxCaptureType);
+    if (PyModule_AddObject(module, "UbxCapture", (PyObject*)&UbxCaptureType) < 0) {
+        Py_DECREF(&UbxCaptureType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    if (PyModule_AddIntConstant(module, "RF_JAMMING", NMEA_RF_ALERT_JAMMING) < 0 ||
+        PyModule_AddIntConstant(module, "RF_ANTENNA", NMEA_RF_ALERT_ANTENNA) < 0 ||
+        PyModule_AddIntConstant(module, "RF_CNO_LOW", NMEA_RF_ALERT_CNO_LOW) < 0 ||
+        PyModule_AddIntConstant(module, "RF_CNO_DROP", NMEA_RF_ALERT_CNO_DROP) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
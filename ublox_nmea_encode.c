@@ -0,0 +1,297 @@
+#include "ublox_nmea_encode.h"
+#include "ublox_nmea_writer.h"
+#include <string.h>
+
+// Узлы -> м/с, как в разборе RMC
+#define KNOTS_TO_MPS 0.514444
+
+// Имя из трех букв как целое (для сравнения типов без strncmp)
+static uint32_t type_code(const char* name) {
+    return ((uint32_t)(uint8_t)name[0] << 16) | ((uint32_t)(uint8_t)name[1] << 8) | (uint8_t)name[2];
+}
+
+// Разбор списка "AAA,BBB" в коды типов; возвращает число кодов или -1
+static int parse_type_list(const char* list, uint32_t* codes, int max_codes) {
+    int count = 0;
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len != 3 || count >= max_codes) return -1;
+        char name[3];
+        for (int i = 0; i < 3; i++) {
+            char c = p[i];
+            name[i] = (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+        }
+        codes[count++] = type_code(name);
+        p += len;
+        if (*p == ',') p++;
+    }
+    return count;
+}
+
+int nmea_encode_parse_sentences(const char* list) {
+    static const struct { const char* name; int bit; } known[] = {
+        { "RMC", NMEA_ENCODE_RMC }, { "GGA", NMEA_ENCODE_GGA },
+        { "GSA", NMEA_ENCODE_GSA }, { "VTG", NMEA_ENCODE_VTG },
+    };
+    uint32_t codes[8];
+    int count = parse_type_list(list, codes, 8);
+    if (count < 0) return -1;
+
+    int mask = 0;
+    for (int i = 0; i < count; i++) {
+        int found = 0;
+        for (size_t k = 0; k < sizeof(known) / sizeof(known[0]); k++) {
+            if (codes[i] == type_code(known[k].name)) {
+                mask |= known[k].bit;
+                found = 1;
+            }
+        }
+        if (!found) return -1;
+    }
+    return mask;
+}
+
+// Копия предложения из черновика, если помещается
+static size_t sentence_copy(const char* draft, size_t len, char* out, size_t capacity) {
+    if (len > capacity) return 0;
+    memcpy(out, draft, len);
+    return len;
+}
+
+// Время hhmmss.ss (пустое поле, если не было ни даты, ни времени)
+static void put_time(nmea_writer_t* w, const gps_data_t* gps_data) {
+    if (gps_data->year == 0 && gps_data->hour == 0 && gps_data->minute == 0 && gps_data->second == 0 &&
+        gps_data->millisecond == 0) {
+        return;
+    }
+    int64_t tod = ((int64_t)gps_data->hour * 3600 + gps_data->minute * 60 + gps_data->second) * 1000 +
+                  gps_data->millisecond;
+    nmea_put_time_of_day(w, tod);
+}
+
+// Широта и долгота (четыре поля)
+static void put_position(nmea_writer_t* w, const gps_data_t* gps_data) {
+    // Широта без долготы (или наоборот) не выводится: позиция либо целиком, либо пустая
+    if (nmea_coordinate_valid(gps_data->latitude, 2) && nmea_coordinate_valid(gps_data->longitude, 3)) {
+        nmea_put_coordinate(w, gps_data->latitude, 2, 'N', 'S');
+        nmea_put_char(w, ',');
+        nmea_put_coordinate(w, gps_data->longitude, 3, 'E', 'W');
+    } else {
+        nmea_put_str(w, ",,,");
+    }
+}
+
+// Индикатор режима NMEA 2.3: A - автономный, D - дифференциальный, N - нет данных
+static char mode_indicator(const gps_data_t* gps_data) {
+    if (!gps_data->valid) return 'N';
+    return (gps_data->fix_type == 2) ? 'D' : 'A';
+}
+
+size_t nmea_encode_rmc(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity) {
+    char draft[NMEA_ENCODE_MAX_SENTENCE];
+    nmea_writer_t w;
+    nmea_sentence_begin(&w, draft, talker, "RMC,");
+    put_time(&w, gps_data);
+    nmea_put_char(&w, ',');
+    nmea_put_char(&w, gps_data->valid ? 'A' : 'V');
+    nmea_put_char(&w, ',');
+    put_position(&w, gps_data);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->speed / KNOTS_TO_MPS, 3);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->course, 2);
+    nmea_put_char(&w, ',');
+    if (gps_data->year > 0 && gps_data->month > 0 && gps_data->day > 0) {
+        nmea_put_uint(&w, gps_data->day, 2);
+        nmea_put_uint(&w, gps_data->month, 2);
+        nmea_put_uint(&w, gps_data->year % 100, 2);
+    }
+    nmea_put_str(&w, ",,,");
+    nmea_put_char(&w, mode_indicator(gps_data));
+    return sentence_copy(draft, nmea_sentence_finish(&w), out, capacity);
+}
+
+size_t nmea_encode_gga(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity) {
+    char draft[NMEA_ENCODE_MAX_SENTENCE];
+    nmea_writer_t w;
+    nmea_sentence_begin(&w, draft, talker, "GGA,");
+    put_time(&w, gps_data);
+    nmea_put_char(&w, ',');
+    put_position(&w, gps_data);
+    nmea_put_char(&w, ',');
+    nmea_put_uint(&w, gps_data->fix_type, 1);
+    nmea_put_char(&w, ',');
+    if (gps_data->has_satellites_used) nmea_put_uint(&w, gps_data->satellites_used, 2);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->hdop, 2);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->altitude, 1);
+    nmea_put_str(&w, ",M,");
+    nmea_put_fixed(&w, gps_data->geoid_separation, 1);
+    nmea_put_str(&w, ",M,,");
+    return sentence_copy(draft, nmea_sentence_finish(&w), out, capacity);
+}
+
+size_t nmea_encode_gsa(const gps_data_t* gps_data, const char* talker, const uint16_t* prns, size_t prn_count,
+                       char* out, size_t capacity) {
+    char draft[NMEA_ENCODE_MAX_SENTENCE];
+    nmea_writer_t w;
+    nmea_sentence_begin(&w, draft, talker, "GSA,A,");
+
+    // Режим: 1 - нет фикса, 2 - 2D (без высоты), 3 - 3D
+    char mode = '1';
+    if (gps_data->valid || gps_data->fix_type > 0) {
+        mode = isfinite(gps_data->altitude) ? '3' : '2';
+    }
+    nmea_put_char(&w, mode);
+
+    for (size_t i = 0; i < 12; i++) {
+        nmea_put_char(&w, ',');
+        // Номер спутника NMEA - до 3 цифр; больше - пустое поле (иначе предложение не влезет в черновик)
+        if (prns && i < prn_count && prns[i] <= 999) nmea_put_uint(&w, prns[i], 2);
+    }
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->pdop, 2);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->hdop, 2);
+    nmea_put_char(&w, ',');
+    nmea_put_fixed(&w, gps_data->vdop, 2);
+    return sentence_copy(draft, nmea_sentence_finish(&w), out, capacity);
+}
+
+size_t nmea_encode_vtg(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity) {
+    char draft[NMEA_ENCODE_MAX_SENTENCE];
+    nmea_writer_t w;
+    nmea_sentence_begin(&w, draft, talker, "VTG,");
+    nmea_put_fixed(&w, gps_data->course, 2);
+    nmea_put_str(&w, ",T,,M,");
+    nmea_put_fixed(&w, gps_data->speed / KNOTS_TO_MPS, 3);
+    nmea_put_str(&w, ",N,");
+    nmea_put_fixed(&w, gps_data->speed * 3.6, 3);
+    nmea_put_str(&w, ",K,");
+    nmea_put_char(&w, mode_indicator(gps_data));
+    return sentence_copy(draft, nmea_sentence_finish(&w), out, capacity);
+}
+
+size_t nmea_encode_epoch(const gps_data_t* gps_data, int sentences, const char* talker, char* out, size_t capacity) {
+    size_t len = 0;
+    size_t n;
+    if (sentences & NMEA_ENCODE_RMC) {
+        if (!(n = nmea_encode_rmc(gps_data, talker, out + len, capacity - len))) return 0;
+        len += n;
+    }
+    if (sentences & NMEA_ENCODE_GGA) {
+        if (!(n = nmea_encode_gga(gps_data, talker, out + len, capacity - len))) return 0;
+        len += n;
+    }
+    if (sentences & NMEA_ENCODE_GSA) {
+        if (!(n = nmea_encode_gsa(gps_data, talker, NULL, 0, out + len, capacity - len))) return 0;
+        len += n;
+    }
+    if (sentences & NMEA_ENCODE_VTG) {
+        if (!(n = nmea_encode_vtg(gps_data, talker, out + len, capacity - len))) return 0;
+        len += n;
+    }
+    return len;
+}
+
+int nmea_router_init(nmea_router_t* router, const char* types, int validate) {
+    memset(router, 0, sizeof(*router));
+    router->validate = validate ? 1 : 0;
+    if (types && *types) {
+        int count = parse_type_list(types, router->types, NMEA_ROUTER_MAX_TYPES);
+        if (count < 0) return 0;
+        router->type_count = (uint8_t)count;
+    }
+    return 1;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Контрольная сумма строки [line, end) без терминатора
+static int line_checksum_valid(const char* line, const char* end) {
+    uint8_t checksum = 0;
+    const char* p = line + 1;
+    while (p < end && *p != '*') checksum ^= (uint8_t)*p++;
+    if (end - p < 3) return 0;
+    int high = hex_value(p[1]);
+    int low = hex_value(p[2]);
+    return high >= 0 && low >= 0 && checksum == (uint8_t)(high << 4 | low);
+}
+
+// Решение по полной строке [line, line + len), len включает '\n'
+static int router_accepts(const nmea_router_t* router, const char* line, size_t len) {
+    if (len < 7 || line[0] != '$') return 0;
+    if (router->type_count) {
+        uint32_t code = type_code(line + 3);
+        int found = 0;
+        for (int i = 0; i < router->type_count; i++) {
+            if (router->types[i] == code) {
+                found = 1;
+                break;
+            }
+        }
+        if (!found) return 0;
+    }
+    if (router->validate) {
+        const char* end = line + len - 1;
+        if (end > line && end[-1] == '\r') end--;
+        return line_checksum_valid(line, end);
+    }
+    return 1;
+}
+
+// Полная строка: копия в выход или отбрасывание
+static size_t router_line(nmea_router_t* router, const char* line, size_t len, char* out) {
+    if (router_accepts(router, line, len)) {
+        memcpy(out, line, len);
+        router->passed++;
+        return len;
+    }
+    router->dropped++;
+    return 0;
+}
+
+size_t nmea_router_feed(nmea_router_t* router, const char* data, size_t len, char* out) {
+    size_t out_len = 0;
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end) {
+        const char* nl = memchr(p, '\n', (size_t)(end - p));
+        size_t piece = nl ? (size_t)(nl - p + 1) : (size_t)(end - p);
+
+        // Продолжение строки из прошлого вызова или слишком длинная строка - через буфер
+        if (router->line_len > 0 || router->overflow || !nl) {
+            if (!router->overflow && router->line_len + piece <= NMEA_ROUTER_MAX_LINE) {
+                memcpy(router->line + router->line_len, p, piece);
+                router->line_len += piece;
+            } else {
+                router->overflow = 1;
+            }
+            if (nl) {
+                if (router->overflow) {
+                    router->dropped++;
+                } else {
+                    out_len += router_line(router, router->line, router->line_len, out + out_len);
+                }
+                router->line_len = 0;
+                router->overflow = 0;
+            }
+        } else if (piece > NMEA_ROUTER_MAX_LINE) {
+            router->dropped++;
+        } else {
+            // Полная строка внутри фрагмента - копия прямо из входа
+            out_len += router_line(router, p, piece, out + out_len);
+        }
+        p += piece;
+    }
+    return out_len;
+}
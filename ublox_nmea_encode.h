@@ -0,0 +1,62 @@
+#ifndef UBLOX_NMEA_ENCODE_H
+#define UBLOX_NMEA_ENCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_core.h"
+
+// Кодирование gps_data_t обратно в предложения NMEA и пересылка входящих предложений как есть
+// (очищенный поток для картплоттера без форматирования строк в Python)
+
+// Верхняя граница длины одного закодированного предложения вместе с "\r\n": худший случай -
+// GSA с 12 трехзначными номерами и тремя DOP по 13 знаков (NMEA_FIXED_MAX), около 105 байт
+#define NMEA_ENCODE_MAX_SENTENCE 128
+
+// Предложения (маска) - биты по nmea_sentence_t; порядок вывода RMC, GGA, GSA, VTG
+#define NMEA_ENCODE_RMC (1 << NMEA_SENTENCE_RMC)
+#define NMEA_ENCODE_GGA (1 << NMEA_SENTENCE_GGA)
+#define NMEA_ENCODE_GSA (1 << NMEA_SENTENCE_GSA)
+#define NMEA_ENCODE_VTG (1 << NMEA_SENTENCE_VTG)
+
+// Маска из списка "RMC,GGA,GSA,VTG"; -1 при неизвестном имени
+int nmea_encode_parse_sentences(const char* list);
+
+// Отдельные предложения в out; возвращают длину или 0, если не помещается в capacity
+// Отсутствующие значения (NAN) выводятся пустыми полями; talker - две буквы ("GP", "GN")
+size_t nmea_encode_rmc(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity);
+size_t nmea_encode_gga(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity);
+size_t nmea_encode_vtg(const gps_data_t* gps_data, const char* talker, char* out, size_t capacity);
+
+// prns - номера спутников в решении (до 12, остальные отбрасываются; больше 999 - пустое поле),
+// может быть NULL
+size_t nmea_encode_gsa(const gps_data_t* gps_data, const char* talker, const uint16_t* prns, size_t prn_count,
+                       char* out, size_t capacity);
+
+// Предложения по маске подряд; 0, если не помещаются все (out тогда не определен)
+size_t nmea_encode_epoch(const gps_data_t* gps_data, int sentences, const char* talker, char* out, size_t capacity);
+
+// Пересылка: полные строки выбранных типов копируются в выход без изменений
+#define NMEA_ROUTER_MAX_LINE 128
+#define NMEA_ROUTER_MAX_TYPES 16
+
+// Выход nmea_router_feed не длиннее входа плюс хвост предыдущего вызова
+#define NMEA_ROUTER_MAX_OUTPUT(len) ((len) + NMEA_ROUTER_MAX_LINE)
+
+typedef struct {
+    uint32_t types[NMEA_ROUTER_MAX_TYPES];  // три буквы типа после talker; пусто - все
+    uint8_t type_count;
+    uint8_t validate;                       // отбрасывать строки с неверной контрольной суммой
+    uint8_t overflow;                       // текущая строка длиннее NMEA_ROUTER_MAX_LINE
+    size_t line_len;
+    char line[NMEA_ROUTER_MAX_LINE];        // неполная строка между вызовами
+    uint32_t passed;
+    uint32_t dropped;
+} nmea_router_t;
+
+// types - список "GGA,RMC,TXT" (пустая строка или NULL - все типы); 0 при ошибке в списке
+int nmea_router_init(nmea_router_t* router, const char* types, int validate);
+
+// Подача фрагмента; out не меньше NMEA_ROUTER_MAX_OUTPUT(len); возвращает длину выхода
+size_t nmea_router_feed(nmea_router_t* router, const char* data, size_t len, char* out);
+
+#endif
@@ -0,0 +1,455 @@
+#include "ublox_nmea_gen.h"
+#include "ublox_nmea_core.h"
+#include "ublox_nmea_writer.h"
+#include "ublox_nmea_ubx.h"
+#include <string.h>
+
+// Генерация без snprintf (ublox_nmea_writer.h) - иначе корпуса в гигабайты генерировались бы дольше разбора
+
+#define GPS_WEEK_MS (7LL * 86400000LL)
+
+// Talker и диапазон номеров спутников созвездий
+static const char constellation_talker[NMEA_GEN_MAX_CONSTELLATIONS][3] = { "GP", "GL", "GA", "GB" };
+static const uint16_t constellation_first_prn[NMEA_GEN_MAX_CONSTELLATIONS] = { 1, 65, 1, 1 };
+
+void nmea_gen_config_default(nmea_gen_config_t* config) {
+    config->trajectory = NMEA_GEN_STRAIGHT;
+    config->lat = 55.7558;
+    config->lon = 37.6173;
+    config->alt = 150.0;
+    config->speed_mps = 15.0;
+    config->heading_deg = 45.0;
+    config->radius_m = 200.0;
+    config->period_s = 30.0;
+    config->event_s = 10.0;
+    config->jump_m = 100.0;
+    config->start_ms = 1773705600000LL;   // 2026-03-17T00:00:00Z
+    config->rate_hz = 1;
+    config->constellations = 1;
+    config->satellites = 12;
+    config->sentences = NMEA_GEN_ALL_NMEA;
+    config->corrupt_ppm = 0;
+    config->seed = 1;
+}
+
+// Сравнение имени без учета регистра на длине len
+static int name_equal(const char* name, size_t len, const char* expected) {
+    if (strlen(expected) != len) return 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        char e = expected[i];
+        if (e >= 'a' && e <= 'z') e -= 'a' - 'A';
+        if (c != e) return 0;
+    }
+    return 1;
+}
+
+int nmea_gen_parse_sentences(const char* list) {
+    static const char* names[] = { "RMC", "GGA", "GSA", "GSV", "VTG", "PVT" };
+    int mask = 0;
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        int found = 0;
+        for (int i = 0; i < 6; i++) {
+            if (name_equal(p, len, names[i])) {
+                mask |= 1 << i;
+                found = 1;
+            }
+        }
+        if (!found && len > 0) return -1;
+        p += len;
+        if (*p == ',') p++;
+    }
+    return mask;
+}
+
+int nmea_gen_parse_trajectory(const char* name) {
+    static const char* names[] = { "straight", "circle", "stop_go", "tunnel", "jumps" };
+    for (int i = 0; i < 5; i++) {
+        if (name_equal(name, strlen(name), names[i])) return i;
+    }
+    return -1;
+}
+
+// xorshift32
+static uint32_t gen_random(nmea_gen_t* gen) {
+    uint32_t x = gen->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    gen->rng = x;
+    return x;
+}
+
+static uint32_t gen_random_below(nmea_gen_t* gen, uint32_t n) {
+    return (uint32_t)(((uint64_t)gen_random(gen) * n) >> 32);
+}
+
+int nmea_gen_init(nmea_gen_t* gen, const nmea_gen_config_t* config) {
+    if (config->rate_hz < 1 || config->rate_hz > 100) return 0;
+    if (config->constellations < 1 || config->constellations > NMEA_GEN_MAX_CONSTELLATIONS) return 0;
+    if (config->satellites > config->constellations * NMEA_GEN_MAX_SATS_PER_CONSTELLATION) return 0;
+    if (config->lat < -89.0 || config->lat > 89.0 || config->lon < -180.0 || config->lon > 180.0) return 0;
+    if (config->trajectory == NMEA_GEN_CIRCLE && config->radius_m <= 0.0) return 0;
+    if (config->start_ms < 0) return 0;
+
+    gen->config = *config;
+    gen->epoch = 0;
+    gen->time_ms = config->start_ms;
+    gen->lat = config->lat;
+    gen->lon = config->lon;
+    gen->heading_deg = config->heading_deg;
+    gen->speed_mps = config->speed_mps;
+    gen->fix = 1;
+    gen->out_lat = config->lat;
+    gen->out_lon = config->lon;
+    gen->rng = config->seed ? config->seed : 1;
+
+    // Спутники поровну между созвездиями
+    gen->sat_count = config->satellites;
+    for (int i = 0; i < gen->sat_count; i++) {
+        nmea_gen_sat_t* sat = &gen->sats[i];
+        sat->constellation = i % config->constellations;
+        sat->prn = constellation_first_prn[sat->constellation] + i / config->constellations;
+        sat->elevation = 5.0f + (float)gen_random_below(gen, 850) / 10.0f;
+        sat->azimuth = (float)gen_random_below(gen, 3600) / 10.0f;
+        sat->azimuth_rate = ((float)gen_random_below(gen, 200) - 100.0f) / 100000.0f / config->rate_hz;
+        sat->snr = 20 + gen_random_below(gen, 30);
+    }
+    return 1;
+}
+
+// Шаг траектории на одну эпоху
+static void gen_advance(nmea_gen_t* gen) {
+    const nmea_gen_config_t* config = &gen->config;
+    double dt = 1.0 / config->rate_hz;
+    double t = (double)gen->epoch * dt;
+
+    gen->speed_mps = config->speed_mps;
+    gen->fix = 1;
+    switch (config->trajectory) {
+        case NMEA_GEN_CIRCLE:
+            if (gen->epoch == 0) break;
+            gen->heading_deg += config->speed_mps * dt / config->radius_m / DEG_TO_RAD;
+            gen->heading_deg = fmod(gen->heading_deg, 360.0);
+            break;
+        case NMEA_GEN_STOP_GO:
+            if (config->period_s > 0.0 && fmod(t, 2.0 * config->period_s) >= config->period_s) {
+                gen->speed_mps = 0.0;
+            }
+            break;
+        case NMEA_GEN_TUNNEL:
+            if (config->period_s > 0.0 && fmod(t, config->period_s) >= config->period_s - config->event_s) {
+                gen->fix = 0;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Первая эпоха - стартовая точка
+    double heading = gen->heading_deg * DEG_TO_RAD;
+    double distance = (gen->epoch > 0) ? gen->speed_mps * dt : 0.0;
+    gen->lat += distance * cos(heading) / EARTH_RADIUS_M / DEG_TO_RAD;
+    gen->lon += distance * sin(heading) / (EARTH_RADIUS_M * cos(gen->lat * DEG_TO_RAD)) / DEG_TO_RAD;
+    if (gen->lon > 180.0) gen->lon -= 360.0;
+    if (gen->lon < -180.0) gen->lon += 360.0;
+
+    // Скачок - одна эпоха со смещенной позицией поперек курса
+    gen->out_lat = gen->lat;
+    gen->out_lon = gen->lon;
+    if (config->trajectory == NMEA_GEN_JUMPS && config->period_s > 0.0 &&
+        fmod(t, config->period_s) < dt * 0.5 && gen->epoch > 0) {
+        double across = heading + M_PI / 2.0;
+        gen->out_lat += config->jump_m * cos(across) / EARTH_RADIUS_M / DEG_TO_RAD;
+        gen->out_lon += config->jump_m * sin(across) / (EARTH_RADIUS_M * cos(gen->lat * DEG_TO_RAD)) / DEG_TO_RAD;
+    }
+
+    for (int i = 0; i < gen->sat_count; i++) {
+        nmea_gen_sat_t* sat = &gen->sats[i];
+        sat->azimuth += sat->azimuth_rate;
+        if (sat->azimuth >= 360.0f) sat->azimuth -= 360.0f;
+        if (sat->azimuth < 0.0f) sat->azimuth += 360.0f;
+        if ((gen->epoch & 15) == 0) {
+            int snr = sat->snr + (int)gen_random_below(gen, 5) - 2;
+            sat->snr = (snr < 15) ? 15 : (snr > 52) ? 52 : snr;
+        }
+    }
+}
+
+// Порча готового предложения: инверсия символа, обрыв строки или мусор перед '$'
+static size_t corrupt_sentence(nmea_gen_t* gen, char* start, size_t len) {
+    switch (gen_random_below(gen, 3)) {
+        case 0: {
+            size_t i = 1 + gen_random_below(gen, (uint32_t)(len - 6));
+            start[i] ^= 0x01 << gen_random_below(gen, 5);
+            if (start[i] == '\n' || start[i] == '$' || start[i] == '*') start[i] = '#';
+            return len;
+        }
+        case 1: {
+            size_t keep = 1 + gen_random_below(gen, (uint32_t)(len - 3));
+            start[keep] = '\r';
+            start[keep + 1] = '\n';
+            return keep + 2;
+        }
+        default: {
+            size_t garbage = 1 + gen_random_below(gen, 12);
+            memmove(start + garbage, start, len);
+            for (size_t i = 0; i < garbage; i++) {
+                char c = (char)gen_random_below(gen, 256);
+                start[i] = (c == '\n' || c == '$') ? '?' : c;
+            }
+            return len + garbage;
+        }
+    }
+}
+
+// Контрольная сумма, перевод строки и возможная порча; возвращает длину
+static size_t sentence_end(nmea_gen_t* gen, nmea_writer_t* s) {
+    size_t len = nmea_sentence_finish(s);
+    if (gen->config.corrupt_ppm && gen_random_below(gen, 1000000) < gen->config.corrupt_ppm) {
+        len = corrupt_sentence(gen, s->start, len);
+    }
+    return len;
+}
+
+// Поле времени hhmmss.ss
+static void put_time(nmea_writer_t* s, int64_t time_ms) {
+    nmea_put_time_of_day(s, time_ms % 86400000);
+}
+
+// Спутники в решении: не ниже 10 градусов
+static int sat_used(const nmea_gen_sat_t* sat) {
+    return sat->elevation >= 10.0f;
+}
+
+static int used_count(const nmea_gen_t* gen) {
+    if (!gen->fix) return 0;
+    int used = 0;
+    for (int i = 0; i < gen->sat_count; i++) {
+        used += sat_used(&gen->sats[i]);
+    }
+    return used;
+}
+
+// DOP из числа спутников в решении
+static double gen_hdop(int used) {
+    return (used >= 4) ? 0.5 + 6.0 / used : 99.9;
+}
+
+static size_t put_rmc(nmea_gen_t* gen, char* out, const char* talker) {
+    nmea_writer_t s;
+    nmea_sentence_begin(&s, out, talker, "RMC,");
+    put_time(&s, gen->time_ms);
+    nmea_put_char(&s, ',');
+    if (gen->fix) {
+        nmea_put_str(&s, "A,");
+        nmea_put_coordinate(&s, gen->out_lat, 2, 'N', 'S');
+        nmea_put_char(&s, ',');
+        nmea_put_coordinate(&s, gen->out_lon, 3, 'E', 'W');
+        nmea_put_char(&s, ',');
+        nmea_put_fixed(&s, gen->speed_mps / 0.514444, 3);
+        nmea_put_char(&s, ',');
+        nmea_put_fixed(&s, gen->heading_deg, 2);
+    } else {
+        nmea_put_str(&s, "V,,,,,,");
+    }
+    nmea_put_char(&s, ',');
+
+    int year, month, day;
+    nmea_civil_from_days(gen->time_ms / 86400000, &year, &month, &day);
+    nmea_put_uint(&s, day, 2);
+    nmea_put_uint(&s, month, 2);
+    nmea_put_uint(&s, year % 100, 2);
+    nmea_put_str(&s, ",,,");
+    nmea_put_char(&s, gen->fix ? 'A' : 'N');
+    return sentence_end(gen, &s);
+}
+
+static size_t put_gga(nmea_gen_t* gen, char* out, const char* talker) {
+    int used = used_count(gen);
+    nmea_writer_t s;
+    nmea_sentence_begin(&s, out, talker, "GGA,");
+    put_time(&s, gen->time_ms);
+    nmea_put_char(&s, ',');
+    if (gen->fix) {
+        nmea_put_coordinate(&s, gen->out_lat, 2, 'N', 'S');
+        nmea_put_char(&s, ',');
+        nmea_put_coordinate(&s, gen->out_lon, 3, 'E', 'W');
+        nmea_put_str(&s, ",1,");
+        nmea_put_uint(&s, used > 99 ? 99 : used, 2);
+        nmea_put_char(&s, ',');
+        nmea_put_fixed(&s, gen_hdop(used), 1);
+        nmea_put_char(&s, ',');
+        nmea_put_fixed(&s, gen->config.alt, 1);
+        nmea_put_str(&s, ",M,14.0,M,,");
+    } else {
+        nmea_put_str(&s, ",,,,0,00,99.9,,M,,M,,");
+    }
+    return sentence_end(gen, &s);
+}
+
+// GSA по созвездию: до 12 спутников в решении
+static size_t put_gsa(nmea_gen_t* gen, char* out, const char* talker, int constellation) {
+    int used = used_count(gen);
+    nmea_writer_t s;
+    nmea_sentence_begin(&s, out, talker, "GSA,A,");
+    nmea_put_char(&s, gen->fix ? '3' : '1');
+
+    int listed = 0;
+    for (int i = 0; i < gen->sat_count && listed < 12; i++) {
+        const nmea_gen_sat_t* sat = &gen->sats[i];
+        if (sat->constellation != constellation || !gen->fix || !sat_used(sat)) continue;
+        nmea_put_char(&s, ',');
+        nmea_put_uint(&s, sat->prn, 2);
+        listed++;
+    }
+    for (; listed < 12; listed++) {
+        nmea_put_char(&s, ',');
+    }
+
+    double hdop = gen_hdop(used);
+    nmea_put_char(&s, ',');
+    nmea_put_fixed(&s, gen->fix ? hdop * 1.6 : 99.9, 1);
+    nmea_put_char(&s, ',');
+    nmea_put_fixed(&s, hdop, 1);
+    nmea_put_char(&s, ',');
+    nmea_put_fixed(&s, gen->fix ? hdop * 1.3 : 99.9, 1);
+    if (gen->config.constellations > 1) {
+        nmea_put_char(&s, ',');
+        nmea_put_uint(&s, constellation + 1, 1);  // systemID NMEA 4.10
+    }
+    return sentence_end(gen, &s);
+}
+
+// GSV по созвездию: по 4 спутника в сообщении
+static size_t put_gsv(nmea_gen_t* gen, char* out, int constellation) {
+    const nmea_gen_sat_t* sats[NMEA_GEN_MAX_SATS_PER_CONSTELLATION];
+    int count = 0;
+    for (int i = 0; i < gen->sat_count; i++) {
+        if (gen->sats[i].constellation == constellation) sats[count++] = &gen->sats[i];
+    }
+    if (count == 0) return 0;
+
+    int messages = (count + 3) / 4;
+    size_t len = 0;
+    for (int m = 0; m < messages; m++) {
+        nmea_writer_t s;
+        nmea_sentence_begin(&s, out + len, constellation_talker[constellation], "GSV,");
+        nmea_put_uint(&s, messages, 1);
+        nmea_put_char(&s, ',');
+        nmea_put_uint(&s, m + 1, 1);
+        nmea_put_char(&s, ',');
+        nmea_put_uint(&s, count, 2);
+        for (int k = m * 4; k < count && k < m * 4 + 4; k++) {
+            const nmea_gen_sat_t* sat = sats[k];
+            nmea_put_char(&s, ',');
+            nmea_put_uint(&s, sat->prn, 2);
+            nmea_put_char(&s, ',');
+            nmea_put_uint(&s, (uint32_t)sat->elevation, 2);
+            nmea_put_char(&s, ',');
+            nmea_put_uint(&s, (uint32_t)sat->azimuth, 3);
+            nmea_put_char(&s, ',');
+            if (gen->fix) nmea_put_uint(&s, sat->snr, 2);
+        }
+        len += sentence_end(gen, &s);
+    }
+    return len;
+}
+
+static size_t put_vtg(nmea_gen_t* gen, char* out, const char* talker) {
+    nmea_writer_t s;
+    nmea_sentence_begin(&s, out, talker, "VTG,");
+    if (gen->fix) {
+        nmea_put_fixed(&s, gen->heading_deg, 2);
+        nmea_put_str(&s, ",T,,M,");
+        nmea_put_fixed(&s, gen->speed_mps / 0.514444, 3);
+        nmea_put_str(&s, ",N,");
+        nmea_put_fixed(&s, gen->speed_mps * 3.6, 3);
+        nmea_put_str(&s, ",K,A");
+    } else {
+        nmea_put_str(&s, ",T,,M,,N,,K,N");
+    }
+    return sentence_end(gen, &s);
+}
+
+// UBX NAV-PVT (класс 0x01, id 0x07, 92 байта полезной нагрузки)
+static size_t put_nav_pvt(nmea_gen_t* gen, char* out) {
+    uint8_t* frame = (uint8_t*)out;
+    uint8_t* p = frame + 6;
+    memset(p, 0, 92);
+
+    int year, month, day;
+    nmea_civil_from_days(gen->time_ms / 86400000, &year, &month, &day);
+    int64_t tod = gen->time_ms % 86400000;
+    int64_t gps_ms = gen->time_ms - UBX_GPS_EPOCH_UNIX_MS + UBX_GPS_LEAP_SECONDS * 1000;
+    int used = used_count(gen);
+    double heading = gen->heading_deg * DEG_TO_RAD;
+
+    ubx_put_u32(p + 0, (uint32_t)(gps_ms % GPS_WEEK_MS));
+    ubx_put_u16(p + 4, year);
+    p[6] = month;
+    p[7] = day;
+    p[8] = (uint8_t)(tod / 3600000);
+    p[9] = (uint8_t)(tod / 60000 % 60);
+    p[10] = (uint8_t)(tod / 1000 % 60);
+    p[11] = 0x07;                                             // validDate | validTime | fullyResolved
+    ubx_put_u32(p + 12, 20);                                  // tAcc, нс
+    ubx_put_u32(p + 16, (uint32_t)(int32_t)(tod % 1000 * 1000000));
+    p[20] = gen->fix ? 3 : 0;                                 // fixType
+    p[21] = gen->fix ? 0x01 : 0x00;                           // gnssFixOK
+    p[23] = (uint8_t)used;
+    ubx_put_u32(p + 24, (uint32_t)(int32_t)llround(gen->out_lon * 1e7));
+    ubx_put_u32(p + 28, (uint32_t)(int32_t)llround(gen->out_lat * 1e7));
+    ubx_put_u32(p + 32, (uint32_t)(int32_t)llround((gen->config.alt + 14.0) * 1000.0));
+    ubx_put_u32(p + 36, (uint32_t)(int32_t)llround(gen->config.alt * 1000.0));
+    ubx_put_u32(p + 40, gen->fix ? (uint32_t)(gen_hdop(used) * 2500.0) : 0xFFFFFFFFu);
+    ubx_put_u32(p + 44, gen->fix ? (uint32_t)(gen_hdop(used) * 4000.0) : 0xFFFFFFFFu);
+    ubx_put_u32(p + 48, (uint32_t)(int32_t)llround(gen->speed_mps * cos(heading) * 1000.0));
+    ubx_put_u32(p + 52, (uint32_t)(int32_t)llround(gen->speed_mps * sin(heading) * 1000.0));
+    ubx_put_u32(p + 60, (uint32_t)(int32_t)llround(gen->speed_mps * 1000.0));
+    ubx_put_u32(p + 64, (uint32_t)(int32_t)llround(gen->heading_deg * 1e5));
+    ubx_put_u32(p + 68, 300);                                 // sAcc, мм/с
+    ubx_put_u32(p + 72, 500000);                              // headAcc, 1e-5 градуса
+    ubx_put_u16(p + 76, (uint32_t)(gen_hdop(used) * 160.0));  // pDOP * 0.01
+
+    return ubx_frame_finish(frame, UBX_CLASS_NAV, UBX_NAV_PVT, 92);
+}
+
+size_t nmea_gen_epoch(nmea_gen_t* gen, char* out) {
+    const nmea_gen_config_t* config = &gen->config;
+    gen->time_ms = config->start_ms + (int64_t)(gen->epoch * 1000 / config->rate_hz);
+    gen_advance(gen);
+
+    // Несколько созвездий - общие предложения с talker GN
+    const char* talker = (config->constellations > 1) ? "GN" : "GP";
+    size_t len = 0;
+    if (config->sentences & NMEA_GEN_RMC) len += put_rmc(gen, out + len, talker);
+    if (config->sentences & NMEA_GEN_GGA) len += put_gga(gen, out + len, talker);
+    if (config->sentences & NMEA_GEN_GSA) {
+        for (int c = 0; c < config->constellations; c++) {
+            len += put_gsa(gen, out + len, talker, c);
+        }
+    }
+    if (config->sentences & NMEA_GEN_GSV) {
+        for (int c = 0; c < config->constellations; c++) {
+            len += put_gsv(gen, out + len, c);
+        }
+    }
+    if (config->sentences & NMEA_GEN_VTG) len += put_vtg(gen, out + len, talker);
+    if (config->sentences & NMEA_GEN_NAV_PVT) len += put_nav_pvt(gen, out + len);
+
+    gen->epoch++;
+    return len;
+}
+
+size_t nmea_gen_fill(nmea_gen_t* gen, char* out, size_t capacity) {
+    size_t len = 0;
+    while (capacity - len >= NMEA_GEN_MAX_EPOCH) {
+        len += nmea_gen_epoch(gen, out + len);
+    }
+    return len;
+}
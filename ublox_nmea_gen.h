@@ -0,0 +1,97 @@
+#ifndef UBLOX_NMEA_GEN_H
+#define UBLOX_NMEA_GEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Генератор синтетического трафика NMEA (нагрузочные и регрессионные тесты без приемника)
+
+// Траектории
+typedef enum {
+    NMEA_GEN_STRAIGHT = 0,  // прямая с постоянной скоростью
+    NMEA_GEN_CIRCLE,        // окружность радиуса radius_m
+    NMEA_GEN_STOP_GO,       // прямая: period_s движения, period_s стоянки
+    NMEA_GEN_TUNNEL,        // прямая: каждые period_s пропадание фикса на event_s
+    NMEA_GEN_JUMPS,         // прямая: каждые period_s одна эпоха со скачком на jump_m
+} nmea_gen_trajectory_t;
+
+// Предложения эпохи (маска); порядок вывода - как в списке
+#define NMEA_GEN_RMC     0x01
+#define NMEA_GEN_GGA     0x02
+#define NMEA_GEN_GSA     0x04
+#define NMEA_GEN_GSV     0x08
+#define NMEA_GEN_VTG     0x10
+#define NMEA_GEN_NAV_PVT 0x20   // UBX NAV-PVT (двоичный)
+#define NMEA_GEN_ALL_NMEA (NMEA_GEN_RMC | NMEA_GEN_GGA | NMEA_GEN_GSA | NMEA_GEN_GSV | NMEA_GEN_VTG)
+
+// Созвездия: GPS, ГЛОНАСС, Galileo, BeiDou; GSV - не больше 9 сообщений по 4 спутника
+#define NMEA_GEN_MAX_CONSTELLATIONS 4
+#define NMEA_GEN_MAX_SATS_PER_CONSTELLATION 36
+#define NMEA_GEN_MAX_SATS (NMEA_GEN_MAX_CONSTELLATIONS * NMEA_GEN_MAX_SATS_PER_CONSTELLATION)
+
+// Верхняя граница размера одной эпохи (все предложения, порча, NAV-PVT)
+#define NMEA_GEN_MAX_EPOCH 8192
+
+typedef struct {
+    nmea_gen_trajectory_t trajectory;
+    double lat;             // старт, градусы
+    double lon;
+    double alt;             // м
+    double speed_mps;
+    double heading_deg;
+    double radius_m;        // CIRCLE
+    double period_s;        // STOP_GO / TUNNEL / JUMPS
+    double event_s;         // TUNNEL: длительность пропадания
+    double jump_m;          // JUMPS: величина скачка
+    int64_t start_ms;       // UTC первой эпохи, мс от 1970-01-01
+    uint16_t rate_hz;       // эпох в секунду (1..100)
+    uint8_t constellations; // 1..4
+    uint8_t satellites;     // видимых всего
+    uint8_t sentences;      // маска NMEA_GEN_*
+    uint32_t corrupt_ppm;   // вероятность порчи предложения, на миллион
+    uint32_t seed;
+} nmea_gen_config_t;
+
+typedef struct {
+    uint16_t prn;
+    uint8_t constellation;
+    float elevation;
+    float azimuth;
+    float azimuth_rate;     // градусов за эпоху
+    uint8_t snr;
+} nmea_gen_sat_t;
+
+typedef struct {
+    nmea_gen_config_t config;
+    uint64_t epoch;
+    int64_t time_ms;        // UTC текущей эпохи
+    double lat;             // истинная позиция (без скачков)
+    double lon;
+    double heading_deg;
+    double speed_mps;       // текущая скорость (STOP_GO)
+    uint8_t fix;            // фикс в текущей эпохе (TUNNEL)
+    double out_lat;         // выведенная позиция (со скачком)
+    double out_lon;
+    uint32_t rng;
+    uint8_t sat_count;
+    nmea_gen_sat_t sats[NMEA_GEN_MAX_SATS];
+} nmea_gen_t;
+
+void nmea_gen_config_default(nmea_gen_config_t* config);
+
+// Маска предложений из списка "RMC,GGA,GSA,GSV,VTG,PVT"; -1 при неизвестном имени
+int nmea_gen_parse_sentences(const char* list);
+
+// Траектория по имени ("straight", "circle", "stop_go", "tunnel", "jumps"); -1 при неизвестном
+int nmea_gen_parse_trajectory(const char* name);
+
+// 0 при недопустимых параметрах
+int nmea_gen_init(nmea_gen_t* gen, const nmea_gen_config_t* config);
+
+// Одна эпоха в out (нужно не меньше NMEA_GEN_MAX_EPOCH байт); возвращает длину
+size_t nmea_gen_epoch(nmea_gen_t* gen, char* out);
+
+// Целые эпохи, пока в out остается не меньше NMEA_GEN_MAX_EPOCH байт; возвращает длину
+size_t nmea_gen_fill(nmea_gen_t* gen, char* out, size_t capacity);
+
+#endif
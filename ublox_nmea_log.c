@@ -0,0 +1,588 @@
+#include "ublox_nmea_log.h"
+#include <string.h>
+
+// Пакетный разбор логов NMEA в колонки (без объектов Python на эпоху)
+
+// Предложение несет время эпохи (RMC/GGA)
+static int is_epoch_type(const char* type) {
+    return (type[0] == 'R' && type[1] == 'M' && type[2] == 'C') ||
+           (type[0] == 'G' && type[1] == 'G' && type[2] == 'A');
+}
+
+void nmea_log_prescan_init(nmea_log_prescan_t* prescan) {
+    prescan->count = 0;
+    prescan->header_pos = 0;
+}
+
+// Подсчет заголовков "$??RMC" / "$??GGA"; заголовок может попасть на границу блоков
+void nmea_log_prescan_feed(nmea_log_prescan_t* prescan, const char* data, size_t len) {
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end) {
+        if (prescan->header_pos == 0) {
+            p = memchr(p, '$', end - p);
+            if (!p) return;
+            prescan->header_pos = 1;
+            p++;
+            continue;
+        }
+
+        char c = *p;
+        if (c == '$') {
+            prescan->header_pos = 1;
+            p++;
+            continue;
+        }
+
+        if (prescan->header_pos >= 3) {
+            prescan->type[prescan->header_pos - 3] = c;
+        }
+        prescan->header_pos++;
+        p++;
+
+        if (prescan->header_pos == 6) {
+            if (is_epoch_type(prescan->type)) {
+                prescan->count++;
+            }
+            prescan->header_pos = 0;
+        }
+    }
+}
+
+void nmea_log_parser_init(nmea_log_parser_t* parser) {
+    gps_data_init(&parser->gps_data);
+    parser->epoch_tod_ms = -1;
+    parser->position = 0;
+    parser->line_offset = 0;
+    parser->epoch_offset = 0;
+    parser->epoch_open = 0;
+    parser->line_overflow = 0;
+    parser->line_len = 0;
+}
+
+// Время суток (мс) из поля времени hhmmss.ss предложения RMC/GGA; -1 если поля нет
+// Строка ограничена end: функция применяется и к сырым данным (разметка блоков)
+static int32_t sentence_time_of_day(const char* sentence, const char* end) {
+    const char* field = memchr(sentence, ',', end - sentence);
+    if (!field || end - field < 7) return -1;
+    field++;
+
+    for (int i = 0; i < 6; i++) {
+        if (field[i] < '0' || field[i] > '9') return -1;
+    }
+
+    int32_t tod = ((field[0] - '0') * 10 + (field[1] - '0')) * 3600000 +
+                  ((field[2] - '0') * 10 + (field[3] - '0')) * 60000 +
+                  ((field[4] - '0') * 10 + (field[5] - '0')) * 1000;
+
+    if (field + 6 < end && field[6] == '.') {
+        int32_t scale = 100;
+        for (const char* p = field + 7; p < end && *p >= '0' && *p <= '9' && scale > 0; p++) {
+            tod += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+    return tod;
+}
+
+// Запись строки колонок из накопленного состояния
+static void emit_epoch(nmea_log_parser_t* parser, nmea_columns_t* columns) {
+    if (columns->count >= columns->capacity) {
+        columns->dropped++;
+        return;
+    }
+
+    const gps_data_t* gps = &parser->gps_data;
+    size_t i = columns->count++;
+    columns->time_ms[i] = gps_data_utc_ms(gps);
+    columns->latitude[i] = gps->latitude;
+    columns->longitude[i] = gps->longitude;
+    columns->altitude[i] = gps->altitude;
+    columns->speed[i] = gps->speed;
+    columns->hdop[i] = gps->hdop;
+    columns->satellites[i] = gps->has_satellites_used ? gps->satellites_used : 0;
+    if (columns->offset) {
+        columns->offset[i] = (int64_t)parser->epoch_offset;
+    }
+}
+
+// Обработка одной полной строки (line - нуль-терминированная, начинается с '$')
+static void process_line(nmea_log_parser_t* parser, const char* line, size_t len, nmea_columns_t* columns) {
+    if (len < 6) return;
+
+    // GSV не влияет ни на одну колонку - пропускаем без проверки контрольной суммы
+    const char* type = line + 3;
+    if (type[0] == 'G' && type[1] == 'S' && type[2] == 'V') return;
+
+    if (!nmea_checksum_valid(line)) return;
+
+    // Новое время UTC закрывает предыдущую эпоху до применения предложения
+    if (is_epoch_type(type)) {
+        int32_t tod = sentence_time_of_day(line, line + len);
+        if (tod >= 0 && tod != parser->epoch_tod_ms) {
+            if (parser->epoch_open) {
+                emit_epoch(parser, columns);
+            }
+            parser->epoch_tod_ms = tod;
+            parser->epoch_offset = parser->line_offset;
+            parser->epoch_open = 1;
+        }
+    }
+
+    nmea_dispatch_sentence(line, &parser->gps_data);
+}
+
+// Потоковая подача данных: строки собираются во внутреннем буфере через границы блоков
+void nmea_log_parser_feed(nmea_log_parser_t* parser, const char* data, size_t len, nmea_columns_t* columns) {
+    const char* p = data;
+    const char* end = data + len;
+    uint64_t base = parser->position;
+    parser->position += len;
+
+    while (p < end) {
+        const char* nl = memchr(p, '\n', end - p);
+        const char* chunk_end = nl ? nl : end;
+
+        // Начало предложения - '$'; мусор до него (например, бинарный UBX) отбрасывается
+        if (parser->line_len == 0 && !parser->line_overflow) {
+            const char* dollar = memchr(p, '$', chunk_end - p);
+            if (!dollar) {
+                p = nl ? nl + 1 : end;
+                continue;
+            }
+            p = dollar;
+            parser->line_offset = base + (uint64_t)(dollar - data);
+        }
+
+        size_t piece = chunk_end - p;
+        if (!parser->line_overflow) {
+            if (parser->line_len + piece <= NMEA_LOG_MAX_LINE) {
+                memcpy(parser->line + parser->line_len, p, piece);
+                parser->line_len += piece;
+            } else {
+                parser->line_overflow = 1;
+            }
+        }
+
+        if (!nl) return;
+
+        // Полная строка
+        if (!parser->line_overflow) {
+            size_t line_len = parser->line_len;
+            if (line_len > 0 && parser->line[line_len - 1] == '\r') line_len--;
+            parser->line[line_len] = '\0';
+            process_line(parser, parser->line, line_len, columns);
+        }
+
+        parser->line_len = 0;
+        parser->line_overflow = 0;
+        p = nl + 1;
+    }
+}
+
+// Завершение: последняя строка без перевода строки и последняя эпоха
+void nmea_log_parser_finish(nmea_log_parser_t* parser, nmea_columns_t* columns) {
+    if (parser->line_len > 0 && !parser->line_overflow) {
+        size_t line_len = parser->line_len;
+        if (parser->line[line_len - 1] == '\r') line_len--;
+        parser->line[line_len] = '\0';
+        process_line(parser, parser->line, line_len, columns);
+    }
+    parser->line_len = 0;
+    parser->line_overflow = 0;
+
+    if (parser->epoch_open) {
+        emit_epoch(parser, columns);
+        parser->epoch_open = 0;
+    }
+}
+
+void nmea_log_indexer_init(nmea_log_indexer_t* indexer, uint32_t every) {
+    nmea_log_parser_init(&indexer->parser);
+    indexer->columns.time_ms = indexer->time_ms;
+    indexer->columns.latitude = indexer->values[0];
+    indexer->columns.longitude = indexer->values[1];
+    indexer->columns.altitude = indexer->values[2];
+    indexer->columns.speed = indexer->values[3];
+    indexer->columns.hdop = indexer->values[4];
+    indexer->columns.satellites = indexer->satellites;
+    indexer->columns.offset = indexer->offset;
+    indexer->columns.capacity = NMEA_LOG_INDEX_BATCH;
+    indexer->columns.count = 0;
+    indexer->columns.dropped = 0;
+    indexer->every = every ? every : 1;
+    indexer->since_entry = 0;
+    indexer->has_entry = 0;
+}
+
+// Отбор каждой every-й эпохи с известным временем из строк последнего вызова
+static size_t indexer_collect(nmea_log_indexer_t* indexer) {
+    size_t n = 0;
+    for (size_t i = 0; i < indexer->columns.count; i++) {
+        if (indexer->time_ms[i] >= 0 && (!indexer->has_entry || indexer->since_entry >= indexer->every)) {
+            indexer->entries[n].time_ms = indexer->time_ms[i];
+            indexer->entries[n].offset = (uint64_t)indexer->offset[i];
+            n++;
+            indexer->since_entry = 0;
+            indexer->has_entry = 1;
+        }
+        indexer->since_entry++;
+    }
+    indexer->columns.count = 0;
+    return n;
+}
+
+size_t nmea_log_indexer_feed(nmea_log_indexer_t* indexer, const char* data, size_t len) {
+    nmea_log_parser_feed(&indexer->parser, data, len, &indexer->columns);
+    return indexer_collect(indexer);
+}
+
+size_t nmea_log_indexer_finish(nmea_log_indexer_t* indexer) {
+    nmea_log_parser_finish(&indexer->parser, &indexer->columns);
+    return indexer_collect(indexer);
+}
+
+static void put_le64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static const char index_magic[8] = { 'N', 'M', 'E', 'A', 'I', 'D', 'X', '1' };
+
+void nmea_log_index_pack_header(uint8_t* out, uint32_t every, uint64_t source_size, uint64_t count) {
+    memcpy(out, index_magic, 8);
+    put_le64(out + 8, every);
+    put_le64(out + 16, source_size);
+    put_le64(out + 24, count);
+}
+
+int nmea_log_index_unpack_header(const uint8_t* in, uint32_t* every, uint64_t* source_size, uint64_t* count) {
+    if (memcmp(in, index_magic, 8) != 0) return 0;
+    *every = (uint32_t)get_le64(in + 8);
+    *source_size = get_le64(in + 16);
+    *count = get_le64(in + 24);
+    return 1;
+}
+
+void nmea_log_index_pack_entry(uint8_t* out, const nmea_log_index_entry_t* entry) {
+    put_le64(out, (uint64_t)entry->time_ms);
+    put_le64(out + 8, entry->offset);
+}
+
+static int64_t index_entry_time(const uint8_t* entries, size_t i) {
+    return (int64_t)get_le64(entries + i * NMEA_LOG_INDEX_ENTRY_SIZE);
+}
+
+static uint64_t index_entry_offset(const uint8_t* entries, size_t i) {
+    return get_le64(entries + i * NMEA_LOG_INDEX_ENTRY_SIZE + 8);
+}
+
+// Первая запись со временем > time_ms (записи упорядочены по времени)
+static size_t index_upper_bound(const uint8_t* entries, size_t count, int64_t time_ms) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index_entry_time(entries, mid) <= time_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void nmea_log_index_range(const uint8_t* entries, size_t count, uint32_t every, int64_t from_ms, int64_t to_ms,
+                          uint64_t* start, uint64_t* stop) {
+    // Последняя запись с time <= from_ms содержит начало окна; записи перед ней - прогрев
+    // накопленного состояния, чтобы первые строки окна совпали с полным разбором
+    size_t warmup = 1 + (NMEA_LOG_INDEX_WARMUP + (every ? every : 1) - 1) / (every ? every : 1);
+    size_t first = index_upper_bound(entries, count, from_ms);
+    first = (first > warmup) ? first - warmup : 0;
+    *start = (count > 0 && first > 0) ? index_entry_offset(entries, first) : 0;
+
+    size_t last = index_upper_bound(entries, count, to_ms);
+    *stop = (last < count) ? index_entry_offset(entries, last) : UINT64_MAX;
+}
+
+void nmea_columns_filter_time(nmea_columns_t* columns, int64_t from_ms, int64_t to_ms) {
+    size_t n = 0;
+    for (size_t i = 0; i < columns->count; i++) {
+        int64_t t = columns->time_ms[i];
+        if (t < from_ms || t > to_ms) continue;
+        if (n != i) {
+            columns->time_ms[n] = t;
+            columns->latitude[n] = columns->latitude[i];
+            columns->longitude[n] = columns->longitude[i];
+            columns->altitude[n] = columns->altitude[i];
+            columns->speed[n] = columns->speed[i];
+            columns->hdop[n] = columns->hdop[i];
+            columns->satellites[n] = columns->satellites[i];
+            if (columns->offset) columns->offset[n] = columns->offset[i];
+        }
+        n++;
+    }
+    columns->count = n;
+}
+
+#if NMEA_LOG_THREADS
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Минимальный размер блока на поток: на меньших данных потоки не окупаются
+#define NMEA_LOG_MIN_CHUNK (256 * 1024)
+// Окно поиска границы эпохи после точки разреза
+#define NMEA_LOG_ALIGN_WINDOW 4096
+
+int nmea_columns_alloc(nmea_columns_t* columns, size_t capacity) {
+    size_t n = capacity ? capacity : 1;
+    memset(columns, 0, sizeof(*columns));
+    columns->time_ms = malloc(n * sizeof(int64_t));
+    columns->latitude = malloc(n * sizeof(double));
+    columns->longitude = malloc(n * sizeof(double));
+    columns->altitude = malloc(n * sizeof(double));
+    columns->speed = malloc(n * sizeof(double));
+    columns->hdop = malloc(n * sizeof(double));
+    columns->satellites = malloc(n);
+    columns->capacity = capacity;
+
+    if (!columns->time_ms || !columns->latitude || !columns->longitude || !columns->altitude ||
+        !columns->speed || !columns->hdop || !columns->satellites) {
+        nmea_columns_free(columns);
+        return 0;
+    }
+    return 1;
+}
+
+void nmea_columns_free(nmea_columns_t* columns) {
+    free(columns->time_ms);
+    free(columns->latitude);
+    free(columns->longitude);
+    free(columns->altitude);
+    free(columns->speed);
+    free(columns->hdop);
+    free(columns->satellites);
+    memset(columns, 0, sizeof(*columns));
+}
+
+// Дописать строки [from, to) колонок src в конец dst
+static void columns_append(nmea_columns_t* dst, const nmea_columns_t* src, size_t from, size_t to) {
+    size_t n = to - from;
+    size_t i = dst->count;
+    memcpy(dst->time_ms + i, src->time_ms + from, n * sizeof(int64_t));
+    memcpy(dst->latitude + i, src->latitude + from, n * sizeof(double));
+    memcpy(dst->longitude + i, src->longitude + from, n * sizeof(double));
+    memcpy(dst->altitude + i, src->altitude + from, n * sizeof(double));
+    memcpy(dst->speed + i, src->speed + from, n * sizeof(double));
+    memcpy(dst->hdop + i, src->hdop + from, n * sizeof(double));
+    memcpy(dst->satellites + i, src->satellites + from, n);
+    dst->count += n;
+}
+
+static int same_double(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Совпадение состояния в полях, от которых зависят колонки (сейчас и после любых следующих строк).
+// Остальные поля (курс, VDOP, видимые спутники...) на колонки не влияют - иначе один
+// редкий VTG в начале лога не давал бы блокам сойтись никогда
+static int parser_columns_state_equal(const nmea_log_parser_t* a, const nmea_log_parser_t* b) {
+    const gps_data_t* x = &a->gps_data;
+    const gps_data_t* y = &b->gps_data;
+    return a->epoch_tod_ms == b->epoch_tod_ms && a->epoch_open == b->epoch_open &&
+           same_double(x->latitude, y->latitude) && same_double(x->longitude, y->longitude) &&
+           same_double(x->altitude, y->altitude) && same_double(x->speed, y->speed) &&
+           same_double(x->hdop, y->hdop) &&
+           x->satellites_used == y->satellites_used && x->has_satellites_used == y->has_satellites_used &&
+           x->has_gga == y->has_gga &&
+           x->year == y->year && x->month == y->month && x->day == y->day &&
+           x->hour == y->hour && x->minute == y->minute && x->second == y->second &&
+           x->millisecond == y->millisecond;
+}
+
+// Начало строки с RMC/GGA
+static int is_epoch_line(const char* p, const char* end) {
+    return end - p >= 6 && p[0] == '$' && is_epoch_type(p + 3);
+}
+
+// Точка разреза не раньше pos: начало строки, по возможности - первая строка новой эпохи.
+// Выравнивание по эпохе только сокращает согласование блоков, корректность от него не зависит
+static size_t align_chunk_start(const char* data, size_t len, size_t pos) {
+    const char* end = data + len;
+    const char* p = data + pos;
+    if (pos > 0 && p[-1] != '\n') {
+        p = memchr(p, '\n', end - p);
+        if (!p) return len;
+        p++;
+    }
+    const char* line_start = p;
+    const char* limit = (end - p > NMEA_LOG_ALIGN_WINDOW) ? p + NMEA_LOG_ALIGN_WINDOW : end;
+
+    int32_t first_tod = -1;
+    while (p < limit) {
+        const char* nl = memchr(p, '\n', end - p);
+        const char* line_end = nl ? nl : end;
+        if (is_epoch_line(p, line_end)) {
+            int32_t tod = sentence_time_of_day(p, line_end);
+            if (tod >= 0) {
+                if (first_tod < 0) {
+                    first_tod = tod;
+                } else if (tod != first_tod) {
+                    return p - data;
+                }
+            }
+        }
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return line_start - data;
+}
+
+// Блок лога, разбираемый отдельным потоком с собственным состоянием
+typedef struct {
+    const char* data;
+    size_t len;
+    nmea_columns_t columns;
+    nmea_log_parser_t parser;
+    int ok;
+} nmea_log_chunk_t;
+
+static void* chunk_worker(void* arg) {
+    nmea_log_chunk_t* chunk = arg;
+    nmea_log_prescan_t prescan;
+    nmea_log_prescan_init(&prescan);
+    nmea_log_prescan_feed(&prescan, chunk->data, chunk->len);
+
+    chunk->ok = nmea_columns_alloc(&chunk->columns, prescan.count);
+    if (chunk->ok) {
+        // Без finish: последняя эпоха блока закрывается при согласовании со следующим
+        nmea_log_parser_init(&chunk->parser);
+        nmea_log_parser_feed(&chunk->parser, chunk->data, chunk->len, &chunk->columns);
+    }
+    return NULL;
+}
+
+// Согласование блока со состоянием carry (точное состояние на конце предыдущего блока).
+// Блок повторно разбирается построчно от carry и от пустого состояния одновременно, пока
+// влияющие на колонки поля не совпадут; дальше строки потока верны как есть.
+// В head попадают исправленные строки, *skip - сколько первых строк потока они заменяют.
+// Возвращает 1, если состояния сошлись (иначе carry - состояние после всего блока)
+static int reconcile_chunk(const nmea_log_chunk_t* chunk, nmea_log_parser_t* carry,
+                           nmea_columns_t* head, size_t* skip) {
+    nmea_log_parser_t* fresh = malloc(sizeof(nmea_log_parser_t));
+    if (!fresh) return -1;
+    nmea_log_parser_init(fresh);
+
+    // Пустые колонки: строки свежего разбора только считаются в dropped
+    nmea_columns_t counter;
+    memset(&counter, 0, sizeof(counter));
+
+    const char* p = chunk->data;
+    const char* end = chunk->data + chunk->len;
+    int converged = 0;
+    while (p < end && !converged) {
+        const char* nl = memchr(p, '\n', end - p);
+        const char* line_end = nl ? nl + 1 : end;
+        nmea_log_parser_feed(carry, p, line_end - p, head);
+        nmea_log_parser_feed(fresh, p, line_end - p, &counter);
+        converged = parser_columns_state_equal(carry, fresh);
+        p = line_end;
+    }
+
+    *skip = counter.dropped;
+    free(fresh);
+    return converged;
+}
+
+int nmea_log_parse_parallel(const char* data, size_t len, size_t workers, nmea_columns_t* columns) {
+    if (workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 0 ? (size_t)online : 1;
+    }
+    if (workers > len / NMEA_LOG_MIN_CHUNK) workers = len / NMEA_LOG_MIN_CHUNK;
+    if (workers > NMEA_LOG_MAX_WORKERS) workers = NMEA_LOG_MAX_WORKERS;
+    if (workers == 0) workers = 1;
+
+    nmea_log_chunk_t* chunks = calloc(workers, sizeof(nmea_log_chunk_t));
+    pthread_t* threads = calloc(workers, sizeof(pthread_t));
+    uint8_t* started = calloc(workers, 1);
+    nmea_log_parser_t* carry = malloc(sizeof(nmea_log_parser_t));
+    int result = -1;
+    memset(columns, 0, sizeof(*columns));
+    if (!chunks || !threads || !started || !carry) goto done;
+
+    // Разметка блоков по началам строк
+    size_t start = 0;
+    for (size_t i = 0; i < workers; i++) {
+        size_t next = (i + 1 == workers) ? len : align_chunk_start(data, len, len / workers * (i + 1));
+        if (next < start) next = start;
+        chunks[i].data = data + start;
+        chunks[i].len = next - start;
+        start = next;
+    }
+
+    // Первый поток - вызывающий, остальные - pthread
+    for (size_t i = 1; i < workers; i++) {
+        started[i] = pthread_create(&threads[i], NULL, chunk_worker, &chunks[i]) == 0;
+        if (!started[i]) chunk_worker(&chunks[i]);
+    }
+    chunk_worker(&chunks[0]);
+    for (size_t i = 1; i < workers; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    size_t capacity = 1;
+    for (size_t i = 0; i < workers; i++) {
+        if (!chunks[i].ok) goto done;
+        capacity += chunks[i].columns.count + 1;
+    }
+    if (!nmea_columns_alloc(columns, capacity)) goto done;
+
+    // Сшивка по порядку: исправленное начало блока + остаток строк потока
+    columns_append(columns, &chunks[0].columns, 0, chunks[0].columns.count);
+    *carry = chunks[0].parser;
+    for (size_t i = 1; i < workers; i++) {
+        nmea_columns_t head;
+        size_t skip;
+        if (!nmea_columns_alloc(&head, chunks[i].columns.count + 1)) goto done;
+
+        int converged = reconcile_chunk(&chunks[i], carry, &head, &skip);
+        if (converged < 0) {
+            nmea_columns_free(&head);
+            goto done;
+        }
+        columns_append(columns, &head, 0, head.count);
+        if (skip < chunks[i].columns.count) {
+            columns_append(columns, &chunks[i].columns, skip, chunks[i].columns.count);
+        }
+        if (converged) *carry = chunks[i].parser;
+        nmea_columns_free(&head);
+    }
+    nmea_log_parser_finish(carry, columns);
+    result = 0;
+
+done:
+    if (chunks) {
+        for (size_t i = 0; i < workers; i++) nmea_columns_free(&chunks[i].columns);
+    }
+    if (result != 0) nmea_columns_free(columns);
+    free(chunks);
+    free(threads);
+    free(started);
+    free(carry);
+    return result;
+}
+
+#endif
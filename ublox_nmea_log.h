@@ -0,0 +1,123 @@
+#ifndef UBLOX_NMEA_LOG_H
+#define UBLOX_NMEA_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_core.h"
+
+// Максимальная длина строки лога (стандарт NMEA - 82 символа)
+#ifndef NMEA_LOG_MAX_LINE
+#define NMEA_LOG_MAX_LINE 127
+#endif
+
+// Многопоточный разбор (pthreads): включается сборкой для unix / CPython
+#ifndef NMEA_LOG_THREADS
+#define NMEA_LOG_THREADS 0
+#endif
+
+#define NMEA_LOG_MAX_WORKERS 64
+
+// Колонки результата пакетного разбора: одна строка на эпоху (группа предложений с одним временем UTC)
+typedef struct {
+    int64_t* time_ms;       // мс UTC от 1970-01-01, -1 пока дата неизвестна
+    double* latitude;
+    double* longitude;
+    double* altitude;
+    double* speed;
+    double* hdop;
+    uint8_t* satellites;
+    int64_t* offset;        // смещение первого предложения эпохи в потоке (NULL - не заполняется)
+    size_t capacity;
+    size_t count;
+    size_t dropped;         // эпохи, не поместившиеся в колонки
+} nmea_columns_t;
+
+// Предварительный подсчет: верхняя граница числа эпох (количество RMC + GGA)
+typedef struct {
+    size_t count;
+    uint8_t header_pos;     // позиция в заголовке "$ttSSS" на границе блоков
+    char type[3];
+} nmea_log_prescan_t;
+
+// Состояние потокового разбора лога
+typedef struct {
+    gps_data_t gps_data;
+    int32_t epoch_tod_ms;   // время суток текущей эпохи
+    uint64_t position;      // байт потока подано до текущего вызова feed
+    uint64_t line_offset;   // смещение '$' текущей строки
+    uint64_t epoch_offset;  // смещение первого предложения текущей эпохи
+    uint8_t epoch_open;
+    uint8_t line_overflow;
+    size_t line_len;
+    char line[NMEA_LOG_MAX_LINE + 1];
+} nmea_log_parser_t;
+
+void nmea_log_prescan_init(nmea_log_prescan_t* prescan);
+void nmea_log_prescan_feed(nmea_log_prescan_t* prescan, const char* data, size_t len);
+
+void nmea_log_parser_init(nmea_log_parser_t* parser);
+void nmea_log_parser_feed(nmea_log_parser_t* parser, const char* data, size_t len, nmea_columns_t* columns);
+void nmea_log_parser_finish(nmea_log_parser_t* parser, nmea_columns_t* columns);
+
+// Индекс лога: смещение первого предложения каждой N-й эпохи и ее время UTC
+#define NMEA_LOG_INDEX_BATCH 64
+// Наибольший кусок на вызов nmea_log_indexer_feed: строка, открывающая эпоху, не короче 14 байт,
+// поэтому за вызов закрывается не больше NMEA_LOG_INDEX_BATCH эпох
+#define NMEA_LOG_INDEX_SLICE ((NMEA_LOG_INDEX_BATCH - 2) * 14)
+
+// Файл индекса (little-endian): заголовок "NMEAIDX1", every (u64),
+// размер исходного лога (u64), число записей (u64); записи: time_ms (i64), offset (u64)
+#define NMEA_LOG_INDEX_HEADER_SIZE 32
+#define NMEA_LOG_INDEX_ENTRY_SIZE 16
+
+typedef struct {
+    int64_t time_ms;
+    uint64_t offset;
+} nmea_log_index_entry_t;
+
+typedef struct {
+    nmea_log_parser_t parser;
+    nmea_columns_t columns;         // строки эпох одного вызова feed
+    int64_t time_ms[NMEA_LOG_INDEX_BATCH];
+    int64_t offset[NMEA_LOG_INDEX_BATCH];
+    double values[5][NMEA_LOG_INDEX_BATCH];
+    uint8_t satellites[NMEA_LOG_INDEX_BATCH];
+    uint32_t every;
+    uint32_t since_entry;           // эпох после последней записи
+    uint8_t has_entry;
+    nmea_log_index_entry_t entries[NMEA_LOG_INDEX_BATCH];
+} nmea_log_indexer_t;
+
+void nmea_log_indexer_init(nmea_log_indexer_t* indexer, uint32_t every);
+// Новые записи - в indexer->entries, возвращается их число; len <= NMEA_LOG_INDEX_SLICE
+size_t nmea_log_indexer_feed(nmea_log_indexer_t* indexer, const char* data, size_t len);
+size_t nmea_log_indexer_finish(nmea_log_indexer_t* indexer);
+
+void nmea_log_index_pack_header(uint8_t* out, uint32_t every, uint64_t source_size, uint64_t count);
+// 0 - не файл индекса
+int nmea_log_index_unpack_header(const uint8_t* in, uint32_t* every, uint64_t* source_size, uint64_t* count);
+void nmea_log_index_pack_entry(uint8_t* out, const nmea_log_index_entry_t* entry);
+
+// Эпох перед окном, разбираемых для прогрева накопленного состояния (дата, HDOP, GGA)
+#define NMEA_LOG_INDEX_WARMUP 16
+
+// Диапазон байт лога [*start, *stop) с эпохами от from_ms до to_ms по упакованным записям
+// индекса с шагом every; *stop = UINT64_MAX - до конца файла
+void nmea_log_index_range(const uint8_t* entries, size_t count, uint32_t every, int64_t from_ms, int64_t to_ms,
+                          uint64_t* start, uint64_t* stop);
+
+// Оставить строки с from_ms <= time <= to_ms (на месте)
+void nmea_columns_filter_time(nmea_columns_t* columns, int64_t from_ms, int64_t to_ms);
+
+#if NMEA_LOG_THREADS
+// Колонки в куче (malloc); 0 при нехватке памяти
+int nmea_columns_alloc(nmea_columns_t* columns, size_t capacity);
+void nmea_columns_free(nmea_columns_t* columns);
+
+// Разбор буфера в workers потоках (0 - по числу ядер) с тем же результатом, что и
+// последовательный разбор. Колонки выделяются внутри, освобождение - nmea_columns_free.
+// Возвращает 0 или -1 при нехватке памяти
+int nmea_log_parse_parallel(const char* data, size_t len, size_t workers, nmea_columns_t* columns);
+#endif
+
+#endif
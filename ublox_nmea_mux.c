@@ -0,0 +1,73 @@
+#include "ublox_nmea_mux.h"
+
+size_t nmea_mux_table_size(size_t capacity) {
+    size_t size = 16;
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+    return size;
+}
+
+void nmea_mux_init(nmea_mux_t* mux, nmea_mux_device_t* devices, int32_t* table, size_t capacity) {
+    mux->devices = devices;
+    mux->table = table;
+    mux->table_mask = nmea_mux_table_size(capacity) - 1;
+    mux->capacity = capacity;
+    mux->count = 0;
+    for (size_t i = 0; i <= mux->table_mask; i++) {
+        table[i] = -1;
+    }
+}
+
+// Перемешивание id (соседние id не должны собираться в один кластер)
+static size_t mux_hash(uint32_t device_id) {
+    uint32_t h = device_id * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+nmea_mux_device_t* nmea_mux_find(nmea_mux_t* mux, uint32_t device_id, int create) {
+    size_t slot = mux_hash(device_id) & mux->table_mask;
+    for (;;) {
+        int32_t index = mux->table[slot];
+        if (index < 0) break;
+        if (mux->devices[index].device_id == device_id) {
+            return &mux->devices[index];
+        }
+        slot = (slot + 1) & mux->table_mask;
+    }
+
+    if (!create || mux->count >= mux->capacity) return NULL;
+
+    nmea_mux_device_t* device = &mux->devices[mux->count];
+    device->device_id = device_id;
+    nmea_log_parser_init(&device->parser);
+    mux->table[slot] = (int32_t)mux->count;
+    mux->count++;
+    return device;
+}
+
+// Пометка новых строк out устройством
+static size_t mark_rows(nmea_columns_t* out, size_t before, uint32_t* device_ids, uint32_t device_id) {
+    for (size_t i = before; i < out->count; i++) {
+        device_ids[i] = device_id;
+    }
+    return out->count - before;
+}
+
+int nmea_mux_feed(nmea_mux_t* mux, uint32_t device_id, const char* data, size_t len,
+                  nmea_columns_t* out, uint32_t* device_ids) {
+    nmea_mux_device_t* device = nmea_mux_find(mux, device_id, 1);
+    if (!device) return -1;
+
+    size_t before = out->count;
+    nmea_log_parser_feed(&device->parser, data, len, out);
+    return (int)mark_rows(out, before, device_ids, device_id);
+}
+
+size_t nmea_mux_flush(nmea_mux_device_t* device, nmea_columns_t* out, uint32_t* device_ids) {
+    size_t before = out->count;
+    nmea_log_parser_finish(&device->parser, out);
+    size_t rows = mark_rows(out, before, device_ids, device->device_id);
+    nmea_log_parser_init(&device->parser);
+    return rows;
+}
@@ -0,0 +1,45 @@
+#ifndef UBLOX_NMEA_MUX_H
+#define UBLOX_NMEA_MUX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_log.h"
+
+// Мультиплексор потоков NMEA от многих устройств (шлюз): у каждого устройства свое состояние
+// разбора, все состояния лежат подряд в одной арене, поиск по id - открытая адресация
+
+// Верхняя граница числа эпох, завершаемых подачей len байт (строка эпохи не короче 14 байт)
+#define NMEA_MUX_MAX_ROWS(len) ((len) / 14 + 2)
+
+typedef struct {
+    uint32_t device_id;
+    nmea_log_parser_t parser;   // данные GPS, незавершенная строка и текущая эпоха
+} nmea_mux_device_t;
+
+typedef struct {
+    nmea_mux_device_t* devices; // арена: capacity состояний в порядке появления устройств
+    int32_t* table;             // индекс в арене или -1; размер - степень двойки
+    size_t table_mask;
+    size_t capacity;
+    size_t count;
+} nmea_mux_t;
+
+// Размер таблицы поиска для capacity устройств (заполнение не выше 1/2)
+size_t nmea_mux_table_size(size_t capacity);
+
+// Память арены (capacity) и таблицы (nmea_mux_table_size) выделяет вызывающий
+void nmea_mux_init(nmea_mux_t* mux, nmea_mux_device_t* devices, int32_t* table, size_t capacity);
+
+// Состояние устройства; create - добавить новое. NULL - нет такого или арена заполнена
+nmea_mux_device_t* nmea_mux_find(nmea_mux_t* mux, uint32_t device_id, int create);
+
+// Подача данных устройства. Завершенные эпохи дописываются в out, их устройство - в device_ids
+// (по индексу строки); в out должно быть место на NMEA_MUX_MAX_ROWS(len) строк.
+// Возвращает число новых строк или -1, если арена заполнена
+int nmea_mux_feed(nmea_mux_t* mux, uint32_t device_id, const char* data, size_t len,
+                  nmea_columns_t* out, uint32_t* device_ids);
+
+// Закрытие последней эпохи устройства (отключение) и сброс его состояния; число строк (0 или 1)
+size_t nmea_mux_flush(nmea_mux_device_t* device, nmea_columns_t* out, uint32_t* device_ids);
+
+#endif
@@ -0,0 +1,246 @@
+#include "ublox_nmea_pack.h"
+#include <string.h>
+
+#define NMEA_PACK_COUNT_BITS 4
+
+void nmea_pack_layout_default(nmea_pack_layout_t* layout) {
+    layout->lat_bits = 24;
+    layout->lon_bits = 24;
+    layout->alt_bits = 12;
+    layout->speed_bits = 7;
+    layout->hdop_bits = 4;
+    layout->fix_bits = 3;
+    layout->time_bits = 0;
+    layout->delta_bits = 12;
+    layout->time_delta_bits = 8;
+    layout->alt_min = -500.0;
+    layout->alt_max = 8000.0;
+    layout->speed_max = 63.0;
+    layout->hdop_max = 7.0;
+}
+
+int nmea_pack_layout_check(const nmea_pack_layout_t* layout) {
+    if (layout->lat_bits < 8 || layout->lat_bits > 32 || layout->lon_bits < 8 || layout->lon_bits > 32) return 0;
+    if (layout->alt_bits > 16 || layout->speed_bits > 16 || layout->hdop_bits > 16) return 0;
+    if (layout->fix_bits > 4 || layout->time_bits > 17) return 0;
+    if (layout->delta_bits < 2 || layout->delta_bits > layout->lat_bits || layout->delta_bits > layout->lon_bits) {
+        return 0;
+    }
+    if (layout->time_bits && (layout->time_delta_bits < 1 || layout->time_delta_bits > 16)) return 0;
+    // Диапазоны (в том числе NAN) проверяются только у передаваемых полей
+    if (layout->alt_bits && !(layout->alt_max > layout->alt_min)) return 0;
+    if (layout->speed_bits && !(layout->speed_max > 0.0)) return 0;
+    if (layout->hdop_bits && !(layout->hdop_max > 0.0)) return 0;
+    return 1;
+}
+
+// Поля, общие для первой точки и приращений
+static size_t common_bits(const nmea_pack_layout_t* layout) {
+    return layout->alt_bits + layout->speed_bits + layout->hdop_bits + layout->fix_bits;
+}
+
+size_t nmea_pack_point_bits(const nmea_pack_layout_t* layout) {
+    return layout->lat_bits + layout->lon_bits + layout->time_bits + common_bits(layout);
+}
+
+size_t nmea_pack_delta_bits(const nmea_pack_layout_t* layout) {
+    return 2 * layout->delta_bits + (layout->time_bits ? layout->time_delta_bits : 0) + common_bits(layout);
+}
+
+// Наибольший код поля (зарезервирован под NAN)
+static uint32_t top_code(int bits) {
+    return (uint32_t)((1ULL << bits) - 1);
+}
+
+// Линейное квантование [min, max] в коды 0..top-1 с насыщением
+static uint32_t quantize(double value, double min, double max, int bits) {
+    if (bits == 0) return 0;
+    uint32_t top = top_code(bits);
+    if (isnan(value)) return top;
+    if (value <= min) return 0;
+    if (value >= max) return top - 1;
+    return (uint32_t)((value - min) / (max - min) * (top - 1) + 0.5);
+}
+
+// Период поля времени: сутки при 17 битах, иначе 2^time_bits
+static uint32_t time_modulus(int bits) {
+    return bits >= 17 ? 86400 : (uint32_t)1 << bits;
+}
+
+static double dequantize(uint32_t code, double min, double max, int bits) {
+    if (bits == 0) return NAN;
+    uint32_t top = top_code(bits);
+    if (code == top) return NAN;
+    return min + code * (max - min) / (top - 1);
+}
+
+void nmea_pack_quantize(const nmea_pack_layout_t* layout, const gps_data_t* gps_data, nmea_pack_codes_t* codes) {
+    codes->lat = quantize(gps_data->latitude, -90.0, 90.0, layout->lat_bits);
+    codes->lon = quantize(gps_data->longitude, -180.0, 180.0, layout->lon_bits);
+    codes->alt = quantize(gps_data->altitude, layout->alt_min, layout->alt_max, layout->alt_bits);
+    codes->speed = quantize(gps_data->speed, 0.0, layout->speed_max, layout->speed_bits);
+    codes->hdop = quantize(gps_data->hdop, 0.0, layout->hdop_max, layout->hdop_bits);
+
+    // Тип фикса: 0 без фикса, иначе не меньше 1 (с насыщением)
+    codes->fix = 0;
+    if (layout->fix_bits && gps_data->valid) {
+        uint32_t fix = gps_data->fix_type ? gps_data->fix_type : 1;
+        codes->fix = fix > top_code(layout->fix_bits) ? top_code(layout->fix_bits) : fix;
+    }
+
+    codes->time = 0;
+    if (layout->time_bits) {
+        uint32_t seconds = (uint32_t)gps_data->hour * 3600 + gps_data->minute * 60 + gps_data->second;
+        codes->time = seconds % time_modulus(layout->time_bits);
+    }
+}
+
+// Запись value (младшие bits бит) от старшего бита; буфер заранее обнулен
+static void put_bits(uint8_t* data, size_t* pos, uint32_t value, int bits) {
+    while (bits--) {
+        if ((value >> bits) & 1) {
+            data[*pos >> 3] |= (uint8_t)(0x80 >> (*pos & 7));
+        }
+        (*pos)++;
+    }
+}
+
+static uint32_t get_bits(const uint8_t* data, size_t* pos, int bits) {
+    uint32_t value = 0;
+    while (bits--) {
+        value = (value << 1) | ((data[*pos >> 3] >> (7 - (*pos & 7))) & 1);
+        (*pos)++;
+    }
+    return value;
+}
+
+static void put_common(const nmea_pack_layout_t* layout, uint8_t* data, size_t* pos, const nmea_pack_codes_t* codes) {
+    put_bits(data, pos, codes->alt, layout->alt_bits);
+    put_bits(data, pos, codes->speed, layout->speed_bits);
+    put_bits(data, pos, codes->hdop, layout->hdop_bits);
+    put_bits(data, pos, codes->fix, layout->fix_bits);
+}
+
+static void get_common(const nmea_pack_layout_t* layout, const uint8_t* data, size_t* pos, nmea_pack_codes_t* codes) {
+    codes->alt = get_bits(data, pos, layout->alt_bits);
+    codes->speed = get_bits(data, pos, layout->speed_bits);
+    codes->hdop = get_bits(data, pos, layout->hdop_bits);
+    codes->fix = get_bits(data, pos, layout->fix_bits);
+}
+
+// Приращение кода в дополнительном коде на bits бит; 0, если не помещается
+static int delta_fits(uint32_t from, uint32_t to, int bits, uint32_t* delta) {
+    int64_t diff = (int64_t)to - (int64_t)from;
+    int64_t limit = (int64_t)1 << (bits - 1);
+    if (diff < -limit || diff >= limit) return 0;
+    *delta = (uint32_t)diff & top_code(bits);
+    return 1;
+}
+
+int nmea_pack_frame_init(nmea_pack_frame_t* frame, const nmea_pack_layout_t* layout, size_t budget) {
+    if (!nmea_pack_layout_check(layout) || budget == 0 || budget > NMEA_PACK_MAX_FRAME) return 0;
+    frame->layout = *layout;
+    frame->budget = budget;
+    nmea_pack_frame_reset(frame);
+    return 1;
+}
+
+void nmea_pack_frame_reset(nmea_pack_frame_t* frame) {
+    memset(frame->data, 0, sizeof(frame->data));
+    frame->count = 0;
+    frame->bits = NMEA_PACK_COUNT_BITS;
+}
+
+int nmea_pack_frame_add(nmea_pack_frame_t* frame, const gps_data_t* gps_data) {
+    const nmea_pack_layout_t* layout = &frame->layout;
+    nmea_pack_codes_t codes;
+    nmea_pack_quantize(layout, gps_data, &codes);
+
+    if (frame->count == 0) {
+        if ((frame->bits + nmea_pack_point_bits(layout) + 7) / 8 > frame->budget) return 0;
+        put_bits(frame->data, &frame->bits, codes.lat, layout->lat_bits);
+        put_bits(frame->data, &frame->bits, codes.lon, layout->lon_bits);
+        put_bits(frame->data, &frame->bits, codes.time, layout->time_bits);
+    } else {
+        if (frame->count >= NMEA_PACK_MAX_POINTS) return 0;
+        if ((frame->bits + nmea_pack_delta_bits(layout) + 7) / 8 > frame->budget) return 0;
+
+        uint32_t dlat, dlon, dtime = 0;
+        if (!delta_fits(frame->last.lat, codes.lat, layout->delta_bits, &dlat) ||
+            !delta_fits(frame->last.lon, codes.lon, layout->delta_bits, &dlon)) {
+            return 0;
+        }
+        if (layout->time_bits) {
+            // Время идет вперед по модулю периода поля (переход через полночь)
+            uint32_t modulus = time_modulus(layout->time_bits);
+            dtime = (codes.time + modulus - frame->last.time) % modulus;
+            if (dtime > top_code(layout->time_delta_bits)) return 0;
+        }
+        put_bits(frame->data, &frame->bits, dlat, layout->delta_bits);
+        put_bits(frame->data, &frame->bits, dlon, layout->delta_bits);
+        if (layout->time_bits) {
+            put_bits(frame->data, &frame->bits, dtime, layout->time_delta_bits);
+        }
+    }
+    put_common(layout, frame->data, &frame->bits, &codes);
+
+    frame->last = codes;
+    frame->count++;
+    // Заголовок - старшие 4 бита первого байта
+    frame->data[0] = (uint8_t)((frame->data[0] & 0x0F) | ((frame->count - 1) << 4));
+    return 1;
+}
+
+size_t nmea_pack_frame_size(const nmea_pack_frame_t* frame) {
+    return frame->count ? (frame->bits + 7) / 8 : 0;
+}
+
+// Расширение знака приращения
+static int64_t sign_extend(uint32_t value, int bits) {
+    int64_t limit = (int64_t)1 << (bits - 1);
+    return (value & limit) ? (int64_t)value - ((int64_t)1 << bits) : (int64_t)value;
+}
+
+static void codes_to_fix(const nmea_pack_layout_t* layout, const nmea_pack_codes_t* codes, nmea_pack_fix_t* fix) {
+    fix->latitude = dequantize(codes->lat, -90.0, 90.0, layout->lat_bits);
+    fix->longitude = dequantize(codes->lon, -180.0, 180.0, layout->lon_bits);
+    fix->altitude = dequantize(codes->alt, layout->alt_min, layout->alt_max, layout->alt_bits);
+    fix->speed = dequantize(codes->speed, 0.0, layout->speed_max, layout->speed_bits);
+    fix->hdop = dequantize(codes->hdop, 0.0, layout->hdop_max, layout->hdop_bits);
+    fix->fix_type = layout->fix_bits ? (int)codes->fix : -1;
+    fix->time_of_day = layout->time_bits ? (int32_t)codes->time : -1;
+    if (layout->fix_bits) {
+        fix->valid = codes->fix > 0;
+    } else {
+        fix->valid = !isnan(fix->latitude) && !isnan(fix->longitude);
+    }
+}
+
+int nmea_pack_decode(const nmea_pack_layout_t* layout, const uint8_t* data, size_t len, nmea_pack_fix_t* out) {
+    if (!nmea_pack_layout_check(layout) || len == 0) return -1;
+    int count = (data[0] >> 4) + 1;
+    size_t bits = NMEA_PACK_COUNT_BITS + nmea_pack_point_bits(layout) + (count - 1) * nmea_pack_delta_bits(layout);
+    if ((bits + 7) / 8 != len) return -1;
+
+    size_t pos = NMEA_PACK_COUNT_BITS;
+    nmea_pack_codes_t codes;
+    for (int i = 0; i < count; i++) {
+        if (i == 0) {
+            codes.lat = get_bits(data, &pos, layout->lat_bits);
+            codes.lon = get_bits(data, &pos, layout->lon_bits);
+            codes.time = get_bits(data, &pos, layout->time_bits);
+        } else {
+            codes.lat = (uint32_t)((int64_t)codes.lat + sign_extend(get_bits(data, &pos, layout->delta_bits),
+                                                                    layout->delta_bits));
+            codes.lon = (uint32_t)((int64_t)codes.lon + sign_extend(get_bits(data, &pos, layout->delta_bits),
+                                                                    layout->delta_bits));
+            if (layout->time_bits) {
+                codes.time = (codes.time + get_bits(data, &pos, layout->time_delta_bits)) %
+                             time_modulus(layout->time_bits);
+            }
+        }
+        get_common(layout, data, &pos, &codes);
+        codes_to_fix(layout, &codes, &out[i]);
+    }
+    return count;
+}
@@ -0,0 +1,97 @@
+#ifndef UBLOX_NMEA_PACK_H
+#define UBLOX_NMEA_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_core.h"
+
+// Битовая упаковка фиксов для LPWAN (LoRaWAN / NB-IoT): 11-51 байт полезной нагрузки.
+// Кадр: 4 бита (число точек - 1), первая точка целиком, остальные - приращения широты,
+// долготы и времени к предыдущей (прочие поля целиком). Биты идут от старшего к младшему,
+// хвост последнего байта - нули. Раскладка в кадре не передается: она общая у трекера и сервера
+
+#define NMEA_PACK_MAX_POINTS 16
+#define NMEA_PACK_MAX_FRAME 242     // наибольшая полезная нагрузка LoRaWAN
+
+// Раскладка: число бит каждого поля (0 - поле не передается) и диапазоны квантования.
+// Все значения кода "единицы" зарезервированы под отсутствующее значение (NAN)
+typedef struct {
+    uint8_t lat_bits;           // 8..32, диапазон -90..90
+    uint8_t lon_bits;           // 8..32, диапазон -180..180
+    uint8_t alt_bits;           // 0..16, диапазон alt_min..alt_max, м
+    uint8_t speed_bits;         // 0..16, диапазон 0..speed_max, м/с
+    uint8_t hdop_bits;          // 0..16, диапазон 0..hdop_max
+    uint8_t fix_bits;           // 0..4, тип фикса GGA (0 - нет фикса)
+    uint8_t time_bits;          // 0..17, секунды от начала суток UTC (меньше 17 - по модулю 2^time_bits)
+    uint8_t delta_bits;         // 2..lat_bits, приращения широты и долготы в шагах квантования
+    uint8_t time_delta_bits;    // 1..16, приращение времени, с (при time_bits > 0)
+    double alt_min;
+    double alt_max;
+    double speed_max;
+    double hdop_max;
+} nmea_pack_layout_t;
+
+// Коды квантования одной точки
+typedef struct {
+    uint32_t lat;
+    uint32_t lon;
+    uint32_t alt;
+    uint32_t speed;
+    uint32_t hdop;
+    uint32_t fix;
+    uint32_t time;
+} nmea_pack_codes_t;
+
+// Точка после распаковки (NAN - поле не передается или значение отсутствовало)
+typedef struct {
+    double latitude;
+    double longitude;
+    double altitude;
+    double speed;
+    double hdop;
+    int fix_type;               // -1 - не передается
+    int32_t time_of_day;        // с; -1 - не передается
+    uint8_t valid;
+} nmea_pack_fix_t;
+
+typedef struct {
+    nmea_pack_layout_t layout;
+    size_t budget;              // байт на кадр
+    uint8_t count;
+    nmea_pack_codes_t last;     // последняя точка (база приращения)
+    size_t bits;
+    uint8_t data[NMEA_PACK_MAX_FRAME];
+} nmea_pack_frame_t;
+
+// 24/24 бита координат, 12 бит высоты (-500..8000 м), 7 бит скорости (0..63 м/с),
+// 4 бита HDOP (0..7), 3 бита типа фикса, без времени, приращения по 12 бит: 10 байт на кадр
+// из одной точки, +50 бит на каждую следующую
+void nmea_pack_layout_default(nmea_pack_layout_t* layout);
+
+// 1, если раскладка допустима
+int nmea_pack_layout_check(const nmea_pack_layout_t* layout);
+
+// Бит на первую точку кадра (без заголовка) и на каждую следующую
+size_t nmea_pack_point_bits(const nmea_pack_layout_t* layout);
+size_t nmea_pack_delta_bits(const nmea_pack_layout_t* layout);
+
+void nmea_pack_quantize(const nmea_pack_layout_t* layout, const gps_data_t* gps_data, nmea_pack_codes_t* codes);
+
+// budget - 1..NMEA_PACK_MAX_FRAME байт; 0 при недопустимой раскладке или бюджете
+int nmea_pack_frame_init(nmea_pack_frame_t* frame, const nmea_pack_layout_t* layout, size_t budget);
+
+// Добавление фикса; 0, если он не помещается в кадр (бюджет, число точек, приращение
+// вне диапазона) - тогда кадр отправляют и начинают новый
+int nmea_pack_frame_add(nmea_pack_frame_t* frame, const gps_data_t* gps_data);
+
+// Длина кадра в байтах (0 - пустой)
+size_t nmea_pack_frame_size(const nmea_pack_frame_t* frame);
+
+// Новый пустой кадр с той же раскладкой
+void nmea_pack_frame_reset(nmea_pack_frame_t* frame);
+
+// Распаковка кадра в out (до NMEA_PACK_MAX_POINTS точек); возвращает число точек или -1,
+// если длина не соответствует раскладке
+int nmea_pack_decode(const nmea_pack_layout_t* layout, const uint8_t* data, size_t len, nmea_pack_fix_t* out);
+
+#endif
@@ -0,0 +1,153 @@
+#include "ublox_nmea_rf.h"
+#include <string.h>
+
+// Вес эпохи в скользящем среднем C/N0
+#define RF_ROLLING_WEIGHT 0.125f
+
+void nmea_rf_init(nmea_rf_t* rf) {
+    memset(rf, 0, sizeof(*rf));
+    rf->jam_ind_max = NMEA_RF_JAM_IND;
+    rf->min_signals = NMEA_RF_MIN_SIGNALS;
+    rf->cno_min = NMEA_RF_CNO_MIN;
+    rf->cno_drop = NMEA_RF_CNO_DROP;
+}
+
+void nmea_rf_reset(nmea_rf_t* rf) {
+    nmea_rf_t kept = *rf;
+    nmea_rf_init(rf);
+    rf->jam_ind_max = kept.jam_ind_max;
+    rf->min_signals = kept.min_signals;
+    rf->cno_min = kept.cno_min;
+    rf->cno_drop = kept.cno_drop;
+    rf->callback = kept.callback;
+    rf->context = kept.context;
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Пересчет общего набора тревог и вызов при его смене
+static void rf_update_alerts(nmea_rf_t* rf) {
+    uint32_t alerts = rf->hw_alerts | rf->cno_alerts;
+    uint32_t changed = alerts ^ rf->alerts;
+    rf->alerts = alerts;
+    if (changed && rf->callback) rf->callback(alerts, changed, rf->context);
+}
+
+static void rf_hw_alerts(nmea_rf_t* rf) {
+    rf->hw_alerts = 0;
+    if (rf->jamming_state >= NMEA_RF_JAMMING_WARNING || (rf->jam_ind_max && rf->jam_ind >= rf->jam_ind_max)) {
+        rf->hw_alerts |= NMEA_RF_ALERT_JAMMING;
+    }
+    if (rf->antenna_status == NMEA_RF_ANTENNA_SHORT || rf->antenna_status == NMEA_RF_ANTENNA_OPEN) {
+        rf->hw_alerts |= NMEA_RF_ALERT_ANTENNA;
+    }
+    rf->hw_messages++;
+    rf_update_alerts(rf);
+}
+
+// MON-RF: версия 0, число блоков, 2 резерв; блоки по 24 байта: blockId, flags (биты 0-1 -
+// jammingState), antStatus, antPower, POSTStatus, 4 резерв, noisePerMS, agcCnt, jamInd, ofs/mag I/Q
+int nmea_rf_mon_rf(nmea_rf_t* rf, const uint8_t* payload, size_t len) {
+    if (len < 4 || payload[0] != 0) return -1;
+    size_t blocks = payload[1];
+    if (blocks == 0 || len != 4 + blocks * 24) return -1;
+
+    // Худшее по блокам (полосы L1/L2 и т.п.); шум и AGC - первого блока
+    const uint8_t* block = payload + 4;
+    rf->noise_per_ms = get_u16(block + 12);
+    rf->agc_cnt = get_u16(block + 14);
+    rf->jamming_state = 0;
+    rf->jam_ind = 0;
+    rf->antenna_status = block[2];
+    rf->antenna_power = block[3];
+    for (size_t i = 0; i < blocks; i++, block += 24) {
+        uint8_t state = block[1] & 0x03;
+        if (state > rf->jamming_state) rf->jamming_state = state;
+        if (block[16] > rf->jam_ind) rf->jam_ind = block[16];
+        if (block[2] == NMEA_RF_ANTENNA_SHORT || block[2] == NMEA_RF_ANTENNA_OPEN) {
+            rf->antenna_status = block[2];
+        }
+    }
+    rf_hw_alerts(rf);
+    return 0;
+}
+
+// MON-HW (60 байт): noisePerMS @16, agcCnt @18, aStatus @20, aPower @21, flags @22 (биты 2-3 -
+// jammingState), jamInd @45
+int nmea_rf_mon_hw(nmea_rf_t* rf, const uint8_t* payload, size_t len) {
+    if (len != 60) return -1;
+    rf->noise_per_ms = get_u16(payload + 16);
+    rf->agc_cnt = get_u16(payload + 18);
+    rf->antenna_status = payload[20];
+    rf->antenna_power = payload[21];
+    rf->jamming_state = (payload[22] >> 2) & 0x03;
+    rf->jam_ind = payload[45];
+    rf_hw_alerts(rf);
+    return 0;
+}
+
+// Система по talker, для "GN" - по номеру спутника (NMEA 4.0: 1-32 GPS, 65-96 ГЛОНАСС)
+static int rf_system(const char* talker, uint16_t prn) {
+    if (talker[0] == 'G' && talker[1] == 'P') return (prn <= 32) ? NMEA_RF_GPS : NMEA_RF_OTHER;
+    if (talker[0] == 'G' && talker[1] == 'L') return NMEA_RF_GLONASS;
+    if (talker[0] == 'G' && talker[1] == 'A') return NMEA_RF_GALILEO;
+    if ((talker[0] == 'G' && talker[1] == 'B') || (talker[0] == 'B' && talker[1] == 'D')) return NMEA_RF_BEIDOU;
+    if (prn >= 1 && prn <= 32) return NMEA_RF_GPS;
+    if (prn >= 65 && prn <= 96) return NMEA_RF_GLONASS;
+    return NMEA_RF_OTHER;
+}
+
+void nmea_rf_gsv(nmea_rf_t* rf, const nmea_gsv_signals_t* signals) {
+    for (uint8_t i = 0; i < signals->count; i++) {
+        int system = rf_system(signals->talker, signals->prn[i]);
+        rf->acc_visible[system]++;
+        uint8_t snr = signals->snr[i];
+        if (snr == NMEA_GSV_NO_SNR) continue;
+        nmea_rf_cno_t* acc = &rf->acc[system];
+        if (acc->count == 0 || snr < acc->min) acc->min = snr;
+        if (snr > acc->max) acc->max = snr;
+        acc->count++;
+        rf->acc_sum[system] += snr;
+        acc->hist[(snr / 5 < NMEA_RF_HIST_BINS) ? snr / 5 : NMEA_RF_HIST_BINS - 1]++;
+    }
+}
+
+void nmea_rf_epoch(nmea_rf_t* rf) {
+    uint32_t alerts = 0;
+    for (int system = 0; system < NMEA_RF_SYSTEMS; system++) {
+        nmea_rf_cno_t* acc = &rf->acc[system];
+        nmea_rf_cno_t* cno = &rf->cno[system];
+        float rolling = cno->rolling_mean;
+        *cno = *acc;
+        cno->rolling_mean = rolling;
+        if (acc->count > 0) {
+            cno->mean = (float)rf->acc_sum[system] / acc->count;
+            int dropped = 0;
+            if (acc->count >= rf->min_signals) {
+                if (cno->mean < rf->cno_min) alerts |= NMEA_RF_ALERT_CNO_LOW;
+                // Падение относительно среднего до этой эпохи (помеха поднимает шум всем спутникам)
+                dropped = rolling > 0.0f && cno->mean < rolling - rf->cno_drop;
+                if (dropped) alerts |= NMEA_RF_ALERT_CNO_DROP;
+            }
+            // Во время падения опорное среднее не сдвигается, иначе тревога сама снимется за десяток эпох
+            if (rolling == 0.0f) {
+                cno->rolling_mean = cno->mean;
+            } else if (!dropped) {
+                cno->rolling_mean = rolling + (cno->mean - rolling) * RF_ROLLING_WEIGHT;
+            }
+        }
+        // Спутники видны, но почти ни один не дает SNR (сильная помеха): не "отбой", а низкий
+        // C/N0, падение остается поднятым
+        if (acc->count < rf->min_signals && rf->acc_visible[system] >= rf->min_signals) {
+            alerts |= NMEA_RF_ALERT_CNO_LOW | (rf->cno_alerts & NMEA_RF_ALERT_CNO_DROP);
+        }
+        memset(acc, 0, sizeof(*acc));
+        rf->acc_sum[system] = 0;
+        rf->acc_visible[system] = 0;
+    }
+    rf->epochs++;
+    rf->cno_alerts = alerts;
+    rf_update_alerts(rf);
+}
@@ -0,0 +1,103 @@
+#ifndef UBLOX_NMEA_RF_H
+#define UBLOX_NMEA_RF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_core.h"
+
+// Контроль радиотракта: индикатор помех, AGC, шум и антенна из UBX-MON-RF/MON-HW, статистика
+// C/N0 по системам из спутников GSV за эпоху; тревоги по порогам - вызовом при смене набора
+
+#define UBX_CLASS_MON 0x0A
+#define UBX_MON_HW 0x09
+#define UBX_MON_RF 0x38
+
+// Системы статистики C/N0
+enum {
+    NMEA_RF_GPS,
+    NMEA_RF_GLONASS,
+    NMEA_RF_GALILEO,
+    NMEA_RF_BEIDOU,
+    NMEA_RF_OTHER,
+    NMEA_RF_SYSTEMS,
+};
+
+// Гистограмма C/N0 по 5 дБГц: 0-4, 5-9, ..., 50-54, 55 и выше
+#define NMEA_RF_HIST_BINS 12
+
+// Состояние помех (jammingState) и антенны (antStatus) в кодировке u-blox
+#define NMEA_RF_JAMMING_WARNING 2
+#define NMEA_RF_JAMMING_CRITICAL 3
+#define NMEA_RF_ANTENNA_SHORT 3
+#define NMEA_RF_ANTENNA_OPEN 4
+
+// Пороги по умолчанию
+#define NMEA_RF_JAM_IND 128
+#define NMEA_RF_MIN_SIGNALS 4
+#define NMEA_RF_CNO_MIN 25.0f
+#define NMEA_RF_CNO_DROP 6.0f
+
+// Тревоги (биты)
+#define NMEA_RF_ALERT_JAMMING 0x01      // jammingState >= предупреждения или jamInd >= порога
+#define NMEA_RF_ALERT_ANTENNA 0x02      // короткое замыкание или обрыв антенны
+#define NMEA_RF_ALERT_CNO_LOW 0x04      // средний C/N0 эпохи ниже порога или спутники видны, но не отслеживаются
+#define NMEA_RF_ALERT_CNO_DROP 0x08     // средний C/N0 эпохи ниже скользящего среднего на порог
+
+// Статистика C/N0 системы: последняя завершенная эпоха и скользящее среднее по эпохам
+typedef struct {
+    uint16_t count;                         // сигналов с C/N0
+    uint8_t min;
+    uint8_t max;
+    float mean;
+    float rolling_mean;                     // экспоненциальное среднее по эпохам (0 - еще нет)
+    uint16_t hist[NMEA_RF_HIST_BINS];
+} nmea_rf_cno_t;
+
+typedef void (*nmea_rf_alert_t)(uint32_t alerts, uint32_t changed, void* context);
+
+typedef struct {
+    // MON-RF / MON-HW (худший блок MON-RF)
+    uint8_t jamming_state;
+    uint8_t jam_ind;                        // 0 - нет помех CW, 255 - сильные
+    uint8_t antenna_status;                 // 0 INIT, 1 неизвестно, 2 OK, 3 замыкание, 4 обрыв
+    uint8_t antenna_power;                  // 0 выкл, 1 вкл, 2 неизвестно
+    uint16_t noise_per_ms;
+    uint16_t agc_cnt;                       // 0..8191
+    uint32_t hw_messages;
+
+    nmea_rf_cno_t cno[NMEA_RF_SYSTEMS];
+    nmea_rf_cno_t acc[NMEA_RF_SYSTEMS];     // накопление текущей эпохи
+    uint32_t acc_sum[NMEA_RF_SYSTEMS];
+    uint16_t acc_visible[NMEA_RF_SYSTEMS];  // спутников в GSV, в том числе без SNR
+    uint32_t epochs;
+
+    // Пороги
+    uint8_t jam_ind_max;                    // 0 - тревога только по jammingState
+    uint8_t min_signals;                    // тревоги C/N0 - при стольких сигналах системы и больше
+    float cno_min;
+    float cno_drop;
+
+    uint32_t hw_alerts;
+    uint32_t cno_alerts;
+    uint32_t alerts;
+    nmea_rf_alert_t callback;
+    void* context;
+} nmea_rf_t;
+
+// Пороги по умолчанию, без обработчика тревог
+void nmea_rf_init(nmea_rf_t* rf);
+
+// Сброс измерений и тревог (пороги и обработчик сохраняются, обработчик не вызывается)
+void nmea_rf_reset(nmea_rf_t* rf);
+
+// Полезная нагрузка MON-RF / MON-HW; 0 или -1 (неверная длина/версия)
+int nmea_rf_mon_rf(nmea_rf_t* rf, const uint8_t* payload, size_t len);
+int nmea_rf_mon_hw(nmea_rf_t* rf, const uint8_t* payload, size_t len);
+
+// Спутники GSV в накопление текущей эпохи
+void nmea_rf_gsv(nmea_rf_t* rf, const nmea_gsv_signals_t* signals);
+
+// Завершение эпохи: статистика, тревоги C/N0
+void nmea_rf_epoch(nmea_rf_t* rf);
+
+#endif
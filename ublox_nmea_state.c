@@ -0,0 +1,102 @@
+#include "ublox_nmea_state.h"
+
+// Признаки has_* и valid в одном байте
+#define FIX_VALID               0x01
+#define FIX_HAS_GGA             0x02
+#define FIX_HAS_GSA             0x04
+#define FIX_HAS_GSV             0x08
+#define FIX_HAS_VTG             0x10
+#define FIX_HAS_SATELLITES_USED 0x20
+#define FIX_HAS_SATELLITES_VIS  0x40
+#define FIX_HAS_ACCURACY        0x80
+
+// CRC-16/CCITT-FALSE (полином 0x1021, начальное 0xFFFF)
+static uint16_t state_crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t nmea_state_begin(uint8_t* out, uint8_t flags, const gps_data_t* gps_data) {
+    uint8_t* p = out;
+    *p++ = 'N';
+    *p++ = 'S';
+    *p++ = NMEA_STATE_VERSION;
+    *p++ = flags;
+
+    const double values[] = {
+        gps_data->latitude, gps_data->longitude, gps_data->altitude, gps_data->geoid_separation,
+        gps_data->speed, gps_data->course, gps_data->hdop, gps_data->vdop, gps_data->pdop, gps_data->accuracy,
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        p = nmea_state_put_f64(p, values[i]);
+    }
+    p = nmea_state_put_u16(p, gps_data->year);
+    p = nmea_state_put_u16(p, gps_data->millisecond);
+    *p++ = gps_data->satellites_used;
+    *p++ = gps_data->satellites_visible;
+    *p++ = gps_data->fix_type;
+    *p++ = gps_data->month;
+    *p++ = gps_data->day;
+    *p++ = gps_data->hour;
+    *p++ = gps_data->minute;
+    *p++ = gps_data->second;
+    *p++ = (gps_data->valid ? FIX_VALID : 0) | (gps_data->has_gga ? FIX_HAS_GGA : 0) |
+           (gps_data->has_gsa ? FIX_HAS_GSA : 0) | (gps_data->has_gsv ? FIX_HAS_GSV : 0) |
+           (gps_data->has_vtg ? FIX_HAS_VTG : 0) | (gps_data->has_satellites_used ? FIX_HAS_SATELLITES_USED : 0) |
+           (gps_data->has_satellites_visible ? FIX_HAS_SATELLITES_VIS : 0) |
+           (gps_data->has_accuracy ? FIX_HAS_ACCURACY : 0);
+    return (size_t)(p - out);
+}
+
+size_t nmea_state_finish(uint8_t* out, size_t len) {
+    nmea_state_put_u16(out + len, state_crc16(out, len));
+    return len + NMEA_STATE_CRC_SIZE;
+}
+
+int nmea_state_open(const uint8_t* in, size_t len, uint8_t* flags, gps_data_t* gps_data) {
+    if (len < NMEA_STATE_MIN_SIZE || in[0] != 'N' || in[1] != 'S') return NMEA_STATE_ERROR_INVALID;
+    if (in[2] != NMEA_STATE_VERSION) return NMEA_STATE_ERROR_VERSION;
+    if (state_crc16(in, len - NMEA_STATE_CRC_SIZE) != nmea_state_get_u16(in + len - NMEA_STATE_CRC_SIZE)) {
+        return NMEA_STATE_ERROR_INVALID;
+    }
+    *flags = in[3];
+
+    const uint8_t* p = in + NMEA_STATE_HEADER_SIZE;
+    gps_data_init(gps_data);
+    double* values[] = {
+        &gps_data->latitude, &gps_data->longitude, &gps_data->altitude, &gps_data->geoid_separation,
+        &gps_data->speed, &gps_data->course, &gps_data->hdop, &gps_data->vdop, &gps_data->pdop, &gps_data->accuracy,
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        *values[i] = nmea_state_get_f64(p);
+        p += 8;
+    }
+    gps_data->year = nmea_state_get_u16(p);
+    gps_data->millisecond = nmea_state_get_u16(p + 2);
+    p += 4;
+    gps_data->satellites_used = *p++;
+    gps_data->satellites_visible = *p++;
+    gps_data->fix_type = *p++;
+    gps_data->month = *p++;
+    gps_data->day = *p++;
+    gps_data->hour = *p++;
+    gps_data->minute = *p++;
+    gps_data->second = *p++;
+    uint8_t bits = *p++;
+    gps_data->valid = (bits & FIX_VALID) != 0;
+    gps_data->has_gga = (bits & FIX_HAS_GGA) != 0;
+    gps_data->has_gsa = (bits & FIX_HAS_GSA) != 0;
+    gps_data->has_gsv = (bits & FIX_HAS_GSV) != 0;
+    gps_data->has_vtg = (bits & FIX_HAS_VTG) != 0;
+    gps_data->has_satellites_used = (bits & FIX_HAS_SATELLITES_USED) != 0;
+    gps_data->has_satellites_visible = (bits & FIX_HAS_SATELLITES_VIS) != 0;
+    gps_data->has_accuracy = (bits & FIX_HAS_ACCURACY) != 0;
+    gps_data_update_timestamp(gps_data);
+    return (int)(p - in);
+}
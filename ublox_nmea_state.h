@@ -0,0 +1,80 @@
+#ifndef UBLOX_NMEA_STATE_H
+#define UBLOX_NMEA_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "ublox_nmea_core.h"
+
+// Снимок состояния парсера для RTC-памяти или flash между циклами глубокого сна.
+// Формат (little-endian): "NS", версия, флаги секций; фикс (NMEA_STATE_FIX_SIZE байт, без потерь);
+// необязательные секции по флагам; CRC-16/CCITT всего предшествующего
+
+#define NMEA_STATE_VERSION 1
+
+#define NMEA_STATE_HEADER_SIZE 4
+#define NMEA_STATE_FIX_SIZE 93
+#define NMEA_STATE_CRC_SIZE 2
+#define NMEA_STATE_MIN_SIZE (NMEA_STATE_HEADER_SIZE + NMEA_STATE_FIX_SIZE + NMEA_STATE_CRC_SIZE)
+
+// Флаги необязательных секций (в порядке следования)
+#define NMEA_STATE_ENU 0x01         // начало ENU: широта, долгота, высота (3 x f64)
+#define NMEA_STATE_HISTORY 0x02     // история: u16 число записей, записи (i64 UTC мс, f64, f64)
+#define NMEA_STATE_ENU_SIZE 24
+#define NMEA_STATE_HISTORY_ENTRY_SIZE 24
+
+// Ошибки nmea_state_open
+#define NMEA_STATE_ERROR_INVALID -1     // не снимок, обрезан или испорчен
+#define NMEA_STATE_ERROR_VERSION -2     // другая версия формата
+
+static inline uint8_t* nmea_state_put_u16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static inline uint8_t* nmea_state_put_u64(uint8_t* p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+    return p + 8;
+}
+
+static inline uint8_t* nmea_state_put_f64(uint8_t* p, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return nmea_state_put_u64(p, bits);
+}
+
+static inline uint16_t nmea_state_get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint64_t nmea_state_get_u64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static inline double nmea_state_get_f64(const uint8_t* p) {
+    uint64_t bits = nmea_state_get_u64(p);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Заголовок и фикс в out (не меньше NMEA_STATE_HEADER_SIZE + NMEA_STATE_FIX_SIZE); возвращает длину.
+// Секции по flags дописывает вызывающий, затем nmea_state_finish
+size_t nmea_state_begin(uint8_t* out, uint8_t flags, const gps_data_t* gps_data);
+
+// Контрольная сумма после len байт; возвращает полную длину снимка
+size_t nmea_state_finish(uint8_t* out, size_t len);
+
+// Проверка снимка и чтение фикса (timestamp восстанавливается из даты и времени);
+// возвращает смещение первой необязательной секции или NMEA_STATE_ERROR_*.
+// Секции заканчиваются за NMEA_STATE_CRC_SIZE байт до конца
+int nmea_state_open(const uint8_t* in, size_t len, uint8_t* flags, gps_data_t* gps_data);
+
+#endif
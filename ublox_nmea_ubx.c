@@ -0,0 +1,499 @@
+#include "ublox_nmea_ubx.h"
+#include <string.h>
+
+// Тип сообщений MGA-INI (первый байт полезной нагрузки)
+#define MGA_INI_POS_LLH 0x01
+#define MGA_INI_TIME_UTC 0x10
+
+// Добавка к точности позиции без высоты (высота 0 м над эллипсоидом)
+#define ASSIST_NO_ALTITUDE_ACC_M 500.0
+
+// Контрольная сумма Флетчера по классу, id, длине и полезной нагрузке
+static void ubx_checksum(const uint8_t* frame, size_t payload_len, uint8_t* ck_a, uint8_t* ck_b) {
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < UBX_HEADER_SIZE + payload_len; i++) {
+        a += frame[i];
+        b += a;
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
+
+size_t ubx_frame_finish(uint8_t* frame, uint8_t msg_class, uint8_t msg_id, uint16_t payload_len) {
+    frame[0] = UBX_SYNC_1;
+    frame[1] = UBX_SYNC_2;
+    frame[2] = msg_class;
+    frame[3] = msg_id;
+    ubx_put_u16(frame + 4, payload_len);
+    ubx_checksum(frame, payload_len, &frame[UBX_HEADER_SIZE + payload_len], &frame[UBX_HEADER_SIZE + payload_len + 1]);
+    return UBX_FRAME_OVERHEAD + payload_len;
+}
+
+const uint8_t* ubx_frame_payload(const uint8_t* frame, size_t len, uint8_t msg_class, uint8_t msg_id,
+                                 size_t* payload_len) {
+    if (len < UBX_FRAME_OVERHEAD || frame[0] != UBX_SYNC_1 || frame[1] != UBX_SYNC_2 || frame[2] != msg_class ||
+        frame[3] != msg_id) {
+        return NULL;
+    }
+    size_t n = ubx_get_u16(frame + 4);
+    if (len < UBX_FRAME_OVERHEAD + n) return NULL;
+    uint8_t ck_a, ck_b;
+    ubx_checksum(frame, n, &ck_a, &ck_b);
+    if (ck_a != frame[UBX_HEADER_SIZE + n] || ck_b != frame[UBX_HEADER_SIZE + n + 1]) return NULL;
+    *payload_len = n;
+    return frame + UBX_HEADER_SIZE;
+}
+
+void ubx_reader_init(ubx_reader_t* reader, uint8_t* buf, uint16_t capacity) {
+    reader->buf = buf;
+    reader->capacity = capacity;
+    reader->len = 0;
+    reader->total = 0;
+    reader->skip = 0;
+    reader->errors = 0;
+}
+
+size_t ubx_reader_feed(ubx_reader_t* reader, const uint8_t* data, size_t len, size_t* frame_len) {
+    *frame_len = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        if (reader->skip) {
+            reader->skip--;
+            continue;
+        }
+        if (reader->len == 0) {
+            if (c == UBX_SYNC_1) reader->buf[reader->len++] = c;
+            continue;
+        }
+        if (reader->len == 1) {
+            // После B5 ждем 62; повторный B5 - новое начало
+            if (c == UBX_SYNC_2) {
+                reader->buf[reader->len++] = c;
+            } else if (c != UBX_SYNC_1) {
+                reader->len = 0;
+            }
+            continue;
+        }
+
+        reader->buf[reader->len++] = c;
+        if (reader->len == UBX_HEADER_SIZE) {
+            uint32_t total = UBX_FRAME_OVERHEAD + (uint32_t)ubx_get_u16(reader->buf + 4);
+            if (total > reader->capacity) {
+                reader->skip = (uint16_t)(total - UBX_HEADER_SIZE);
+                reader->len = 0;
+                reader->errors++;
+                continue;
+            }
+            reader->total = (uint16_t)total;
+        }
+        if (reader->len > UBX_HEADER_SIZE && reader->len == reader->total) {
+            size_t payload_len = reader->total - UBX_FRAME_OVERHEAD;
+            uint8_t ck_a, ck_b;
+            ubx_checksum(reader->buf, payload_len, &ck_a, &ck_b);
+            reader->len = 0;
+            if (ck_a == reader->buf[reader->total - 2] && ck_b == reader->buf[reader->total - 1]) {
+                *frame_len = reader->total;
+                return i + 1;
+            }
+            reader->errors++;
+        }
+    }
+    return len;
+}
+
+void ubx_assist_config_default(ubx_assist_config_t* config) {
+    config->speed_mps = 1.0;
+    config->drift_ppm = 50.0;
+    config->time_acc_s = 1.0;
+    config->pos_acc_m = 25.0;
+}
+
+// Неотрицательное значение в единицах scale с насыщением до uint32
+static uint32_t accuracy_units(double value, double scale) {
+    double units = ceil(value * scale);
+    if (!(units > 0.0)) return 0;
+    return units >= 4294967295.0 ? 0xFFFFFFFFu : (uint32_t)units;
+}
+
+size_t ubx_mga_ini_pos_llh(uint8_t* out, double lat, double lon, double alt_m, double acc_m) {
+    uint8_t* p = out + UBX_HEADER_SIZE;
+    memset(p, 0, UBX_MGA_INI_POS_LLH_SIZE);
+    p[0] = MGA_INI_POS_LLH;
+    ubx_put_u32(p + 4, (uint32_t)(int32_t)llround(lat * 1e7));
+    ubx_put_u32(p + 8, (uint32_t)(int32_t)llround(lon * 1e7));
+    ubx_put_u32(p + 12, (uint32_t)(int32_t)llround(alt_m * 100.0));      // см
+    ubx_put_u32(p + 16, accuracy_units(acc_m, 100.0));                   // posAcc, см
+    return ubx_frame_finish(out, UBX_CLASS_MGA, UBX_MGA_INI, UBX_MGA_INI_POS_LLH_SIZE);
+}
+
+size_t ubx_mga_ini_time_utc(uint8_t* out, int64_t utc_ms, double acc_s) {
+    uint8_t* p = out + UBX_HEADER_SIZE;
+    memset(p, 0, UBX_MGA_INI_TIME_UTC_SIZE);
+
+    int year, month, day;
+    nmea_civil_from_days(utc_ms / 86400000, &year, &month, &day);
+    int64_t tod = utc_ms % 86400000;
+
+    p[0] = MGA_INI_TIME_UTC;
+    p[2] = 0x00;                                    // ref: время действительно при приеме
+    p[3] = (uint8_t)(int8_t)UBX_GPS_LEAP_SECONDS;
+    ubx_put_u16(p + 4, year);
+    p[6] = month;
+    p[7] = day;
+    p[8] = (uint8_t)(tod / 3600000);
+    p[9] = (uint8_t)(tod / 60000 % 60);
+    p[10] = (uint8_t)(tod / 1000 % 60);
+    ubx_put_u32(p + 12, (uint32_t)(tod % 1000 * 1000000));        // ns
+
+    // tAccS (целые секунды) + tAccNs (остаток)
+    uint32_t acc_ms = accuracy_units(acc_s, 1000.0);
+    uint32_t acc_whole_s = acc_ms / 1000;
+    ubx_put_u16(p + 16, acc_whole_s > 0xFFFF ? 0xFFFF : acc_whole_s);
+    ubx_put_u32(p + 20, acc_whole_s > 0xFFFF ? 999999999u : acc_ms % 1000 * 1000000);
+    return ubx_frame_finish(out, UBX_CLASS_MGA, UBX_MGA_INI, UBX_MGA_INI_TIME_UTC_SIZE);
+}
+
+size_t ubx_assist_hot_start(uint8_t* out, const gps_data_t* last, int64_t now_ms, const ubx_assist_config_t* config) {
+    ubx_assist_config_t defaults;
+    if (!config) {
+        ubx_assist_config_default(&defaults);
+        config = &defaults;
+    }
+
+    // Время от последнего фикса; без времени фикса или при RTC позади него - неизвестно
+    int64_t fix_ms = gps_data_utc_ms(last);
+    double elapsed_s = (fix_ms >= 0 && now_ms >= fix_ms) ? (now_ms - fix_ms) / 1000.0 : NAN;
+
+    size_t len = 0;
+    if (!isnan(elapsed_s) && !isnan(last->latitude) && !isnan(last->longitude)) {
+        double acc_m = (last->has_accuracy ? last->accuracy : config->pos_acc_m) + config->speed_mps * elapsed_s;
+        double alt_m = 0.0;
+        if (isnan(last->altitude)) {
+            acc_m += ASSIST_NO_ALTITUDE_ACC_M;
+        } else {
+            alt_m = last->altitude + (isnan(last->geoid_separation) ? 0.0 : last->geoid_separation);
+        }
+        len += ubx_mga_ini_pos_llh(out, last->latitude, last->longitude, alt_m, acc_m);
+    }
+
+    // RTC синхронизирован по последнему фиксу: уход накапливается с того же момента
+    double acc_s = config->time_acc_s + (isnan(elapsed_s) ? 0.0 : elapsed_s * config->drift_ppm * 1e-6);
+    len += ubx_mga_ini_time_utc(out + len, now_ms, acc_s);
+    return len;
+}
+
+void ubx_sat_table_init(ubx_sat_table_t* table) {
+    table->itow_ms = 0;
+    table->count = 0;
+    table->dropped = 0;
+    table->epochs = 0;
+}
+
+// NAV-SAT: заголовок 8 байт (iTOW, версия 1, numSvs), затем по 12 байт на спутник
+#define NAV_SAT_HEADER 8
+#define NAV_SAT_BLOCK 12
+
+int ubx_nav_sat_decode(ubx_sat_table_t* table, const uint8_t* payload, size_t len) {
+    if (len < NAV_SAT_HEADER || payload[4] != 1) return -1;
+    size_t num_svs = payload[5];
+    if (len != NAV_SAT_HEADER + num_svs * NAV_SAT_BLOCK) return -1;
+
+    size_t count = (num_svs > UBX_SAT_TABLE_CAPACITY) ? UBX_SAT_TABLE_CAPACITY : num_svs;
+    const uint8_t* p = payload + NAV_SAT_HEADER;
+    for (size_t i = 0; i < count; i++, p += NAV_SAT_BLOCK) {
+        table->gnss_id[i] = p[0];
+        table->sv_id[i] = p[1];
+        table->cno[i] = p[2];
+        table->elevation[i] = (int8_t)p[3];
+        table->azimuth[i] = (int16_t)ubx_get_u16(p + 4);
+        table->residual_dm[i] = (int16_t)ubx_get_u16(p + 6);
+        table->flags[i] = ubx_get_u32(p + 8);
+    }
+    table->itow_ms = ubx_get_u32(payload);
+    table->count = (uint16_t)count;
+    table->dropped = (uint16_t)(num_svs - count);
+    table->epochs++;
+    return (int)count;
+}
+
+void ubx_timepulse_init(ubx_timepulse_t* tp, double ns_per_tick, uint64_t ticks_mask) {
+    memset(tp, 0, sizeof(*tp));
+    tp->ns_per_tick = ns_per_tick;
+    tp->ticks_mask = ticks_mask;
+    tp->leap_seconds = UBX_GPS_LEAP_SECONDS;
+}
+
+#define NS_PER_MS 1000000LL
+#define NS_PER_S 1000000000LL
+#define MS_PER_WEEK 604800000LL
+
+// Допуск хода часов между импульсами относительно номинала
+#define TIMEPULSE_RATE_TOLERANCE 1e-3
+
+// TIM-TP: towMS, towSubMS (2^-32 мс), qErr (пс), неделя, флаги (бит 0 - шкала UTC),
+// refInfo (биты 0-3 - система шкалы GNSS: 0 - GPS)
+int ubx_tim_tp_decode(ubx_timepulse_t* tp, const uint8_t* payload, size_t len) {
+    if (len != 16) return -1;
+    uint32_t tow_ms = ubx_get_u32(payload);
+    uint32_t tow_sub_ms = ubx_get_u32(payload + 4);
+    int32_t qerr_ps = (int32_t)ubx_get_u32(payload + 8);
+    uint16_t week = ubx_get_u16(payload + 12);
+    uint8_t flags = payload[14];
+    uint8_t ref_info = payload[15];
+
+    int64_t ms = UBX_GPS_EPOCH_UNIX_MS + (int64_t)week * MS_PER_WEEK + tow_ms;
+    if (!(flags & 0x01)) {
+        if ((ref_info & 0x0F) != 0) return -1;
+        ms -= (int64_t)tp->leap_seconds * 1000;
+    }
+    tp->next_utc_ns = ms * NS_PER_MS + (int64_t)(((uint64_t)tow_sub_ms * NS_PER_MS) >> 32);
+    tp->next_qerr_ps = qerr_ps;
+    tp->has_next = 1;
+    return 0;
+}
+
+// NAV-TIMEUTC: iTOW, tAcc, nano, дата и время UTC, флаги (бит 0 - iTOW, бит 2 - UTC действительны)
+int ubx_nav_timeutc_decode(ubx_timepulse_t* tp, const uint8_t* payload, size_t len, int64_t* utc_ms) {
+    if (len != 20) return -1;
+    uint8_t valid = payload[19];
+    if (!(valid & 0x04)) return 0;
+
+    int64_t days = nmea_days_from_civil(ubx_get_u16(payload + 12), payload[14], payload[15]);
+    int64_t seconds = days * 86400 + payload[16] * 3600 + payload[17] * 60 + payload[18];
+    int32_t nano = (int32_t)ubx_get_u32(payload + 8);
+    *utc_ms = seconds * 1000 + (nano >= 0 ? nano / 1000000 : -((999999 - nano) / 1000000));
+    tp->t_acc_ns = ubx_get_u32(payload + 4);
+
+    // GPS - UTC: время недели GPS против времени недели той же эпохи по UTC
+    if (valid & 0x01) {
+        int64_t utc_tow_ms = (*utc_ms - UBX_GPS_EPOCH_UNIX_MS) % MS_PER_WEEK;
+        int64_t diff_ms = (int64_t)ubx_get_u32(payload) - utc_tow_ms;
+        if (diff_ms < 0) diff_ms += MS_PER_WEEK;
+        int64_t leap = (diff_ms + 500) / 1000;
+        if (leap >= 0 && leap < 64) tp->leap_seconds = (int32_t)leap;
+    }
+    return 1;
+}
+
+// Разность тиков a - b по модулю периода счетчика (со знаком)
+static int64_t ticks_diff(const ubx_timepulse_t* tp, uint64_t a, uint64_t b) {
+    uint64_t diff = (a - b) & tp->ticks_mask;
+    return (diff > (tp->ticks_mask >> 1)) ? -(int64_t)((tp->ticks_mask - diff) + 1) : (int64_t)diff;
+}
+
+static double timepulse_rate(const ubx_timepulse_t* tp) {
+    return (tp->rate > 0.0) ? tp->rate : tp->ns_per_tick;
+}
+
+// Ход по паре импульсов в пределах допуска
+static int timepulse_rate_ok(const ubx_timepulse_t* tp, int64_t label, int64_t elapsed) {
+    double error = (double)(label - tp->ref_utc_ns) / (double)elapsed / tp->ns_per_tick - 1.0;
+    return error <= TIMEPULSE_RATE_TOLERANCE && error >= -TIMEPULSE_RATE_TOLERANCE;
+}
+
+void ubx_timepulse_edge(ubx_timepulse_t* tp, uint64_t ticks) {
+    int64_t label;
+    int32_t qerr_ps = 0;
+    int64_t elapsed = tp->locked ? ticks_diff(tp, ticks, tp->ref_ticks) : 0;
+
+    // Продолжение от прошлого импульса: целое число секунд
+    int64_t extrapolated = 0;
+    if (tp->locked) {
+        int64_t seconds = (int64_t)((double)elapsed * timepulse_rate(tp) / NS_PER_S + 0.5);
+        extrapolated = tp->ref_utc_ns + seconds * NS_PER_S;
+    }
+
+    int dropped = 0;
+    if (tp->has_next) {
+        // Импульс отстает от номинала на qErr: номинальное время - на qErr раньше фронта
+        qerr_ps = tp->next_qerr_ps;
+        label = tp->next_utc_ns + (qerr_ps >= 0 ? (qerr_ps + 500) / 1000 : -((500 - qerr_ps) / 1000));
+        tp->has_next = 0;
+        // Метка не этого импульса (TIM-TP пришел после своего фронта и относится к прошлому) или
+        // ход вне допуска: метка отбрасывается, иначе сдвиг на секунду остается во всех следующих
+        if (tp->locked && elapsed > 0) {
+            double expected = (double)tp->ref_utc_ns + (double)elapsed * timepulse_rate(tp);
+            double offset = (double)label - expected;
+            if (offset > NS_PER_S / 2 || offset < -NS_PER_S / 2 || !timepulse_rate_ok(tp, label, elapsed)) {
+                tp->rejected++;
+                label = extrapolated;
+                qerr_ps = 0;
+                dropped = 1;
+            }
+        }
+    } else if (tp->locked) {
+        // Метка не пришла
+        label = extrapolated;
+    } else {
+        return;
+    }
+
+    if (tp->locked && elapsed > 0) {
+        if (timepulse_rate_ok(tp, label, elapsed)) {
+            // Сглаживание: шум тиков (до 1 тика на фронт) усредняется по нескольким секундам
+            double rate = (double)(label - tp->ref_utc_ns) / (double)elapsed;
+            tp->rate = (tp->rate > 0.0) ? tp->rate + (rate - tp->rate) / 8.0 : rate;
+        } else if (!dropped) {
+            tp->rejected++;
+        }
+    }
+    tp->ref_ticks = ticks;
+    tp->ref_utc_ns = label;
+    tp->qerr_ps = qerr_ps;
+    tp->locked = 1;
+    tp->pulses++;
+}
+
+int ubx_timepulse_utc_ns(const ubx_timepulse_t* tp, uint64_t ticks, int64_t* utc_ns) {
+    if (!tp->locked) return 0;
+    double offset = (double)ticks_diff(tp, ticks, tp->ref_ticks) * timepulse_rate(tp);
+    *utc_ns = tp->ref_utc_ns + (int64_t)(offset >= 0.0 ? offset + 0.5 : offset - 0.5);
+    return 1;
+}
+
+int ubx_capture_init(ubx_capture_t* capture, uint8_t* buf, size_t capacity) {
+    if (capacity < UBX_CAPTURE_MAX_FRAME + UBX_CAPTURE_BLOCK) return 0;
+    memset(capture, 0, sizeof(*capture));
+    capture->buf = buf;
+    capture->capacity = capacity;
+    ubx_reader_init(&capture->reader, buf, UBX_CAPTURE_MAX_FRAME);
+    return 1;
+}
+
+void ubx_capture_select(ubx_capture_t* capture, uint8_t msg_class) {
+    capture->classes[msg_class >> 3] |= (uint8_t)(1 << (msg_class & 7));
+}
+
+size_t ubx_capture_feed(ubx_capture_t* capture, const uint8_t* data, size_t len) {
+    size_t used = 0;
+    // Место под кадр наибольшей длины за принятыми: иначе сначала запись
+    while (used < len && capture->capacity - capture->len >= UBX_CAPTURE_MAX_FRAME) {
+        size_t frame_len;
+        used += ubx_reader_feed(&capture->reader, data + used, len - used, &frame_len);
+        if (!frame_len) continue;
+
+        uint8_t msg_class = capture->buf[capture->len + 2];
+        if (capture->classes[msg_class >> 3] & (1 << (msg_class & 7))) {
+            capture->len += frame_len;
+            capture->reader.buf = capture->buf + capture->len;
+            capture->messages++;
+        } else {
+            capture->skipped++;
+        }
+    }
+    capture->bytes_in += used;
+    return used;
+}
+
+size_t ubx_capture_pending(const ubx_capture_t* capture) {
+    if (capture->capacity - capture->len >= UBX_CAPTURE_MAX_FRAME) return 0;
+    return capture->len - capture->len % UBX_CAPTURE_BLOCK;
+}
+
+void ubx_capture_written(ubx_capture_t* capture, size_t n) {
+    // Остаток принятых кадров и недособранный кадр - в начало буфера
+    memmove(capture->buf, capture->buf + n, capture->len - n + capture->reader.len);
+    capture->len -= n;
+    capture->reader.buf = capture->buf + capture->len;
+    capture->bytes_written += n;
+    capture->writes++;
+}
+
+void ubx_upload_init(ubx_upload_t* upload, int year, int month, int day, uint32_t timeout_ms) {
+    memset(upload, 0, sizeof(*upload));
+    ubx_reader_init(&upload->file_reader, upload->frame, sizeof(upload->frame));
+    ubx_reader_init(&upload->ack_reader, upload->ack, sizeof(upload->ack));
+    if (year >= 2000) {
+        upload->ano_year = (uint8_t)(year - 2000);
+        upload->ano_month = (uint8_t)month;
+        upload->ano_day = (uint8_t)day;
+    }
+    upload->timeout_ms = timeout_ms;
+}
+
+// MGA-ANO другой даты не загружается (приемник хранит данные только на текущие сутки)
+static int upload_filtered(const ubx_upload_t* upload, const uint8_t* frame, size_t len) {
+    if (upload->ano_year == 0 || frame[2] != UBX_CLASS_MGA || frame[3] != UBX_MGA_ANO ||
+        len < UBX_FRAME_OVERHEAD + 7) {
+        return 0;
+    }
+    const uint8_t* payload = frame + UBX_HEADER_SIZE;
+    return payload[4] != upload->ano_year || payload[5] != upload->ano_month || payload[6] != upload->ano_day;
+}
+
+ubx_upload_action_t ubx_upload_step(ubx_upload_t* upload, uint32_t now_ms) {
+    if (upload->frame_len) {
+        if (!upload->written) return UBX_UPLOAD_WRITE;
+        if ((uint32_t)(now_ms - upload->written_ms) < upload->timeout_ms) return UBX_UPLOAD_WAIT;
+
+        // Нет ответа: повтор того же кадра или переход к следующему
+        if (upload->attempts <= UBX_UPLOAD_RETRIES) {
+            upload->written = 0;
+            return UBX_UPLOAD_WRITE;
+        }
+        upload->timeouts++;
+        upload->frame_len = 0;
+    }
+
+    while (upload->input_pos < upload->input_len) {
+        size_t frame_len;
+        upload->input_pos += ubx_reader_feed(&upload->file_reader, upload->input + upload->input_pos,
+                                             upload->input_len - upload->input_pos, &frame_len);
+        if (!frame_len) continue;
+        if (upload_filtered(upload, upload->frame, frame_len)) {
+            upload->skipped++;
+            continue;
+        }
+        upload->frame_len = (uint16_t)frame_len;
+        upload->written = 0;
+        upload->attempts = 0;
+        return UBX_UPLOAD_WRITE;
+    }
+    return upload->eof ? UBX_UPLOAD_DONE : UBX_UPLOAD_READ;
+}
+
+void ubx_upload_input(ubx_upload_t* upload, size_t len) {
+    upload->input_pos = 0;
+    upload->input_len = (uint16_t)len;
+    if (len == 0) upload->eof = 1;
+}
+
+void ubx_upload_written(ubx_upload_t* upload, uint32_t now_ms) {
+    if (upload->attempts == 0) upload->sent++;
+    upload->attempts++;
+    if (upload->timeout_ms == 0) {
+        upload->frame_len = 0;
+        return;
+    }
+    upload->written = 1;
+    upload->written_ms = now_ms;
+}
+
+void ubx_upload_receive(ubx_upload_t* upload, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t frame_len;
+        size_t used = ubx_reader_feed(&upload->ack_reader, data, len, &frame_len);
+        data += used;
+        len -= used;
+        if (!frame_len || !upload->frame_len || !upload->written) continue;
+
+        // MGA-ACK-DATA0: тип (1 - принят), версия, код, id сообщения, первые 4 байта его нагрузки
+        const uint8_t* ack = upload->ack;
+        if (ack[2] != UBX_CLASS_MGA || ack[3] != UBX_MGA_ACK || frame_len != UBX_FRAME_OVERHEAD + UBX_MGA_ACK_SIZE) {
+            continue;
+        }
+        const uint8_t* payload = ack + UBX_HEADER_SIZE;
+        size_t sent_payload = upload->frame_len - UBX_FRAME_OVERHEAD;
+        if (payload[3] != upload->frame[3] ||
+            memcmp(payload + 4, upload->frame + UBX_HEADER_SIZE, sent_payload < 4 ? sent_payload : 4) != 0) {
+            continue;
+        }
+        if (payload[0] == 1) {
+            upload->acked++;
+        } else {
+            upload->nacked++;
+        }
+        upload->frame_len = 0;
+        upload->written = 0;
+    }
+}
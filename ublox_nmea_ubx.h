@@ -0,0 +1,264 @@
+#ifndef UBLOX_NMEA_UBX_H
+#define UBLOX_NMEA_UBX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ublox_nmea_core.h"
+
+// Двоичный протокол UBX: кадр B5 62, класс, id, длина (LE), полезная нагрузка, контрольная
+// сумма Флетчера по классу, id, длине и полезной нагрузке
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+#define UBX_HEADER_SIZE 6
+#define UBX_FRAME_OVERHEAD 8
+
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_RXM 0x02
+#define UBX_CLASS_TIM 0x0D
+#define UBX_CLASS_MGA 0x13
+
+#define UBX_NAV_PVT 0x07
+#define UBX_NAV_TIMEUTC 0x21
+#define UBX_NAV_SAT 0x35
+#define UBX_TIM_TP 0x01
+#define UBX_RXM_SFRBX 0x13
+#define UBX_RXM_RAWX 0x15
+#define UBX_MGA_ANO 0x20
+#define UBX_MGA_INI 0x40
+#define UBX_MGA_ACK 0x60
+
+#define UBX_MGA_INI_POS_LLH_SIZE 20
+#define UBX_MGA_INI_TIME_UTC_SIZE 24
+#define UBX_MGA_ACK_SIZE 8
+
+// Начало шкалы GPS (1980-01-06) в UTC и текущая разница GPS - UTC
+#define UBX_GPS_EPOCH_UNIX_MS 315964800000LL
+#define UBX_GPS_LEAP_SECONDS 18
+
+static inline void ubx_put_u16(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void ubx_put_u32(uint8_t* p, uint32_t value) {
+    ubx_put_u16(p, value);
+    ubx_put_u16(p + 2, value >> 16);
+}
+
+static inline uint16_t ubx_get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t ubx_get_u32(const uint8_t* p) {
+    return (uint32_t)ubx_get_u16(p) | ((uint32_t)ubx_get_u16(p + 2) << 16);
+}
+
+// Заголовок и контрольная сумма вокруг полезной нагрузки, уже записанной с frame + UBX_HEADER_SIZE;
+// возвращает длину кадра
+size_t ubx_frame_finish(uint8_t* frame, uint8_t msg_class, uint8_t msg_id, uint16_t payload_len);
+
+// Полезная нагрузка кадра [frame, frame + len) класса msg_class и id msg_id или NULL, если кадр
+// другой, обрезан или с неверной контрольной суммой
+const uint8_t* ubx_frame_payload(const uint8_t* frame, size_t len, uint8_t msg_class, uint8_t msg_id,
+                                 size_t* payload_len);
+
+// Разбор потока на кадры UBX с проверкой контрольной суммы в буфер вызывающего: мусор между
+// кадрами (NMEA, обрывки) пропускается, кадры длиннее capacity пропускаются без хранения
+typedef struct {
+    uint8_t* buf;
+    uint16_t capacity;      // не меньше UBX_FRAME_OVERHEAD
+    uint16_t len;           // собрано байт текущего кадра (0 - поиск синхробайтов)
+    uint16_t total;         // длина текущего кадра (известна после заголовка)
+    uint16_t skip;          // осталось пропустить байт длинного кадра
+    uint32_t errors;        // неверные контрольные суммы и длинные кадры
+} ubx_reader_t;
+
+void ubx_reader_init(ubx_reader_t* reader, uint8_t* buf, uint16_t capacity);
+
+// Подача байт до конца очередного кадра; возвращает число потребленных байт. Если кадр собран,
+// *frame_len - его длина (кадр в reader->buf до следующего вызова), иначе 0
+size_t ubx_reader_feed(ubx_reader_t* reader, const uint8_t* data, size_t len, size_t* frame_len);
+
+// Параметры оценки точности подсказки по времени, прошедшему с последнего фикса
+typedef struct {
+    double speed_mps;       // наибольшая скорость носителя без фикса (рост ошибки позиции)
+    double drift_ppm;       // уход RTC (рост ошибки времени)
+    double time_acc_s;      // ошибка RTC сразу после синхронизации
+    double pos_acc_m;       // точность последнего фикса, если он ее не содержит
+} ubx_assist_config_t;
+
+// speed 1 м/с, уход 50 ppm, RTC 1 с, позиция 25 м
+void ubx_assist_config_default(ubx_assist_config_t* config);
+
+// UBX-MGA-INI-POS_LLH: позиция (градусы, м над эллипсоидом) с точностью acc_m; возвращает длину кадра
+size_t ubx_mga_ini_pos_llh(uint8_t* out, double lat, double lon, double alt_m, double acc_m);
+
+// UBX-MGA-INI-TIME_UTC: время UTC (мс от 1970-01-01) с точностью acc_s; возвращает длину кадра
+size_t ubx_mga_ini_time_utc(uint8_t* out, int64_t utc_ms, double acc_s);
+
+#define UBX_ASSIST_HOT_START_MAX (2 * UBX_FRAME_OVERHEAD + UBX_MGA_INI_POS_LLH_SIZE + UBX_MGA_INI_TIME_UTC_SIZE)
+
+// Сообщения горячего старта из последнего фикса и текущего времени RTC now_ms: POS_LLH (если
+// у фикса есть позиция и время) и TIME_UTC. Точность растет с временем от фикса (config или
+// NULL - по умолчанию). out - не меньше UBX_ASSIST_HOT_START_MAX байт; возвращает длину
+size_t ubx_assist_hot_start(uint8_t* out, const gps_data_t* last, int64_t now_ms, const ubx_assist_config_t* config);
+
+// Таблица спутников из UBX-NAV-SAT: колонки фиксированной емкости (struct of arrays), по строке
+// на спутник в порядке сообщения
+#define UBX_SAT_TABLE_CAPACITY 64
+
+// Биты flags NAV-SAT
+#define UBX_SAT_QUALITY_MASK 0x07       // 0 - нет сигнала ... 4-7 - код и фаза захвачены
+#define UBX_SAT_USED 0x08               // в навигационном решении
+#define UBX_SAT_HEALTH_SHIFT 4          // 2 бита: 0 - неизвестно, 1 - исправен, 2 - неисправен
+#define UBX_SAT_DIFF_CORR 0x40
+#define UBX_SAT_EPH_AVAIL 0x800
+
+typedef struct {
+    uint32_t itow_ms;       // время недели GPS эпохи
+    uint16_t count;         // спутников в таблице
+    uint16_t dropped;       // не поместилось в последнем сообщении
+    uint32_t epochs;        // принято сообщений
+    uint8_t gnss_id[UBX_SAT_TABLE_CAPACITY];        // 0 GPS, 1 SBAS, 2 Galileo, 3 BeiDou, 5 QZSS, 6 ГЛОНАСС
+    uint8_t sv_id[UBX_SAT_TABLE_CAPACITY];
+    uint8_t cno[UBX_SAT_TABLE_CAPACITY];            // дБГц
+    int8_t elevation[UBX_SAT_TABLE_CAPACITY];       // градусы (-91 - неизвестно)
+    int16_t azimuth[UBX_SAT_TABLE_CAPACITY];        // градусы
+    int16_t residual_dm[UBX_SAT_TABLE_CAPACITY];    // невязка псевдодальности, 0.1 м
+    uint32_t flags[UBX_SAT_TABLE_CAPACITY];
+} ubx_sat_table_t;
+
+void ubx_sat_table_init(ubx_sat_table_t* table);
+
+// Заполнение таблицы из полезной нагрузки NAV-SAT; число спутников или -1 (неверная длина/версия)
+int ubx_nav_sat_decode(ubx_sat_table_t* table, const uint8_t* payload, size_t len);
+
+// Передача времени по импульсу PPS: TIM-TP дает метку (время и ошибку квантования qErr)
+// следующего импульса, вызывающий - тики локальных часов его фронта (прерывание по выводу).
+// Пары (тики, UTC) последовательных импульсов дают отображение тики -> UTC с оценкой хода часов
+typedef struct {
+    double ns_per_tick;     // номинал (1000 для ticks_us)
+    uint64_t ticks_mask;    // период счетчика тиков - 1 (переполнение по маске)
+    int32_t leap_seconds;   // GPS - UTC (из NAV-TIMEUTC, иначе UBX_GPS_LEAP_SECONDS)
+    uint32_t t_acc_ns;      // оценка точности времени приемника из NAV-TIMEUTC
+    int64_t next_utc_ns;    // метка следующего импульса, нс UTC от 1970-01-01, с учетом qErr
+    int32_t next_qerr_ps;
+    uint8_t has_next;
+    uint8_t locked;         // есть опорный импульс
+    uint64_t ref_ticks;     // тики и UTC последнего импульса
+    int64_t ref_utc_ns;
+    double rate;            // нс UTC на тик (оценка; 0 - по одному импульсу, берется номинал)
+    int32_t qerr_ps;        // qErr последнего импульса
+    uint32_t pulses;
+    uint32_t rejected;      // импульсы с ходом вне допуска или чужой меткой (опоздавший TIM-TP, сбой часов)
+} ubx_timepulse_t;
+
+void ubx_timepulse_init(ubx_timepulse_t* tp, double ns_per_tick, uint64_t ticks_mask);
+
+// Полезная нагрузка TIM-TP (шкала времени импульса - UTC или GPS); 0 или -1 (неверная/другая шкала)
+int ubx_tim_tp_decode(ubx_timepulse_t* tp, const uint8_t* payload, size_t len);
+
+// Полезная нагрузка NAV-TIMEUTC: число секунд координации и точность; *utc_ms - время эпохи
+// (мс от 1970-01-01); 1 - время UTC действительно, 0 - нет, -1 - неверная длина
+int ubx_nav_timeutc_decode(ubx_timepulse_t* tp, const uint8_t* payload, size_t len, int64_t* utc_ms);
+
+// Фронт PPS в тиках ticks; без выделения памяти, можно вызывать из обработчика прерывания
+void ubx_timepulse_edge(ubx_timepulse_t* tp, uint64_t ticks);
+
+// UTC (нс от 1970-01-01) момента ticks; 0, если еще не было помеченного импульса
+int ubx_timepulse_utc_ns(const ubx_timepulse_t* tp, uint64_t ticks, int64_t* utc_ns);
+
+// Запись сырого потока (RXM-RAWX/SFRBX для постобработки) в файл: кадры выбранных классов с
+// верной контрольной суммой копируются как есть в большой буфер записи, кадр собирается прямо
+// в нем. Запись блоками, кратными UBX_CAPTURE_BLOCK (выравнивание по секторам карты памяти)
+#ifndef UBX_CAPTURE_MAX_FRAME
+#define UBX_CAPTURE_MAX_FRAME 4096      // RAWX - 24 + 32 байта на измерение (до 127 измерений)
+#endif
+#define UBX_CAPTURE_BLOCK 512
+
+typedef struct {
+    ubx_reader_t reader;    // собирает кадр в buf + len
+    uint8_t* buf;
+    size_t capacity;        // не меньше UBX_CAPTURE_MAX_FRAME + UBX_CAPTURE_BLOCK
+    size_t len;             // принятые кадры, ждущие записи
+    uint8_t classes[32];    // битовая маска выбранных классов
+    uint64_t bytes_in;
+    uint64_t bytes_written;
+    uint32_t messages;      // записано кадров
+    uint32_t skipped;       // кадры невыбранных классов
+    uint32_t writes;        // вызовов записи в файл
+} ubx_capture_t;
+
+// 0, если capacity меньше минимума; классы не выбраны
+int ubx_capture_init(ubx_capture_t* capture, uint8_t* buf, size_t capacity);
+
+void ubx_capture_select(ubx_capture_t* capture, uint8_t msg_class);
+
+// Подача байт потока приемника; возвращает число потребленных. Меньше len - буфер заполнен:
+// записать ubx_capture_pending() байт с начала buf, вызвать ubx_capture_written и подать остаток
+size_t ubx_capture_feed(ubx_capture_t* capture, const uint8_t* data, size_t len);
+
+// Сколько байт записать сейчас (кратно UBX_CAPTURE_BLOCK; 0 - буфер еще не заполнен)
+size_t ubx_capture_pending(const ubx_capture_t* capture);
+
+// Записано n байт с начала buf (n <= len; при завершении - все len)
+void ubx_capture_written(ubx_capture_t* capture, size_t n);
+
+// Кадры с неверной контрольной суммой и длиннее UBX_CAPTURE_MAX_FRAME
+static inline uint32_t ubx_capture_dropped(const ubx_capture_t* capture) {
+    return capture->reader.errors;
+}
+
+// Потоковая загрузка AssistNow (кадры MGA из файла) в приемник с подтверждением MGA-ACK-DATA0:
+// следующий кадр отправляется после ACK/NAK предыдущего или после исчерпания повторов.
+// Ввод-вывод у вызывающего: ubx_upload_step говорит, что делать дальше
+#define UBX_UPLOAD_MAX_FRAME 128    // наибольший кадр MGA AssistNow - 96 байт
+#define UBX_UPLOAD_CHUNK 128
+#define UBX_UPLOAD_RETRIES 2
+
+typedef enum {
+    UBX_UPLOAD_READ,        // прочитать фрагмент файла в input (до UBX_UPLOAD_CHUNK) и вызвать ubx_upload_input
+    UBX_UPLOAD_WRITE,       // отправить frame (frame_len байт) и вызвать ubx_upload_written
+    UBX_UPLOAD_WAIT,        // ждать ACK: байты приемника в ubx_upload_receive
+    UBX_UPLOAD_DONE,
+} ubx_upload_action_t;
+
+typedef struct {
+    ubx_reader_t file_reader;
+    uint8_t frame[UBX_UPLOAD_MAX_FRAME];    // текущий кадр (хранилище file_reader)
+    ubx_reader_t ack_reader;
+    uint8_t ack[UBX_FRAME_OVERHEAD + UBX_MGA_ACK_SIZE];
+    uint8_t input[UBX_UPLOAD_CHUNK];
+    uint16_t input_pos;
+    uint16_t input_len;
+    uint8_t eof;
+    uint8_t ano_year;       // фильтр MGA-ANO: год от 2000, месяц, день (0 - без фильтра)
+    uint8_t ano_month;
+    uint8_t ano_day;
+    uint16_t frame_len;     // 0 - нет текущего кадра
+    uint8_t written;        // текущий кадр отправлен и ждет ACK
+    uint8_t attempts;
+    uint32_t timeout_ms;    // 0 - без ожидания ACK
+    uint32_t written_ms;
+    uint32_t sent;          // отправлено кадров (без повторов)
+    uint32_t acked;
+    uint32_t nacked;
+    uint32_t skipped;       // MGA-ANO других дат
+    uint32_t timeouts;      // без ответа после всех повторов
+} ubx_upload_t;
+
+// year/month/day - дата MGA-ANO, которые нужно загрузить (year 0 - все)
+void ubx_upload_init(ubx_upload_t* upload, int year, int month, int day, uint32_t timeout_ms);
+
+// Следующее действие; now_ms - монотонные миллисекунды (переполнение допустимо)
+ubx_upload_action_t ubx_upload_step(ubx_upload_t* upload, uint32_t now_ms);
+
+// Прочитано len байт в input (0 - конец файла)
+void ubx_upload_input(ubx_upload_t* upload, size_t len);
+
+void ubx_upload_written(ubx_upload_t* upload, uint32_t now_ms);
+
+void ubx_upload_receive(ubx_upload_t* upload, const uint8_t* data, size_t len);
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef UBLOX_NMEA_WRITER_H
+#define UBLOX_NMEA_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+// Запись полей NMEA без snprintf (общая для генератора и кодировщика)
+// Границы буфера не проверяются: вызывающий резервирует место под предложение целиком
+
+typedef struct {
+    char* start;
+    char* p;
+} nmea_writer_t;
+
+static inline void nmea_put_char(nmea_writer_t* w, char c) {
+    *w->p++ = c;
+}
+
+static inline void nmea_put_str(nmea_writer_t* w, const char* str) {
+    while (*str) *w->p++ = *str++;
+}
+
+// Целое с ведущими нулями до width цифр (width = 0 - без дополнения)
+static inline void nmea_put_uint(nmea_writer_t* w, uint32_t value, int width) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (n < width) digits[n++] = '0';
+    while (n) *w->p++ = digits[--n];
+}
+
+// Наибольшая по модулю целая часть, которую пишет nmea_put_fixed (uint32_t)
+#define NMEA_FIXED_MAX 4294967295.0
+
+// Число с decimals (0..5) знаками после точки; NAN, бесконечность и числа вне NMEA_FIXED_MAX -
+// пустое поле (приведение к целому для них не определено)
+static inline void nmea_put_fixed(nmea_writer_t* w, double value, int decimals) {
+    static const uint32_t scale[] = { 1, 10, 100, 1000, 10000, 100000 };
+    if (!isfinite(value) || fabs(value) >= NMEA_FIXED_MAX) return;
+    if (value < 0.0) {
+        nmea_put_char(w, '-');
+        value = -value;
+    }
+    uint64_t q = (uint64_t)(value * scale[decimals] + 0.5);
+    nmea_put_uint(w, (uint32_t)(q / scale[decimals]), 1);
+    if (decimals > 0) {
+        nmea_put_char(w, '.');
+        nmea_put_uint(w, (uint32_t)(q % scale[decimals]), decimals);
+    }
+}
+
+// Координата в пределах поля: до 90 градусов для ddmm, до 180 для dddmm
+static inline int nmea_coordinate_valid(double value, int degree_digits) {
+    return isfinite(value) && fabs(value) <= ((degree_digits == 2) ? 90.0 : 180.0);
+}
+
+// Координата ddmm.mmmmm / dddmm.mmmmm с полушарием; вне пределов - два пустых поля
+static inline void nmea_put_coordinate(nmea_writer_t* w, double value, int degree_digits, char positive, char negative) {
+    if (!nmea_coordinate_valid(value, degree_digits)) {
+        nmea_put_char(w, ',');
+        return;
+    }
+    char hemisphere = (value < 0.0) ? negative : positive;
+    if (value < 0.0) value = -value;
+    uint64_t minutes_e5 = (uint64_t)(value * 60.0 * 100000.0 + 0.5);
+    nmea_put_uint(w, (uint32_t)(minutes_e5 / 6000000), degree_digits);
+    nmea_put_uint(w, (uint32_t)(minutes_e5 % 6000000 / 100000), 2);
+    nmea_put_char(w, '.');
+    nmea_put_uint(w, (uint32_t)(minutes_e5 % 100000), 5);
+    nmea_put_char(w, ',');
+    nmea_put_char(w, hemisphere);
+}
+
+// Поле времени hhmmss.ss из миллисекунд от начала суток
+static inline void nmea_put_time_of_day(nmea_writer_t* w, int64_t tod_ms) {
+    nmea_put_uint(w, (uint32_t)(tod_ms / 3600000), 2);
+    nmea_put_uint(w, (uint32_t)(tod_ms / 60000 % 60), 2);
+    nmea_put_uint(w, (uint32_t)(tod_ms / 1000 % 60), 2);
+    nmea_put_char(w, '.');
+    nmea_put_uint(w, (uint32_t)(tod_ms % 1000 / 10), 2);
+}
+
+// Начало предложения "$" + talker + тип
+static inline void nmea_sentence_begin(nmea_writer_t* w, char* out, const char* talker, const char* type) {
+    w->start = out;
+    w->p = out;
+    nmea_put_char(w, '$');
+    nmea_put_str(w, talker);
+    nmea_put_str(w, type);
+}
+
+// Контрольная сумма и перевод строки; возвращает длину предложения
+static inline size_t nmea_sentence_finish(nmea_writer_t* w) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t checksum = 0;
+    for (const char* c = w->start + 1; c < w->p; c++) {
+        checksum ^= (uint8_t)*c;
+    }
+    nmea_put_char(w, '*');
+    nmea_put_char(w, hex[checksum >> 4]);
+    nmea_put_char(w, hex[checksum & 0x0F]);
+    nmea_put_char(w, '\r');
+    nmea_put_char(w, '\n');
+    return (size_t)(w->p - w->start);
+}
+
+#endif